@@ -0,0 +1,703 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QMetaEnum>
+#include <QTextStream>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "src/cachesim/cachesim.h"
+#include "src/cachesim/l1cacheshim.h"
+#include "src/cachesim/memorytrace.h"
+#include "src/cachesim/stackdistance.h"
+#include "src/checkpoint.h"
+#include "src/processorhandler.h"
+#include "src/processorregistry.h"
+#include "src/programutilities.h"
+#include "src/syscall/systemio.h"
+
+/**
+ * Ripes-cli
+ * Headless batch simulation driver. Loads a single program into the selected processor model and runs it to
+ * completion (or until a cycle limit is reached) without constructing any of the graphical user interface. Once
+ * finished, execution statistics are printed to stdout.
+ */
+
+using namespace Ripes;
+
+namespace {
+
+struct CLIOptions {
+    QString file;
+    SourceType type = SourceType::Assembly;
+    ProcessorID procID = ProcessorID::RV32_SS;
+    QStringList extensions;
+    AInt binaryEntryPoint = 0;
+    AInt binaryLoadAt = 0;
+    long long maxCycles = 0;
+    bool simulateCaches = false;
+    CachePreset cachePreset;
+    unsigned cacheHitLatency = 1;
+    unsigned cacheMissPenalty = 0;
+    bool simulateL2Cache = false;
+    CachePreset l2CachePreset;
+    InclusionPolicy l2InclusionPolicy = InclusionPolicy::NonInclusive;
+    unsigned l2HitLatency = 1;
+    unsigned l2MissPenalty = 0;
+    QString recordTrace;
+    QString replayTrace;
+    bool missCurves = false;
+    // Cache configurations to replay the trace through; every combination of the swept parameters.
+    std::vector<CachePreset> sweepPresets;
+    QString stdinFile;
+    QString saveCheckpoint;
+    QString restoreCheckpoint;
+    std::vector<Watchpoint> watchpoints;
+    bool quiet = false;
+};
+
+QTextStream& out() {
+    static QTextStream s(stdout);
+    return s;
+}
+
+QTextStream& err() {
+    static QTextStream s(stderr);
+    return s;
+}
+
+QString processorList() {
+    QString list;
+    const auto procEnum = QMetaEnum::fromType<ProcessorID>();
+    for (const auto& desc : ProcessorRegistry::getAvailableProcessors()) {
+        list += "  " + QString(procEnum.valueToKey(desc.first)) + "\t" + desc.second->name + "\n";
+    }
+    return list;
+}
+
+bool parseAddress(const QString& str, AInt& value) {
+    bool ok;
+    value = str.toULongLong(&ok, 0);
+    return ok;
+}
+
+/**
+ * @brief parseWatchpoint
+ * Parses a watchpoint given as "address:size[:types]", where types is any combination of r(ead), w(rite) and c(hange).
+ * Watchpoints without types watch for writes.
+ */
+bool parseWatchpoint(const QString& str, Watchpoint& watchpoint) {
+    const auto fields = str.split(':');
+    if (fields.size() < 2 || fields.size() > 3 || !parseAddress(fields.at(0), watchpoint.address) ||
+        !parseAddress(fields.at(1), watchpoint.size) || watchpoint.size == 0) {
+        return false;
+    }
+    watchpoint.types = fields.size() == 3 ? 0 : Watchpoint::Write;
+    for (const QChar c : fields.size() == 3 ? fields.at(2).toLower() : QString()) {
+        if (c == 'r') {
+            watchpoint.types |= Watchpoint::Read;
+        } else if (c == 'w') {
+            watchpoint.types |= Watchpoint::Write;
+        } else if (c == 'c') {
+            watchpoint.types |= Watchpoint::Change;
+        } else {
+            return false;
+        }
+    }
+    return watchpoint.types != 0;
+}
+
+/**
+ * @brief parseRange
+ * Parses either a single cache geometry value or an inclusive range "from-to" into @p values. Values are bit
+ * counts, bounded like the cache configuration widget.
+ */
+bool parseRange(const QString& str, std::vector<int>& values) {
+    constexpr int maxBits = 10;
+    const auto bounds = str.split('-');
+    bool ok1 = false, ok2 = false;
+    const int from = bounds.at(0).toInt(&ok1);
+    const int to = bounds.size() == 2 ? bounds.at(1).toInt(&ok2) : from;
+    if (!ok1 || (bounds.size() == 2 && !ok2) || bounds.size() > 2 || from < 0 || to < from || to > maxBits) {
+        return false;
+    }
+    values.clear();
+    for (int value = from; value <= to; value++) {
+        values.push_back(value);
+    }
+    return true;
+}
+
+bool parseOptions(const QCoreApplication& app, CLIOptions& options) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless batch simulation of RISC-V programs.\n\nAvailable processors:\n" +
+                                     processorList());
+    parser.addHelpOption();
+    parser.addPositionalArgument("file", "Program to simulate. Not required when replaying a memory trace.");
+
+    const QCommandLineOption typeOpt({"t", "type"}, "Input type: asm, bin or elf (default: asm).", "type", "asm");
+    const QCommandLineOption procOpt({"p", "proc"}, "Processor model to simulate (default: RV32_SS).", "processor",
+                                     "RV32_SS");
+    const QCommandLineOption extOpt("isaexts", "Comma-separated list of ISA extensions to enable (default: M).", "exts",
+                                    "M");
+    const QCommandLineOption entryOpt("entry", "Entry point of flat binary programs (default: 0x0).", "address", "0");
+    const QCommandLineOption loadAtOpt("loadat", "Load address of flat binary programs (default: 0x0).", "address",
+                                       "0");
+    const QCommandLineOption cyclesOpt({"c", "cycles"}, "Maximum number of cycles to simulate (default: unlimited).",
+                                       "cycles", "0");
+    const QCommandLineOption cacheOpt("cache", "Simulate L1 data- and instruction caches.");
+    const QCommandLineOption cacheLinesOpt(
+        "cache-lines", "log2 of the number of cache lines; a range (ie. 2-8) when replaying a trace (default: 5).",
+        "bits", "5");
+    const QCommandLineOption cacheWaysOpt(
+        "cache-ways", "log2 of the number of cache ways; a range when replaying a trace (default: 0).", "bits", "0");
+    const QCommandLineOption cacheBlocksOpt(
+        "cache-blocks", "log2 of the number of words per block; a range when replaying a trace (default: 2).", "bits",
+        "2");
+    const QCommandLineOption cacheReplOpt("cache-repl",
+                                          "Replacement policy: lru or random; a comma-separated list when replaying a "
+                                          "trace (default: lru).",
+                                          "policy", "lru");
+    const QCommandLineOption cacheHitLatencyOpt("cache-hit-latency", "Cycles taken by an L1 cache hit (default: 1).",
+                                                "cycles", "1");
+    const QCommandLineOption cacheMissPenaltyOpt(
+        "cache-miss-penalty",
+        "Additional cycles taken by an L1 cache miss, on top of the latency of the next level (default: 0).", "cycles",
+        "0");
+    const QCommandLineOption l2CacheOpt("l2-cache", "Simulate a unified L2 cache shared by the L1 caches.");
+    const QCommandLineOption l2LinesOpt("l2-lines", "log2 of the number of L2 cache lines (default: 8).", "bits", "8");
+    const QCommandLineOption l2WaysOpt("l2-ways", "log2 of the number of L2 cache ways (default: 2).", "bits", "2");
+    const QCommandLineOption l2BlocksOpt("l2-blocks", "log2 of the number of words per L2 block (default: 2).", "bits",
+                                         "2");
+    const QCommandLineOption l2InclusionOpt("l2-inclusion",
+                                            "Inclusion policy of the L2 cache: non-inclusive, inclusive or exclusive "
+                                            "(default: non-inclusive).",
+                                            "policy", "non-inclusive");
+    const QCommandLineOption l2HitLatencyOpt("l2-hit-latency", "Cycles taken by an L2 cache hit (default: 1).",
+                                             "cycles", "1");
+    const QCommandLineOption l2MissPenaltyOpt(
+        "l2-miss-penalty", "Additional cycles taken by an L2 cache miss; the latency of main memory (default: 0).",
+        "cycles", "0");
+    const QCommandLineOption recordTraceOpt("record-trace", "Record the memory accesses of the program to file.",
+                                            "file");
+    const QCommandLineOption replayTraceOpt(
+        "replay-trace",
+        "Replay a recorded memory trace through every combination of the given L1 cache parameters in parallel, "
+        "instead of simulating a program. Results are printed as CSV.",
+        "file");
+    const QCommandLineOption missCurvesOpt(
+        "miss-curves",
+        "When replaying a trace, print the miss rate of LRU caches of all power-of-two sizes and associativities for "
+        "each of the given block sizes, determined in a single pass through the trace, instead of sweeping.");
+    const QCommandLineOption stdinOpt(
+        "stdin", "File whose contents are provided to the program as stdin. Reading past its end returns end-of-file.",
+        "file");
+    const QCommandLineOption saveCheckpointOpt("save-checkpoint",
+                                               "Save a checkpoint to file once the simulation stops.", "file");
+    const QCommandLineOption restoreCheckpointOpt(
+        "restore-checkpoint", "Restore a checkpoint of the program before starting the simulation.", "file");
+    const QCommandLineOption watchOpt(
+        "watch",
+        "Watch the data memory range given as address:size[:types], where types is any of r(ead), w(rite) and "
+        "c(hange) (default: w). Each watchpoint hit is reported, after which the simulation continues. May be given "
+        "multiple times.",
+        "watchpoint");
+    const QCommandLineOption quietOpt({"q", "quiet"}, "Do not echo program output.");
+    parser.addOptions({typeOpt, procOpt, extOpt, entryOpt, loadAtOpt, cyclesOpt, cacheOpt, cacheLinesOpt,
+                       cacheWaysOpt, cacheBlocksOpt, cacheReplOpt, cacheHitLatencyOpt, cacheMissPenaltyOpt,
+                       l2CacheOpt, l2LinesOpt, l2WaysOpt, l2BlocksOpt, l2InclusionOpt, l2HitLatencyOpt,
+                       l2MissPenaltyOpt, recordTraceOpt, replayTraceOpt, missCurvesOpt, stdinOpt, saveCheckpointOpt,
+                       restoreCheckpointOpt, watchOpt, quietOpt});
+    parser.process(app);
+
+    options.replayTrace = parser.value(replayTraceOpt);
+    options.recordTrace = parser.value(recordTraceOpt);
+    const bool replaying = !options.replayTrace.isEmpty();
+    options.missCurves = parser.isSet(missCurvesOpt);
+    if (options.missCurves && !replaying) {
+        err() << "Error: --miss-curves requires --replay-trace\n";
+        return false;
+    }
+    if (parser.positionalArguments().size() != (replaying ? 0 : 1)) {
+        err() << (replaying ? "Error: a program cannot be simulated when replaying a memory trace\n"
+                            : "Error: expected a single program file\n");
+        return false;
+    }
+    if (!replaying) {
+        options.file = parser.positionalArguments().at(0);
+    }
+
+    const QString type = parser.value(typeOpt).toLower();
+    if (type == "asm") {
+        options.type = SourceType::Assembly;
+    } else if (type == "bin") {
+        options.type = SourceType::FlatBinary;
+    } else if (type == "elf") {
+        options.type = SourceType::ExternalELF;
+    } else {
+        err() << "Error: unknown input type '" << type << "'\n";
+        return false;
+    }
+
+    bool ok;
+    const int procID = QMetaEnum::fromType<ProcessorID>().keyToValue(parser.value(procOpt).toUpper().toUtf8(), &ok);
+    if (!ok || procID == ProcessorID::NUM_PROCESSORS) {
+        err() << "Error: unknown processor '" << parser.value(procOpt) << "'\n";
+        return false;
+    }
+    options.procID = static_cast<ProcessorID>(procID);
+    options.extensions = parser.value(extOpt).split(',', Qt::SkipEmptyParts);
+
+    if (!parseAddress(parser.value(entryOpt), options.binaryEntryPoint) ||
+        !parseAddress(parser.value(loadAtOpt), options.binaryLoadAt)) {
+        err() << "Error: invalid flat binary address\n";
+        return false;
+    }
+
+    options.maxCycles = parser.value(cyclesOpt).toLongLong(&ok);
+    if (!ok || options.maxCycles < 0) {
+        err() << "Error: invalid cycle limit '" << parser.value(cyclesOpt) << "'\n";
+        return false;
+    }
+
+    options.simulateCaches = parser.isSet(cacheOpt);
+    std::vector<int> lines, ways, blocks;
+    if (!parseRange(parser.value(cacheLinesOpt), lines) || !parseRange(parser.value(cacheWaysOpt), ways) ||
+        !parseRange(parser.value(cacheBlocksOpt), blocks)) {
+        err() << "Error: invalid cache geometry\n";
+        return false;
+    }
+    std::vector<ReplPolicy> replPolicies;
+    for (const auto& policy : parser.value(cacheReplOpt).toLower().split(',', Qt::SkipEmptyParts)) {
+        if (policy == "lru") {
+            replPolicies.push_back(ReplPolicy::LRU);
+        } else if (policy == "random") {
+            replPolicies.push_back(ReplPolicy::Random);
+        } else {
+            err() << "Error: unknown replacement policy '" << policy << "'\n";
+            return false;
+        }
+    }
+    if (replPolicies.empty()) {
+        err() << "Error: no replacement policy given\n";
+        return false;
+    }
+    if (!replaying && (lines.size() != 1 || ways.size() != 1 || blocks.size() != 1 || replPolicies.size() != 1)) {
+        err() << "Error: cache parameter ranges are only supported when replaying a memory trace\n";
+        return false;
+    }
+
+    options.cachePreset.name = "CLI";
+    options.cachePreset.lines = lines.front();
+    options.cachePreset.ways = ways.front();
+    options.cachePreset.blocks = blocks.front();
+    options.cachePreset.wrPolicy = WritePolicy::WriteBack;
+    options.cachePreset.wrAllocPolicy = WriteAllocPolicy::WriteAllocate;
+    options.cachePreset.replPolicy = replPolicies.front();
+
+    for (const int lineBits : lines) {
+        for (const int wayBits : ways) {
+            for (const int blockBits : blocks) {
+                for (const auto replPolicy : replPolicies) {
+                    CachePreset preset = options.cachePreset;
+                    preset.lines = lineBits;
+                    preset.ways = wayBits;
+                    preset.blocks = blockBits;
+                    preset.replPolicy = replPolicy;
+                    options.sweepPresets.push_back(preset);
+                }
+            }
+        }
+    }
+
+    const auto parseLatency = [&](const QCommandLineOption& opt, unsigned& cycles, unsigned minimum) {
+        bool valid;
+        cycles = parser.value(opt).toUInt(&valid);
+        if (!valid || cycles < minimum) {
+            err() << "Error: invalid latency '" << parser.value(opt) << "' for --" << opt.names().constFirst() << "\n";
+            return false;
+        }
+        return true;
+    };
+    if (!parseLatency(cacheHitLatencyOpt, options.cacheHitLatency, 1) ||
+        !parseLatency(cacheMissPenaltyOpt, options.cacheMissPenalty, 0) ||
+        !parseLatency(l2HitLatencyOpt, options.l2HitLatency, 1) ||
+        !parseLatency(l2MissPenaltyOpt, options.l2MissPenalty, 0)) {
+        return false;
+    }
+
+    options.simulateL2Cache = parser.isSet(l2CacheOpt);
+    if (options.simulateL2Cache && !options.simulateCaches) {
+        err() << "Error: --l2-cache requires --cache\n";
+        return false;
+    }
+    options.l2CachePreset = options.cachePreset;
+    std::vector<int> l2Lines, l2Ways, l2Blocks;
+    if (!parseRange(parser.value(l2LinesOpt), l2Lines) || !parseRange(parser.value(l2WaysOpt), l2Ways) ||
+        !parseRange(parser.value(l2BlocksOpt), l2Blocks) || l2Lines.size() != 1 || l2Ways.size() != 1 ||
+        l2Blocks.size() != 1) {
+        err() << "Error: invalid L2 cache geometry\n";
+        return false;
+    }
+    options.l2CachePreset.lines = l2Lines.front();
+    options.l2CachePreset.ways = l2Ways.front();
+    options.l2CachePreset.blocks = l2Blocks.front();
+
+    const QString inclusion = parser.value(l2InclusionOpt).toLower();
+    if (inclusion == "non-inclusive") {
+        options.l2InclusionPolicy = InclusionPolicy::NonInclusive;
+    } else if (inclusion == "inclusive") {
+        options.l2InclusionPolicy = InclusionPolicy::Inclusive;
+    } else if (inclusion == "exclusive") {
+        options.l2InclusionPolicy = InclusionPolicy::Exclusive;
+    } else {
+        err() << "Error: unknown inclusion policy '" << inclusion << "'\n";
+        return false;
+    }
+
+    options.stdinFile = parser.value(stdinOpt);
+    options.saveCheckpoint = parser.value(saveCheckpointOpt);
+    options.restoreCheckpoint = parser.value(restoreCheckpointOpt);
+    for (const auto& value : parser.values(watchOpt)) {
+        Watchpoint watchpoint;
+        if (!parseWatchpoint(value, watchpoint)) {
+            err() << "Error: invalid watchpoint '" << value << "'\n";
+            return false;
+        }
+        options.watchpoints.push_back(watchpoint);
+    }
+    options.quiet = parser.isSet(quietOpt);
+    return true;
+}
+
+std::shared_ptr<Program> loadProgram(const CLIOptions& options) {
+    const bool isText = options.type == SourceType::Assembly;
+    QFile file(options.file);
+    if (!file.open(isText ? QIODevice::ReadOnly | QIODevice::Text : QIODevice::ReadOnly)) {
+        err() << "Error: could not open file " << options.file << "\n";
+        return nullptr;
+    }
+
+    auto program = std::make_shared<Program>();
+    switch (options.type) {
+        case SourceType::Assembly: {
+            auto assembler = ProcessorHandler::getAssembler();
+            assembler->setParallel(true);
+            auto res = assembler->assembleRaw(file.readAll());
+            if (res.errors.size() != 0) {
+                err() << "Error: assembling " << options.file << " failed:\n" << res.errors.toString() << "\n";
+                return nullptr;
+            }
+            *program = res.program;
+            break;
+        }
+        case SourceType::FlatBinary:
+            loadFlatBinaryFile(*program, file, options.binaryEntryPoint, options.binaryLoadAt);
+            break;
+        case SourceType::ExternalELF:
+        case SourceType::InternalELF:
+            if (!loadElfFile(*program, file)) {
+                err() << "Error: " << options.file << " is not a valid ELF file\n";
+                return nullptr;
+            }
+            break;
+        case SourceType::C:
+            Q_UNREACHABLE();
+    }
+
+    if (!program->getSection(TEXT_SECTION_NAME)) {
+        err() << "Error: " << options.file << " contains no " << TEXT_SECTION_NAME << " section\n";
+        return nullptr;
+    }
+    return program;
+}
+
+void printCacheStats(const QString& name, const CacheSim& cache) {
+    out() << name << ":\n";
+    out() << "  hits:       " << cache.getHits() << "\n";
+    out() << "  misses:     " << cache.getMisses() << "\n";
+    out() << "  writebacks: " << cache.getWritebacks() << "\n";
+    out() << "  fills:      " << cache.getFills() << "\n";
+    out() << "  hit rate:   " << QString::number(cache.getHitRate(), 'f', 4) << "\n";
+}
+
+/**
+ * @brief replayTrace
+ * Replays the memory trace at @p path through all of @p presets, printing the statistics of each configuration. With
+ * @p missCurves, the miss rate curves of each block size within @p presets are printed instead.
+ */
+int replayTrace(const QString& path, const std::vector<CachePreset>& presets, bool missCurves) {
+    MemoryTrace trace;
+    if (auto error = trace.load(path)) {
+        err() << "Error: " << *error << "\n";
+        return 1;
+    }
+
+    if (missCurves) {
+        std::set<int> blockBits;
+        for (const auto& preset : presets) {
+            blockBits.insert(preset.blocks);
+        }
+        for (const int bits : blockBits) {
+            StackDistanceAnalyzer instrAnalysis(bits), dataAnalysis(bits);
+            trace.forEach([&](const MemoryTrace::Entry& entry) {
+                (entry.stream == MemoryTrace::Stream::Instruction ? instrAnalysis : dataAnalysis).access(entry.address);
+            });
+            out() << "# Instruction accesses\n" << instrAnalysis.csv();
+            out() << "# Data accesses\n" << dataAnalysis.csv();
+        }
+        out().flush();
+        return 0;
+    }
+
+    const auto results = replayMemoryTrace(trace, presets);
+    out() << "lines,ways,blocks,replacement,cache,hits,misses,hit rate,writebacks,fills\n";
+    for (const auto& result : results) {
+        const auto printRow = [&](const QString& name, const CacheSim::CacheAccessTrace& stats) {
+            const int accesses = stats.hits + stats.misses;
+            out() << (1 << result.preset.lines) << "," << (1 << result.preset.ways) << ","
+                  << (1 << result.preset.blocks) << "," << s_cacheReplPolicyStrings.at(result.preset.replPolicy)
+                  << "," << name << "," << stats.hits << "," << stats.misses << ","
+                  << QString::number(accesses != 0 ? static_cast<double>(stats.hits) / accesses : 0.0, 'f', 4) << ","
+                  << stats.writebacks << "," << stats.fills << "\n";
+        };
+        printRow("instruction", result.instr);
+        printRow("data", result.data);
+    }
+    out().flush();
+    return 0;
+}
+
+QString stopReasonString(RunStopReason reason) {
+    switch (reason) {
+        case RunStopReason::Finished:
+            return "program finished";
+        case RunStopReason::CycleBudget:
+            return "cycle limit reached";
+        case RunStopReason::Stopped:
+            return "simulation stopped (ie. a system call failed)";
+        case RunStopReason::Breakpoint:
+            return "breakpoint";
+        case RunStopReason::Watchpoint:
+            return "watchpoint";
+        case RunStopReason::InstructionBudget:
+            return "instruction limit reached";
+        case RunStopReason::Condition:
+            return "stop condition";
+    }
+    Q_UNREACHABLE();
+}
+
+void printWatchpointHit(const WatchpointHit& hit, long long cycle) {
+    static const std::map<Watchpoint::Type, QString> typeNames = {
+        {Watchpoint::Read, "read"}, {Watchpoint::Write, "write"}, {Watchpoint::Change, "change"}};
+    out() << "Watchpoint " << typeNames.at(hit.type) << " 0x" << QString::number(hit.watchpoint.address, 16) << ":"
+          << hit.watchpoint.size << " at cycle " << cycle << ": " << hit.access.bytes << "-byte "
+          << (hit.access.type == MemoryAccess::Read ? "read" : "write") << " of 0x"
+          << QString::number(hit.access.address, 16) << "\n";
+    out().flush();
+}
+
+/**
+ * @brief exitCode
+ * 0 if the program finished, 2 if the cycle limit was reached and 1 if the simulation was stopped otherwise.
+ */
+int exitCode(RunStopReason reason) {
+    switch (reason) {
+        case RunStopReason::Finished:
+            return 0;
+        case RunStopReason::CycleBudget:
+            return 2;
+        default:
+            return 1;
+    }
+}
+
+void printMemoryTraffic(const std::vector<const CacheSim*>& lastLevelCaches) {
+    unsigned reads = 0, writes = 0;
+    for (const auto* cache : lastLevelCaches) {
+        reads += cache->getFills();
+        writes += cache->getWritebacks();
+    }
+    out() << "Main memory traffic:\n";
+    out() << "  block reads: " << reads << "\n";
+    out() << "  writes:      " << writes << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("Ripes-cli");
+
+    CLIOptions options;
+    if (!parseOptions(app, options)) {
+        return 1;
+    }
+    if (!options.replayTrace.isEmpty()) {
+        return replayTrace(options.replayTrace, options.sweepPresets, options.missCurves);
+    }
+
+    // Program output is emitted from the thread which handles the system call; print it directly.
+    QObject::connect(
+        &SystemIO::get(), &SystemIO::doPrint, &app,
+        [&](const QString& str) {
+            if (!options.quiet) {
+                out() << str;
+                out().flush();
+            }
+        },
+        Qt::DirectConnection);
+
+    // There is no user to provide further input, or to acknowledge errors. Reading stdin returns end-of-file once the
+    // --stdin data has been consumed, and system call errors are printed.
+    SystemIO::setHeadless(true);
+    QObject::connect(
+        &SystemIO::get(), &SystemIO::syscallError, &app,
+        [&](const QString& message) {
+            out().flush();
+            err() << "Error: " << message << "\n";
+            err().flush();
+        },
+        Qt::DirectConnection);
+
+    // Batch simulations are never rewound; don't spend time on taking snapshots.
+    ProcessorHandler::setSnapshotInterval(0);
+
+    // Cache shims must be in place before the program is loaded, such that they observe the processor reset.
+    std::shared_ptr<CacheSim> dataCache, instrCache, l2Cache;
+    std::unique_ptr<L1CacheShim> dataShim, instrShim;
+    if (options.simulateCaches) {
+        dataCache = std::make_shared<CacheSim>(nullptr);
+        instrCache = std::make_shared<CacheSim>(nullptr);
+        dataCache->setPreset(options.cachePreset);
+        instrCache->setPreset(options.cachePreset);
+        for (const auto& cache : {dataCache, instrCache}) {
+            cache->setHitLatency(options.cacheHitLatency);
+            cache->setMissPenalty(options.cacheMissPenalty);
+        }
+        dataShim = std::make_unique<L1CacheShim>(L1CacheShim::CacheType::DataCache, nullptr);
+        instrShim = std::make_unique<L1CacheShim>(L1CacheShim::CacheType::InstrCache, nullptr);
+        dataShim->setNextLevelCache(dataCache);
+        instrShim->setNextLevelCache(instrCache);
+    }
+    if (options.simulateL2Cache) {
+        l2Cache = std::make_shared<CacheSim>(nullptr);
+        l2Cache->setPreset(options.l2CachePreset);
+        l2Cache->setInclusionPolicy(options.l2InclusionPolicy);
+        l2Cache->setHitLatency(options.l2HitLatency);
+        l2Cache->setMissPenalty(options.l2MissPenalty);
+        dataCache->setNextLevelCache(l2Cache);
+        instrCache->setNextLevelCache(l2Cache);
+    }
+
+    ProcessorHandler::selectProcessor(options.procID, options.extensions,
+                                      ProcessorRegistry::getDescription(options.procID).defaultRegisterVals);
+
+    std::unique_ptr<MemoryTraceRecorder> traceRecorder;
+    if (!options.recordTrace.isEmpty()) {
+        traceRecorder = std::make_unique<MemoryTraceRecorder>(nullptr);
+    }
+
+    auto program = loadProgram(options);
+    if (!program) {
+        return 1;
+    }
+    ProcessorHandler::loadProgram(program);
+
+    CheckpointCaches checkpointCaches;
+    if (options.simulateCaches) {
+        checkpointCaches = {{"L1 data cache", dataCache}, {"L1 instruction cache", instrCache}};
+    }
+    if (options.simulateL2Cache) {
+        checkpointCaches["L2 cache"] = l2Cache;
+    }
+
+    if (!options.restoreCheckpoint.isEmpty()) {
+        QStringList warnings;
+        if (auto error = restoreCheckpoint(options.restoreCheckpoint, checkpointCaches, warnings)) {
+            err() << "Error: " << *error << "\n";
+            return 1;
+        }
+        for (const auto& warning : warnings) {
+            err() << "Warning: " << warning << "\n";
+        }
+    }
+
+    if (!options.stdinFile.isEmpty()) {
+        QFile stdinFile(options.stdinFile);
+        if (!stdinFile.open(QIODevice::ReadOnly)) {
+            err() << "Error: could not open file " << options.stdinFile << "\n";
+            return 1;
+        }
+        SystemIO::get().putStdInData(stdinFile.readAll());
+    }
+
+    // Watchpoints are set once the memory has been initialized, such that change watchpoints observe the initial
+    // contents.
+    for (const auto& watchpoint : options.watchpoints) {
+        ProcessorHandler::setWatchpoint(watchpoint.address, watchpoint.size, watchpoint.types);
+    }
+
+    // The cycle limit is absolute, whereas the cycle budget of a run is relative to the (restored) cycle count.
+    // Watchpoint hits are reported, after which the run is resumed.
+    const auto* proc = ProcessorHandler::getProcessor();
+    RunStopReason stopReason;
+    do {
+        const long long cycleBudget =
+            options.maxCycles != 0 ? std::max(options.maxCycles - proc->getCycleCount(), 0LL) : 0;
+        if (options.maxCycles != 0 && cycleBudget == 0) {
+            stopReason = RunStopReason::CycleBudget;
+            break;
+        }
+        stopReason = ProcessorHandler::runBlocking(RunCondition::forCycles(cycleBudget));
+        if (stopReason == RunStopReason::Watchpoint) {
+            printWatchpointHit(*ProcessorHandler::lastWatchpointHit(), proc->getCycleCount());
+        }
+    } while (stopReason == RunStopReason::Watchpoint);
+
+    const auto cycles = proc->getCycleCount();
+    const auto instrsRetired = proc->getInstructionsRetired();
+    out() << "\n";
+    out() << "Stopped:              " << stopReasonString(stopReason) << "\n";
+    out() << "Processor:            " << ProcessorRegistry::getDescription(options.procID).name << "\n";
+    out() << "Cycles:               " << cycles << "\n";
+    out() << "Instructions retired: " << instrsRetired << "\n";
+    out() << "CPI:                  "
+          << (instrsRetired != 0 ? QString::number(static_cast<double>(cycles) / instrsRetired, 'f', 4) : "-")
+          << "\n";
+    if (options.simulateCaches) {
+        printCacheStats("L1 data cache", *dataCache);
+        printCacheStats("L1 instruction cache", *instrCache);
+        if (options.simulateL2Cache) {
+            printCacheStats("L2 cache", *l2Cache);
+            printMemoryTraffic({l2Cache.get()});
+        } else {
+            printMemoryTraffic({dataCache.get(), instrCache.get()});
+        }
+    }
+    if (traceRecorder) {
+        out() << "Memory trace:         " << traceRecorder->trace().size() << " accesses ("
+              << traceRecorder->trace().sizeInBytes() << " bytes)\n";
+    }
+    out().flush();
+
+    if (!options.saveCheckpoint.isEmpty()) {
+        if (auto error = saveCheckpoint(options.saveCheckpoint, checkpointCaches)) {
+            err() << "Error: " << *error << "\n";
+            return 1;
+        }
+    }
+
+    if (traceRecorder) {
+        if (auto error = traceRecorder->trace().save(options.recordTrace)) {
+            err() << "Error: " << *error << "\n";
+            return 1;
+        }
+    }
+
+    return exitCode(stopReason);
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QHash>
 #include <QRegularExpression>
 
 #include "assembler_defines.h"
@@ -72,6 +73,65 @@ namespace Assembler {
     using _AssembleRes = AssembleRes<_Reg_T, _Instr_T>;             \
     using _InstrRes = InstrRes<_Reg_T, Instr_T>;
 
+/**
+ * @brief The LineCache class
+ * Caches per-line results of an assembler pass between consecutive assemblies of a program, keyed by the contents of
+ * the line. Entries which were not used since the last call to sweep() are dropped upon the next sweep; the cache thus
+ * holds at most the lines of the two latest programs.
+ */
+template <typename V>
+class LineCache {
+public:
+    std::optional<V> find(const QString& key) {
+        auto it = m_current.constFind(key);
+        if (it != m_current.constEnd()) {
+            return it.value();
+        }
+        auto prev = m_previous.find(key);
+        if (prev == m_previous.end()) {
+            return {};
+        }
+        // Still in use; keep the entry across the next sweep
+        const V value = prev.value();
+        m_previous.erase(prev);
+        m_current.insert(key, value);
+        return value;
+    }
+
+    void insert(const QString& key, const V& value) { m_current.insert(key, value); }
+
+    void sweep() {
+        m_previous.swap(m_current);
+        m_current.clear();
+    }
+
+    void clear() {
+        m_previous.clear();
+        m_current.clear();
+    }
+
+private:
+    QHash<QString, V> m_current;
+    QHash<QString, V> m_previous;
+};
+
+/**
+ * @brief lineKey
+ * @returns a cache key uniquely identifying @p tokens, including their relocations.
+ */
+inline QString lineKey(const LineTokens& tokens) {
+    QString key;
+    for (const auto& token : tokens) {
+        key += token;
+        if (token.hasRelocation()) {
+            key += QChar(0x1E);
+            key += token.relocation();
+        }
+        key += QChar(0x1F);
+    }
+    return key;
+}
+
 class AssemblerBase {
 public:
     virtual ~AssemblerBase() {}
@@ -111,19 +171,37 @@ public:
 
     virtual ExprEvalRes evalExpr(const QString& expr) const = 0;
 
+    /**
+     * @brief setIncremental
+     * In incremental mode, the results of tokenization, pseudo-op expansion and instruction assembly are cached per
+     * source line between consecutive calls to assemble(), such that only lines which changed since the previous
+     * assembly are re-processed. Intended for repeatedly assembling a program while it is being edited.
+     */
+    void setIncremental(bool incremental) {
+        m_incremental = incremental;
+        if (!incremental) {
+            clearLineCaches();
+        }
+    }
+    bool isIncremental() const { return m_incremental; }
+
+    /**
+     * @brief setParallel
+     * In parallel mode, tokenization and pseudo-op expansion of large programs are distributed across the global thread
+     * pool. The assembled program and any errors are identical to those of sequential assembly.
+     */
+    void setParallel(bool parallel) { m_parallel = parallel; }
+    bool isParallel() const { return m_parallel; }
+
 protected:
+    virtual void clearLineCaches() const = 0;
+
     virtual std::variant<Error, LineTokens> tokenize(const QString& line, const int sourceLine) const {
-        // Regex: Split on all empty strings (\s+) and characters [, \[, \], \(, \)] except for quote-delimitered
-        // substrings.
-        const static auto splitter = QRegularExpression(R"((\s+|\,)(?=(?:[^"]*"[^"]*")*[^"]*$))");
-        auto tokens = line.split(splitter);
-        tokens.removeAll(QStringLiteral(""));
-        auto joinedtokens = joinParentheses(tokens);
-        if (auto* err = std::get_if<Error>(&joinedtokens)) {
+        auto tokens = lexLine(line, commentDelimiter());
+        if (auto* err = std::get_if<Error>(&tokens)) {
             err->first = sourceLine;
-            return *err;
         }
-        return std::get<LineTokens>(joinedtokens);
+        return tokens;
     }
 
     virtual HandleDirectiveRes assembleDirective(const DirectiveArg& arg, bool& ok,
@@ -138,28 +216,12 @@ protected:
             return {SymbolLinePair({}, tokens)};
         }
 
-        // Handle the case where a token has been joined together with another token, ie "B:nop"
-        LineTokens splitTokens;
-        splitTokens.reserve(tokens.size());
-        for (const auto& token : tokens) {
-            Token buffer;
-            for (const auto& ch : token) {
-                buffer.append(ch);
-                if (ch == ':') {
-                    splitTokens.push_back(buffer);
-                    buffer.clear();
-                }
-            }
-            if (!buffer.isEmpty()) {
-                splitTokens.push_back(buffer);
-            }
-        }
-
+        // Symbols have been split from any following token during tokenization, ie. "B:nop" => "B:", "nop"
         LineTokens remainingTokens;
-        remainingTokens.reserve(splitTokens.size());
+        remainingTokens.reserve(tokens.size());
         Symbols symbols;
         bool symbolStillAllowed = true;
-        for (const auto& token : splitTokens) {
+        for (const auto& token : tokens) {
             if (token.endsWith(':')) {
                 if (symbolStillAllowed) {
                     const Symbol cleanedSymbol = Symbol(token.left(token.length() - 1), Symbol::Type::Address);
@@ -212,23 +274,6 @@ protected:
         }
     }
 
-    virtual std::variant<Error, LineTokens> splitCommentFromLine(const LineTokens& tokens) const {
-        if (tokens.size() == 0) {
-            return {tokens};
-        }
-
-        LineTokens preCommentTokens;
-        preCommentTokens.reserve(tokens.size());
-        for (const auto& token : tokens) {
-            if (token.contains(commentDelimiter())) {
-                break;
-            } else {
-                preCommentTokens.push_back(token);
-            }
-        }
-        return {preCommentTokens};
-    }
-
     virtual QChar commentDelimiter() const = 0;
 
     /**
@@ -247,6 +292,9 @@ protected:
      * directives to add symbols during assembling.
      */
     mutable SymbolMap m_symbolMap;
+
+    bool m_incremental = false;
+    bool m_parallel = false;
 };
 
 /**
@@ -377,6 +425,87 @@ protected:
 
     using LinkRequests = std::vector<LinkRequest>;
 
+    /**
+     * @brief tokenizeLine
+     * Tokenizes @p line and separates symbols, directive and relocations from the remaining tokens.
+     */
+    std::variant<Error, TokenizedSrcLine> tokenizeLine(const QString& line, int sourceLine) const {
+        TokenizedSrcLine tsl;
+        tsl.sourceLine = sourceLine;
+        auto tokens = tokenize(line, sourceLine);
+        if (auto* err = std::get_if<Error>(&tokens)) {
+            return *err;
+        }
+        // Symbols precede directives
+        auto symbolsAndRest = splitSymbolsFromLine(std::get<LineTokens>(tokens), sourceLine);
+        if (auto* err = std::get_if<Error>(&symbolsAndRest)) {
+            return *err;
+        }
+        tsl.symbols = std::get<SymbolLinePair>(symbolsAndRest).first;
+        auto directiveAndRest = splitDirectivesFromLine(std::get<SymbolLinePair>(symbolsAndRest).second, sourceLine);
+        if (auto* err = std::get_if<Error>(&directiveAndRest)) {
+            return *err;
+        }
+        tsl.directive = std::get<DirectiveLinePair>(directiveAndRest).first;
+        // Parse (and remove) relocation hints from the tokens.
+        auto finalTokens = splitRelocationsFromLine(std::get<DirectiveLinePair>(directiveAndRest).second);
+        if (auto* err = std::get_if<Error>(&finalTokens)) {
+            return *err;
+        }
+        tsl.tokens = std::get<LineTokens>(finalTokens);
+        return tsl;
+    }
+
+    /**
+     * @brief mapLines
+     * Computes @p compute(i) for each of the @p n lines processed by a pass, returning the results in line order. In
+     * incremental mode, results are first looked up in @p cache by @p key(i); @p patch(i, result) restores the
+     * line-specific parts of a cached result. In parallel mode, the remaining lines are computed concurrently. The
+     * results are identical regardless of mode.
+     */
+    template <typename V, typename KeyFunc, typename ComputeFunc, typename PatchFunc>
+    std::vector<V> mapLines(size_t n, LineCache<V>& cache, const KeyFunc& key, const ComputeFunc& compute,
+                            const PatchFunc& patch) const {
+        std::vector<std::optional<V>> results(n);
+        std::vector<QString> keys;
+        if (m_incremental) {
+            keys.resize(n);
+            for (size_t i = 0; i < n; i++) {
+                keys[i] = key(i);
+                results[i] = cache.find(keys[i]);
+                if (results[i]) {
+                    patch(i, results[i].value());
+                }
+            }
+        }
+
+        // Cache lookups are done up front such that only the computation of results happens concurrently.
+        std::vector<char> computed(n, false);
+        const auto computeLines = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                if (!results[i]) {
+                    results[i] = compute(i);
+                    computed[i] = true;
+                }
+            }
+        };
+        if (m_parallel) {
+            forEachChunk(n, s_minLinesPerTask, computeLines);
+        } else {
+            computeLines(0, n);
+        }
+
+        std::vector<V> values;
+        values.reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            if (m_incremental && computed[i]) {
+                cache.insert(keys[i], results[i].value());
+            }
+            values.push_back(std::move(results[i].value()));
+        }
+        return values;
+    }
+
     /**
      * @brief pass0
      * Line tokenization and source line recording
@@ -394,23 +523,35 @@ protected:
          * information if it is a blank symbol (no other information on line).
          */
         Symbols carry;
+        if (m_incremental) {
+            m_tokenizeCache.sweep();
+        }
+
+        // Lines are tokenized independently of each other. Symbol bookkeeping and early directives are then
+        // processed in source order.
+        const auto lines = mapLines(
+            program.size(), m_tokenizeCache, [&](size_t i) { return program.at(i); },
+            [&](size_t i) { return tokenizeLine(program.at(i), i); },
+            [](size_t i, std::variant<Error, TokenizedSrcLine>& res) {
+                // Cached results are keyed by line contents; restore the source line of this occurrence.
+                if (auto* err = std::get_if<Error>(&res)) {
+                    err->first = i;
+                } else {
+                    std::get<TokenizedSrcLine>(res).sourceLine = i;
+                }
+            });
+
         for (int i = 0; i < program.size(); i++) {
-            const auto& line = program.at(i);
-            if (line.isEmpty())
+            if (program.at(i).isEmpty())
                 continue;
-            TokenizedSrcLine tsl;
-            tsl.sourceLine = i;
-            runOperation(tokens, LineTokens, tokenize, program[i], i);
-
-            runOperation(remainingTokens, LineTokens, splitCommentFromLine, tokens);
-
-            // Symbols precede directives
-            runOperation(symbolsAndRest, SymbolLinePair, splitSymbolsFromLine, remainingTokens, i);
-
-            tsl.symbols = symbolsAndRest.first;
+            if (auto* error = std::get_if<Error>(&lines.at(i))) {
+                errors.push_back(*error);
+                continue;
+            }
+            auto tsl = std::get<TokenizedSrcLine>(lines.at(i));
 
             bool uniqueSymbols = true;
-            for (const auto& s : symbolsAndRest.first) {
+            for (const auto& s : tsl.symbols) {
                 if (symbols.count(s) != 0) {
                     errors.push_back(Error(i, "Multiple definitions of symbol '" + s.v + "'"));
                     uniqueSymbols = false;
@@ -420,15 +561,8 @@ protected:
             if (!uniqueSymbols) {
                 continue;
             }
-            symbols.insert(symbolsAndRest.first.begin(), symbolsAndRest.first.end());
-
-            runOperation(directiveAndRest, DirectiveLinePair, splitDirectivesFromLine, symbolsAndRest.second, i);
-            tsl.directive = directiveAndRest.first;
-
-            // Parse (and remove) relocation hints from the tokens.
-            runOperation(finalTokens, LineTokens, splitRelocationsFromLine, directiveAndRest.second);
+            symbols.insert(tsl.symbols.begin(), tsl.symbols.end());
 
-            tsl.tokens = finalTokens;
             if (tsl.tokens.empty() && tsl.directive.isEmpty()) {
                 if (!tsl.symbols.empty()) {
                     carry.insert(tsl.symbols.begin(), tsl.symbols.end());
@@ -461,9 +595,31 @@ protected:
         SourceProgram expandedLines;
         expandedLines.reserve(tokenizedLines.size());
 
+        if (m_incremental) {
+            m_expandCache.sweep();
+            // Pseudo-op expansion may depend on the symbols known prior to assembly (ie. through .equ directives).
+            if (m_symbolMap != m_expandCacheSymbols) {
+                m_expandCache.clear();
+                m_expandCacheSymbols = m_symbolMap;
+            }
+        }
+
+        const auto expansions = mapLines(
+            tokenizedLines.size(), m_expandCache, [&](size_t i) { return lineKey(tokenizedLines.at(i).tokens); },
+            [&](size_t i) { return expandPseudoOp(tokenizedLines.at(i)); },
+            [&](size_t i, PseudoExpandRes& res) {
+                if (auto* err = std::get_if<Error>(&res)) {
+                    err->first = tokenizedLines.at(i).sourceLine;
+                }
+            });
+
         for (unsigned i = 0; i < tokenizedLines.size(); i++) {
             const auto& tokenizedLine = tokenizedLines.at(i);
-            runOperation(expandedOps, std::optional<std::vector<LineTokens>>, expandPseudoOp, tokenizedLine);
+            if (auto* error = std::get_if<Error>(&expansions.at(i))) {
+                errors.push_back(*error);
+                continue;
+            }
+            const auto& expandedOps = std::get<std::optional<std::vector<LineTokens>>>(expansions.at(i));
             if (expandedOps) {
                 /** @note: Original source line is kept for all resulting lines after pseudo-op expantion.
                  * Labels and directives are only kept for the first expanded op.
@@ -512,6 +668,10 @@ protected:
         Errors errors;
         ProgramSection* currentSection = &program.sections.at(m_currentSection);
 
+        if (m_incremental) {
+            m_assembleCache.sweep();
+        }
+
         bool wasDirective;
         for (const auto& line : tokenizedLines) {
             // Get offset of currently emitting position in memory relative to section position
@@ -529,7 +689,7 @@ protected:
             addr_offset = currentSection->data.size();
             if (!wasDirective) {
                 std::weak_ptr<_Instruction> assembledWith;
-                runOperation(machineCode, _InstrRes, assembleInstruction, line, assembledWith);
+                runOperation(machineCode, _InstrRes, assembleLine, line, assembledWith);
 
                 if (!machineCode.linksWithSymbol.symbol.isEmpty()) {
                     LinkRequest req;
@@ -631,6 +791,34 @@ protected:
         }
     }
 
+    /**
+     * @brief assembleLine
+     * Machine code translation of @p line. In incremental mode, the result is looked up in the assembly cache, in
+     * which case @p assembledWith is left unset.
+     */
+    _AssembleRes assembleLine(const TokenizedSrcLine& line, std::weak_ptr<_Instruction>& assembledWith) const {
+        if (!m_incremental) {
+            return assembleInstruction(line, assembledWith);
+        }
+        const QString key = lineKey(line.tokens);
+        if (auto cached = m_assembleCache.find(key)) {
+            if (auto* err = std::get_if<Error>(&cached.value())) {
+                err->first = line.sourceLine;
+            }
+            return cached.value();
+        }
+        auto res = assembleInstruction(line, assembledWith);
+        m_assembleCache.insert(key, res);
+        return res;
+    }
+
+    void clearLineCaches() const override {
+        m_tokenizeCache.clear();
+        m_expandCache.clear();
+        m_expandCacheSymbols.clear();
+        m_assembleCache.clear();
+    }
+
     virtual PseudoExpandRes expandPseudoOp(const TokenizedSrcLine& line) const {
         if (line.tokens.empty()) {
             return PseudoExpandRes(std::nullopt);
@@ -805,6 +993,18 @@ protected:
     std::unique_ptr<_Matcher> m_matcher;
 
     const ISAInfoBase* m_isa;
+
+    /**
+     * @brief Per-line caches of pass 0-2 used in incremental mode. Marked mutable given that assembling is a const
+     * operation.
+     */
+    mutable LineCache<std::variant<Error, TokenizedSrcLine>> m_tokenizeCache;
+    mutable LineCache<PseudoExpandRes> m_expandCache;
+    mutable SymbolMap m_expandCacheSymbols;
+    mutable LineCache<_AssembleRes> m_assembleCache;
+
+    // Minimum number of lines processed by each task in parallel mode
+    static constexpr size_t s_minLinesPerTask = 1024;
 };
 
 }  // namespace Assembler
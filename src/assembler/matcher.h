@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <numeric>
@@ -42,12 +43,46 @@ class Matcher {
         }
     };
 
+    struct DecodeEntry {
+        const Instruction<Reg_T, Instr_T>* instruction = nullptr;
+        int node = -1;  // Index of the decode node to continue matching in, if not an instruction
+    };
+
+    /**
+     * @brief The DecodeNode struct
+     * A node of the match tree flattened into the decoder. If all children of a match node are identified by the same
+     * bit range, the decode node is a lookup table indexed by the value of that range. Otherwise, the children are
+     * matched in order, as in the match tree.
+     */
+    struct DecodeNode {
+        bool isTable = false;
+        unsigned start = 0;
+        Instr_T mask = 0;
+        std::vector<DecodeEntry> entries;
+        std::vector<OpPart<Instr_T>> opParts;  // Non-table nodes only; the OpPart of each entry
+    };
+
 public:
     Matcher(const std::vector<std::shared_ptr<Instruction<Reg_T, Instr_T>>>& instructions)
-        : m_matchRoot(buildMatchTree(instructions, 1)) {}
+        : m_matchRoot(buildMatchTree(instructions, 1)) {
+        buildDecoder(m_matchRoot);
+    }
     void print() const { m_matchRoot.print(); }
 
     std::variant<Error, const Instruction<Reg_T, Instr_T>*> matchInstruction(const Instr_T& instruction) const {
+        auto match = decode(instruction, 0);
+        if (match == nullptr) {
+            return Error(0, "Unknown instruction");
+        }
+        return match;
+    }
+
+    /**
+     * @brief matchInstructionTree
+     * Matches @p instruction by searching the match tree which the decoder is flattened from. Slower than
+     * matchInstruction, but kept as a reference for verifying the decoder.
+     */
+    std::variant<Error, const Instruction<Reg_T, Instr_T>*> matchInstructionTree(const Instr_T& instruction) const {
         auto match = matchInstructionRec(instruction, m_matchRoot, true);
         if (match == nullptr) {
             return Error(0, "Unknown instruction");
@@ -72,6 +107,73 @@ private:
         return nullptr;
     }
 
+    const Instruction<Reg_T, Instr_T>* decode(const Instr_T& instruction, int nodeIdx) const {
+        const DecodeNode& node = m_decoder[nodeIdx];
+        if (node.isTable) {
+            const DecodeEntry& entry = node.entries[(instruction >> node.start) & node.mask];
+            if (entry.instruction || entry.node < 0) {
+                return entry.instruction;
+            }
+            return decode(instruction, entry.node);
+        }
+
+        for (size_t i = 0; i < node.entries.size(); i++) {
+            if (node.opParts[i].matches(instruction)) {
+                const DecodeEntry& entry = node.entries[i];
+                if (entry.instruction) {
+                    return entry.instruction;
+                }
+                if (auto matchedInstr = decode(instruction, entry.node)) {
+                    return matchedInstr;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief buildDecoder
+     * Flattens the match tree rooted at @p node into the decoder.
+     * @returns the index of the decode node of @p node.
+     */
+    int buildDecoder(const MatchNode& node) {
+        const int nodeIdx = static_cast<int>(m_decoder.size());
+        m_decoder.emplace_back();
+
+        DecodeNode decodeNode;
+        if (!node.children.empty()) {
+            const auto& range = node.children.front().matcher.range;
+            decodeNode.isTable =
+                range.width() <= s_maxTableBits &&
+                std::all_of(node.children.begin(), node.children.end(),
+                            [&](const MatchNode& child) { return child.matcher.range == range; });
+            if (decodeNode.isTable) {
+                decodeNode.start = range.start;
+                decodeNode.mask = range.mask;
+                decodeNode.entries.resize(size_t(1) << range.width());
+            }
+        }
+
+        for (const auto& child : node.children) {
+            DecodeEntry entry;
+            if (child.instruction) {
+                entry.instruction = child.instruction.get();
+            } else {
+                entry.node = buildDecoder(child);
+            }
+            if (decodeNode.isTable) {
+                decodeNode.entries[child.matcher.value] = entry;
+            } else {
+                decodeNode.entries.push_back(entry);
+                decodeNode.opParts.push_back(child.matcher);
+            }
+        }
+
+        // Children are built first; m_decoder may have been reallocated.
+        m_decoder[nodeIdx] = std::move(decodeNode);
+        return nodeIdx;
+    }
+
     MatchNode buildMatchTree(const std::vector<std::shared_ptr<Instruction<Reg_T, Instr_T>>>& instructions,
                              const unsigned fieldDepth = 1,
                              OpPart<Instr_T> matcher = OpPart<Instr_T>(0, BitRange<Instr_T>(0, 0, 2))) {
@@ -116,6 +218,12 @@ private:
     }
 
     MatchNode m_matchRoot;
+
+    /**
+     * @brief m_decoder is the match tree flattened into lookup tables, with the root node at index 0.
+     */
+    std::vector<DecodeNode> m_decoder;
+    static constexpr unsigned s_maxTableBits = 12;
 };
 
 }  // namespace Assembler
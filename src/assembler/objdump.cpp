@@ -33,8 +33,8 @@ QString stringifyProgram(std::weak_ptr<const Program> program, Stringifier strin
             dataStream.readRawData(buffer.data(), stride);
 
             // symbol label
-            if (sp->symbols.count(addr)) {
-                const auto& symbol = sp->symbols.at(addr);
+            if (const auto it = sp->symbols.find(addr); it != sp->symbols.end()) {
+                const auto& symbol = it->second;
                 // We are adding non-instruction lines to the output string. Record the line number as well as the sum
                 // of invalid lines up to the given point.
                 incrementAddressOffsetMap(out, addrOffsetMap, infoOffsets);
@@ -1,5 +1,8 @@
 #include "parserutilities.h"
 
+#include <QThread>
+#include <QtConcurrent/QtConcurrent>
+
 #include "binutils.h"
 
 namespace Ripes {
@@ -52,11 +55,6 @@ int64_t getImmediateSext32(const QString& string, bool& success) {
     return value;
 }
 
-/**
- * @brief joinParentheses takes a number of tokens and merges together tokens contained within top-level parentheses.
- * For example:
- * [lw, x10, (B, +, (3*2))(x10)] => [lw, x10, B + 3*2), x10]
- */
 bool matchedParens(std::vector<QChar>& parensStack, QChar end) {
     if (parensStack.size() == 0) {
         return false;
@@ -66,63 +64,120 @@ bool matchedParens(std::vector<QChar>& parensStack, QChar end) {
     return (toMatch == '[' && end == ']') || (toMatch == '(' && end == ')');
 }
 
-std::variant<Error, LineTokens> joinParentheses(const QStringList& tokens) {
-    LineTokens outtokens;
+std::variant<Error, LineTokens> lexLine(const QString& line, QChar commentDelimiter) {
+    LineTokens tokens;
     std::vector<QChar> parensStack;
+    bool inString = false;
 
-    QString tokenBuffer;
-    auto commitBuffer = [&]() {
-        if (!tokenBuffer.isEmpty()) {
-            outtokens << tokenBuffer;
-            tokenBuffer.clear();
+    // The current token is the range [start, end) of the line. If characters are skipped within a token, the
+    // preceding part of the token is moved into 'joined'.
+    int start = -1;
+    int end = -1;
+    QString joined;
+    auto append = [&](int i) {
+        if (start < 0) {
+            start = i;
+        } else if (end != i) {
+            joined.append(line.midRef(start, end - start));
+            start = i;
+        }
+        end = i + 1;
+    };
+    auto commit = [&]() {
+        if (start < 0) {
+            return;
+        }
+        if (joined.isEmpty()) {
+            tokens << Token(line.mid(start, end - start));
+        } else {
+            joined.append(line.midRef(start, end - start));
+            tokens << Token(joined);
+            joined.clear();
         }
+        start = -1;
     };
 
-    for (const auto& token : tokens) {
-        if (token.startsWith("\"") && token.endsWith("\"")) {
-            // String literal; ignore parentheses inside
-            outtokens << token;
+    for (int i = 0; i < line.size(); i++) {
+        const QChar ch = line.at(i);
+        if (inString) {
+            inString = ch != '"';
+            append(i);
             continue;
         }
-        for (const auto& ch : token) {
-            switch (ch.unicode()) {
-                case '(':
-                case '[':
-                    if (!parensStack.empty()) {
-                        tokenBuffer.append(ch);
-                    } else {
-                        commitBuffer();
-                    }
-                    parensStack.push_back(ch);
-                    break;
-                case ']':
-                case ')': {
-                    if (matchedParens(parensStack, ch)) {
-                        if (parensStack.empty()) {
-                            commitBuffer();
-                        } else {
-                            tokenBuffer.append(ch);
-                        }
-                    } else {
-                        return {Error(-1, "Unmatched parenthesis")};
-                    }
-                    break;
-                }
-                default:
-                    tokenBuffer.append(ch);
-                    break;
-            }
+        if (ch == commentDelimiter) {
+            break;
         }
-        if (parensStack.empty()) {
-            commitBuffer();
+        switch (ch.unicode()) {
+            case '"':
+                inString = true;
+                append(i);
+                break;
+            case ',':
+                if (parensStack.empty()) {
+                    commit();
+                }
+                break;
+            case '(':
+            case '[':
+                if (parensStack.empty()) {
+                    commit();
+                } else {
+                    append(i);
+                }
+                parensStack.push_back(ch);
+                break;
+            case ')':
+            case ']':
+                if (!matchedParens(parensStack, ch)) {
+                    return {Error(-1, "Unmatched parenthesis")};
+                }
+                if (parensStack.empty()) {
+                    commit();
+                } else {
+                    append(i);
+                }
+                break;
+            case ':':
+                append(i);
+                if (parensStack.empty()) {
+                    commit();
+                }
+                break;
+            default:
+                if (!ch.isSpace()) {
+                    append(i);
+                } else if (parensStack.empty()) {
+                    commit();
+                }
+                break;
         }
     }
 
-    if (parensStack.empty()) {
-        return outtokens;
-    } else {
+    if (!parensStack.empty()) {
         return {Error(-1, "Unmatched parenthesis")};
     }
+    commit();
+    return tokens;
+}
+
+void forEachChunk(size_t n, size_t minChunkSize, const std::function<void(size_t, size_t)>& f) {
+    const size_t chunks =
+        std::max<size_t>(1, std::min<size_t>(QThread::idealThreadCount(), n / std::max<size_t>(1, minChunkSize)));
+    if (chunks == 1) {
+        f(0, n);
+        return;
+    }
+
+    const size_t chunkSize = (n + chunks - 1) / chunks;
+    std::vector<QFuture<void>> futures;
+    for (size_t begin = chunkSize; begin < n; begin += chunkSize) {
+        futures.push_back(QtConcurrent::run([&f, begin, chunkSize, n] { f(begin, std::min(begin + chunkSize, n)); }));
+    }
+    // The calling thread processes the first chunk
+    f(0, std::min(chunkSize, n));
+    for (auto& future : futures) {
+        future.waitForFinished();
+    }
 }
 
 }  // namespace Assembler
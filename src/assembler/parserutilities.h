@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QStringList>
+#include <functional>
 #include <variant>
 
 #include "assembler_defines.h"
@@ -18,11 +19,23 @@ int64_t getImmediate(const QString& string, bool& canConvert, ImmConvInfo* convI
 int64_t getImmediateSext32(const QString& string, bool& canConvert);
 
 /**
- * @brief joinParentheses takes a number of tokens and merges together tokens contained within top-level parentheses.
- * For example:
- * [lw, x10, (B, +, (3*2))(x10)] => [lw, x10, B + 3*2), x10]
+ * @brief lexLine
+ * Single-pass lexer for an assembler source line. Tokens are separated by whitespace and commas outside of string
+ * literals. Contents of top-level parentheses are joined into a single token with separators removed, ie.
+ * [lw x10, (B + (3*2))(x10)] => [lw, x10, B+(3*2), x10]. A ':' outside of parentheses terminates a token, such that
+ * symbols are split from the remainder of the line, ie. [B:nop] => [B:, nop]. Lexing stops at @p commentDelimiter
+ * outside of string literals.
+ * Tokens are created as substrings of @p line; a token is only built up incrementally when separators are removed
+ * from it.
  */
-std::variant<Error, LineTokens> joinParentheses(const QStringList& tokens);
+std::variant<Error, LineTokens> lexLine(const QString& line, QChar commentDelimiter);
+
+/**
+ * @brief forEachChunk
+ * Splits the range [0, n) into at most one chunk per core, each of at least @p minChunkSize elements, and calls
+ * @p f(begin, end) for each chunk concurrently on the global thread pool. Returns once all chunks have been processed.
+ */
+void forEachChunk(size_t n, size_t minChunkSize, const std::function<void(size_t, size_t)>& f);
 
 }  // namespace Assembler
 }  // namespace Ripes
@@ -4,6 +4,9 @@
 #include <QMap>
 #include <QMetaType>
 #include <QString>
+#include <algorithm>
+#include <limits>
+#include <memory>
 #include <vector>
 
 #include "ripes_types.h"
@@ -47,6 +50,133 @@ public:
 
 using ReverseSymbolMap = std::map<AInt, Symbol>;
 
+struct SymbolInfo {
+    enum class Kind { Label, Function, Object, Section };
+    QString name;
+    AInt address = 0;
+    // Size of the symbol in bytes. 0 if unknown, in which case the symbol is considered to extend up until the next
+    // symbol.
+    AInt size = 0;
+    Kind kind = Kind::Label;
+};
+
+/**
+ * @brief The SymbolIndex class
+ * Address-ordered index of the symbols of a program. Alongside the symbols, the index keeps a sorted list of disjoint
+ * address intervals, each mapped to the innermost symbol covering it, such that the symbol containing an address is
+ * found through a single binary search. Section symbols are only reported when no other symbol covers an address.
+ */
+class SymbolIndex {
+public:
+    SymbolIndex() = default;
+    explicit SymbolIndex(std::vector<SymbolInfo> symbols) : m_symbols(std::move(symbols)) {
+        std::stable_sort(m_symbols.begin(), m_symbols.end(),
+                         [](const SymbolInfo& lhs, const SymbolInfo& rhs) { return lhs.address < rhs.address; });
+        buildIntervals();
+    }
+
+    /**
+     * @brief fromSymbolMap
+     * Builds an index of unsized labels from @p symbols.
+     */
+    static SymbolIndex fromSymbolMap(const ReverseSymbolMap& symbols) {
+        std::vector<SymbolInfo> infos;
+        infos.reserve(symbols.size());
+        for (const auto& it : symbols) {
+            infos.push_back(SymbolInfo{it.second.v, it.first, 0, SymbolInfo::Kind::Label});
+        }
+        return SymbolIndex(std::move(infos));
+    }
+
+    const std::vector<SymbolInfo>& symbols() const { return m_symbols; }
+    bool empty() const { return m_symbols.empty(); }
+
+    /**
+     * @brief containing
+     * @returns the innermost symbol which contains @p address, or nullptr if no symbol does.
+     */
+    const SymbolInfo* containing(AInt address) const {
+        auto it = std::upper_bound(m_intervals.begin(), m_intervals.end(), address,
+                                   [](AInt addr, const Interval& interval) { return addr < interval.start; });
+        if (it == m_intervals.begin()) {
+            return nullptr;
+        }
+        --it;
+        return address < it->end ? &m_symbols[it->symbol] : nullptr;
+    }
+
+private:
+    struct Interval {
+        AInt start;
+        AInt end;
+        size_t symbol;
+    };
+
+    void buildIntervals() {
+        // Effective extent of each symbol. Section symbols are placed outermost, such that any other symbol within the
+        // section takes precedence.
+        struct Extent {
+            AInt start;
+            AInt end;
+            bool isSection;
+            size_t symbol;
+        };
+        std::vector<Extent> extents;
+        for (size_t i = 0; i < m_symbols.size(); i++) {
+            const auto& symbol = m_symbols[i];
+            AInt end = symbol.address + symbol.size;
+            if (symbol.size == 0) {
+                // Unsized symbols extend up until the next symbol at a higher address
+                auto next = std::upper_bound(
+                    m_symbols.begin() + i, m_symbols.end(), symbol.address,
+                    [](AInt addr, const SymbolInfo& other) { return addr < other.address; });
+                end = next != m_symbols.end() ? next->address : symbol.address + 1;
+            }
+            if (end > symbol.address) {
+                extents.push_back({symbol.address, end, symbol.kind == SymbolInfo::Kind::Section, i});
+            }
+        }
+        std::sort(extents.begin(), extents.end(), [](const Extent& lhs, const Extent& rhs) {
+            if (lhs.start != rhs.start) {
+                return lhs.start < rhs.start;
+            }
+            if (lhs.isSection != rhs.isSection) {
+                return lhs.isSection;
+            }
+            return lhs.end > rhs.end;
+        });
+
+        // Sweep the extents in order of their start address, with a stack of the extents covering the current
+        // address. The top of the stack is the innermost extent.
+        m_intervals.clear();
+        std::vector<const Extent*> stack;
+        AInt cursor = 0;
+        const auto emitUntil = [&](AInt pos) {
+            while (!stack.empty()) {
+                const Extent* top = stack.back();
+                const AInt segmentEnd = std::min(top->end, pos);
+                if (cursor < segmentEnd) {
+                    m_intervals.push_back({cursor, segmentEnd, top->symbol});
+                    cursor = segmentEnd;
+                }
+                if (top->end > pos) {
+                    return;
+                }
+                stack.pop_back();
+            }
+        };
+        for (const auto& extent : extents) {
+            emitUntil(extent.start);
+            cursor = extent.start;
+            stack.push_back(&extent);
+        }
+        emitUntil(std::numeric_limits<AInt>::max());
+    }
+
+    std::vector<SymbolInfo> m_symbols;
+    std::vector<Interval> m_intervals;
+};
+
 struct LoadFileParams {
     QString filepath;
     SourceType type;
@@ -58,6 +188,11 @@ struct ProgramSection {
     QString name;
     AInt address;
     QByteArray data;
+    // Number of zero bytes following data (e.g. .bss). These are not materialized; memory which has not been
+    // initialized reads as zero.
+    AInt zeroFillSize = 0;
+
+    AInt size() const { return data.size() + zeroFillSize; }
 };
 
 /**
@@ -70,6 +205,27 @@ struct Program {
     std::map<QString, ProgramSection> sections;
     ReverseSymbolMap symbols;
 
+    /**
+     * @brief symbolIndex
+     * All symbols of the program, including their sizes if known. Built from @p symbols when loading a program which
+     * does not provide a symbol table of its own.
+     */
+    SymbolIndex symbolIndex;
+
+    /**
+     * @brief segments
+     * The memory images to initialize the processor memory with, e.g. the loadable segments of an ELF file. If empty,
+     * the sections of the program are loaded instead.
+     */
+    std::vector<ProgramSection> segments;
+
+    /**
+     * @brief storage
+     * Keeps alive any memory which section data refers to without owning it (see QByteArray::fromRawData), such as
+     * the loaded segments of an ELF file which its sections lie within.
+     */
+    std::shared_ptr<const void> storage;
+
     const ProgramSection* getSection(const QString& name) const {
         const auto secIter =
             std::find_if(sections.begin(), sections.end(), [=](const auto& section) { return section.first == name; });
@@ -18,8 +18,8 @@ CacheConfigWidget::CacheConfigWidget(QWidget* parent) : QWidget(parent), m_ui(ne
     m_ui->setupUi(this);
 
     // Gather a list of all items in this widget which will trigger a modification to the current configuration
-    m_configItems = {m_ui->presets,           m_ui->ways,   m_ui->lines, m_ui->blocks,
-                     m_ui->replacementPolicy, m_ui->wrMiss, m_ui->wrHit};
+    m_configItems = {m_ui->presets, m_ui->ways,  m_ui->lines,           m_ui->blocks,     m_ui->replacementPolicy,
+                     m_ui->wrMiss,  m_ui->wrHit, m_ui->inclusionPolicy, m_ui->hitLatency, m_ui->missPenalty};
 }
 
 void CacheConfigWidget::setCache(const std::shared_ptr<CacheSim>& cache) {
@@ -28,14 +28,19 @@ void CacheConfigWidget::setCache(const std::shared_ptr<CacheSim>& cache) {
     setupEnumCombobox(m_ui->replacementPolicy, s_cacheReplPolicyStrings);
     setupEnumCombobox(m_ui->wrHit, s_cacheWritePolicyStrings);
     setupEnumCombobox(m_ui->wrMiss, s_cacheWriteAllocateStrings);
+    setupEnumCombobox(m_ui->inclusionPolicy, s_cacheInclusionPolicyStrings);
 
     m_ui->ways->setValue(m_cache->getWaysBits());
     m_ui->lines->setValue(m_cache->getLineBits());
     m_ui->blocks->setValue(m_cache->getBlockBits());
+    m_ui->hitLatency->setValue(m_cache->getHitLatency());
+    m_ui->missPenalty->setValue(m_cache->getMissPenalty());
 
     connect(m_ui->ways, QOverload<int>::of(&QSpinBox::valueChanged), m_cache.get(), &CacheSim::setWays);
     connect(m_ui->blocks, QOverload<int>::of(&QSpinBox::valueChanged), m_cache.get(), &CacheSim::setBlocks);
     connect(m_ui->lines, QOverload<int>::of(&QSpinBox::valueChanged), m_cache.get(), &CacheSim::setLines);
+    connect(m_ui->hitLatency, QOverload<int>::of(&QSpinBox::valueChanged), m_cache.get(), &CacheSim::setHitLatency);
+    connect(m_ui->missPenalty, QOverload<int>::of(&QSpinBox::valueChanged), m_cache.get(), &CacheSim::setMissPenalty);
 
     connect(m_ui->replacementPolicy, QOverload<int>::of(&QComboBox::currentIndexChanged), cache.get(), [=](int index) {
         m_cache->setReplacementPolicy(qvariant_cast<ReplPolicy>(m_ui->replacementPolicy->itemData(index)));
@@ -45,6 +50,9 @@ void CacheConfigWidget::setCache(const std::shared_ptr<CacheSim>& cache) {
     connect(m_ui->wrMiss, QOverload<int>::of(&QComboBox::currentIndexChanged), cache.get(), [=](int index) {
         m_cache->setWriteAllocatePolicy(qvariant_cast<WriteAllocPolicy>(m_ui->wrMiss->itemData(index)));
     });
+    connect(m_ui->inclusionPolicy, QOverload<int>::of(&QComboBox::currentIndexChanged), cache.get(), [=](int index) {
+        m_cache->setInclusionPolicy(qvariant_cast<InclusionPolicy>(m_ui->inclusionPolicy->itemData(index)));
+    });
     connect(m_ui->savePresetButton, &QPushButton::clicked, this, &CacheConfigWidget::storePreset);
     m_ui->savePresetButton->setIcon(QIcon(":/icons/save.svg"));
     m_ui->savePresetButton->setToolTip("Store cache preset");
@@ -124,9 +132,12 @@ void CacheConfigWidget::handleConfigurationChanged() {
     m_ui->ways->setValue(m_cache->getWaysBits());
     m_ui->lines->setValue(m_cache->getLineBits());
     m_ui->blocks->setValue(m_cache->getBlockBits());
+    m_ui->hitLatency->setValue(m_cache->getHitLatency());
+    m_ui->missPenalty->setValue(m_cache->getMissPenalty());
     setEnumIndex(m_ui->wrHit, m_cache->getWritePolicy());
     setEnumIndex(m_ui->wrMiss, m_cache->getWriteAllocPolicy());
     setEnumIndex(m_ui->replacementPolicy, m_cache->getReplacementPolicy());
+    setEnumIndex(m_ui->inclusionPolicy, m_cache->getInclusionPolicy());
 
     if (!m_justSetPreset) {
         m_ui->presets->setCurrentIndex(-1);
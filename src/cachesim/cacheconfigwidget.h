@@ -48,4 +48,5 @@ private:
 Q_DECLARE_METATYPE(Ripes::WritePolicy);
 Q_DECLARE_METATYPE(Ripes::WriteAllocPolicy);
 Q_DECLARE_METATYPE(Ripes::ReplPolicy);
+Q_DECLARE_METATYPE(Ripes::InclusionPolicy);
 Q_DECLARE_METATYPE(Ripes::CachePreset);
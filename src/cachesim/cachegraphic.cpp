@@ -83,9 +83,9 @@ CacheGraphic::CacheGraphic(CacheSim& cache) : QGraphicsObject(nullptr), m_cache(
 }
 
 void CacheGraphic::updateLineReplFields(unsigned lineIdx) {
-    auto* cacheLine = m_cache.getLine(lineIdx);
+    const auto cacheLine = m_cache.getLine(lineIdx);
 
-    if (cacheLine == nullptr) {
+    if (!cacheLine) {
         // Nothing to do
         return;
     }
@@ -118,9 +118,11 @@ QString CacheGraphic::addressString() const {
 void CacheGraphic::updateWay(unsigned lineIdx, unsigned wayIdx) {
     CacheWay& way = m_cacheTextItems.at(lineIdx).at(wayIdx);
     CacheSim::CacheWay simWay = CacheSim::CacheWay();
+    std::set<unsigned> simDirtyBlocks;
 
-    if (auto* cacheLine = m_cache.getLine(lineIdx)) {
+    if (const auto cacheLine = m_cache.getLine(lineIdx)) {
         simWay = cacheLine->at(wayIdx);
+        simDirtyBlocks = cacheLine->dirtyBlocks(wayIdx);
     };
 
     // ======================== Update block text fields ======================
@@ -146,7 +148,7 @@ void CacheGraphic::updateWay(unsigned lineIdx, unsigned wayIdx) {
             blockTextItem->setText(text);
             QString tooltip =
                 "Address: " + encodeRadixValue(addressForBlock, Radix::Hex, ProcessorHandler::currentISA()->bytes());
-            if (simWay.dirtyBlocks.count(i)) {
+            if (simDirtyBlocks.count(i)) {
                 tooltip += "\n> Dirty";
             }
             blockTextItem->setToolTip(tooltip);
@@ -191,9 +193,9 @@ void CacheGraphic::updateWay(unsigned lineIdx, unsigned wayIdx) {
     const std::set<unsigned> graphicDirtyBlocks = keys(way.dirtyBlocks);
     std::set<unsigned> newDirtyBlocks;
     std::set<unsigned> dirtyBlocksToDelete;
-    std::set_difference(graphicDirtyBlocks.begin(), graphicDirtyBlocks.end(), simWay.dirtyBlocks.begin(),
-                        simWay.dirtyBlocks.end(), std::inserter(dirtyBlocksToDelete, dirtyBlocksToDelete.begin()));
-    std::set_difference(simWay.dirtyBlocks.begin(), simWay.dirtyBlocks.end(), graphicDirtyBlocks.begin(),
+    std::set_difference(graphicDirtyBlocks.begin(), graphicDirtyBlocks.end(), simDirtyBlocks.begin(),
+                        simDirtyBlocks.end(), std::inserter(dirtyBlocksToDelete, dirtyBlocksToDelete.begin()));
+    std::set_difference(simDirtyBlocks.begin(), simDirtyBlocks.end(), graphicDirtyBlocks.begin(),
                         graphicDirtyBlocks.end(), std::inserter(newDirtyBlocks, newDirtyBlocks.begin()));
 
     // Delete blocks which are not in sync with the current dirty status of the way
@@ -444,9 +446,9 @@ void CacheGraphic::cacheInvalidated() {
 
     // Update all entries in the cache
     for (int lineIdx = 0; lineIdx < m_cache.getLines(); lineIdx++) {
-        if (const auto* line = m_cache.getLine(lineIdx)) {
-            for (const auto& way : *line) {
-                updateWay(lineIdx, way.first);
+        if (const auto line = m_cache.getLine(lineIdx)) {
+            for (unsigned wayIdx = 0; wayIdx < line->size(); wayIdx++) {
+                updateWay(lineIdx, wayIdx);
             }
             updateLineReplFields(lineIdx);
         }
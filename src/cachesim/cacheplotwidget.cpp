@@ -3,12 +3,18 @@
 
 #include <QCheckBox>
 #include <QClipboard>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QFile>
 #include <QFileDialog>
 #include <QPushButton>
+#include <QTextStream>
 #include <QToolBar>
+#include <QVBoxLayout>
 #include <QtCharts/QAreaSeries>
 #include <QtCharts/QChartView>
 #include <QtCharts/QLineSeries>
+#include <QtCharts/QLogValueAxis>
 #include <QtCharts/QValueAxis>
 
 #include <algorithm>
@@ -107,11 +113,13 @@ void CachePlotWidget::setCache(const std::shared_ptr<CacheSim>& cache) {
         if (plotUpdateFunc()) {
             updateRatioPlot();
         }
+        updateMissRateCurves();
     });
     connect(ProcessorHandler::get(), &ProcessorHandler::runFinished, this, [=] {
         if (plotUpdateFunc()) {
             updateRatioPlot();
         }
+        updateMissRateCurves();
     });
     connect(m_cache.get(), &CacheSim::cacheInvalidated, this, [=] {
         updateAllowedRange(RangeChangeSource::Cycles);
@@ -184,6 +192,9 @@ void CachePlotWidget::updateAllowedRange(const RangeChangeSource src) {
 }
 
 CachePlotWidget::~CachePlotWidget() {
+    if (m_cache) {
+        m_cache->setStackDistanceEnabled(false);
+    }
     delete m_ui;
     delete m_plot;
 }
@@ -224,6 +235,108 @@ void CachePlotWidget::setupPlotActions() {
     m_savePlotAction->setIcon(saveIcon);
     m_ui->savePlot->setDefaultAction(m_savePlotAction);
     connect(m_savePlotAction, &QAction::triggered, this, &CachePlotWidget::savePlot);
+
+    m_missRateCurvesAction = new QAction("Show miss rate curves", this);
+    m_missRateCurvesAction->setIcon(QIcon(":/icons/analytics.svg"));
+    m_missRateCurvesAction->setCheckable(true);
+    m_ui->missRateCurves->setDefaultAction(m_missRateCurvesAction);
+    connect(m_missRateCurvesAction, &QAction::toggled, this, &CachePlotWidget::setMissRateCurvesShown);
+    // The analysis is performed from within the simulator thread, and cannot be started while running.
+    connect(ProcessorHandler::get(), &ProcessorHandler::runStarted, m_missRateCurvesAction,
+            [=] { m_missRateCurvesAction->setEnabled(m_missRateCurvesAction->isChecked()); });
+    connect(ProcessorHandler::get(), &ProcessorHandler::runFinished, m_missRateCurvesAction,
+            [=] { m_missRateCurvesAction->setEnabled(true); });
+}
+
+void CachePlotWidget::setMissRateCurvesShown(bool shown) {
+    if (!shown) {
+        m_cache->setStackDistanceEnabled(false);
+        if (m_missRateCurvesDialog) {
+            m_missRateCurvesDialog->hide();
+        }
+        return;
+    }
+
+    // The analysis is only performed while the curves are shown, starting from the current cycle.
+    m_cache->setStackDistanceEnabled(true);
+    if (!m_missRateCurvesDialog) {
+        m_missRateCurvesDialog = new QDialog(this);
+        m_missRateCurvesDialog->setWindowTitle("Miss Rate Curves");
+        auto* layout = new QVBoxLayout(m_missRateCurvesDialog);
+        m_missRateCurvesView = new QChartView(m_missRateCurvesDialog);
+        m_missRateCurvesView->setRenderHint(QPainter::Antialiasing);
+        m_missRateCurvesView->setMinimumSize(640, 420);
+        layout->addWidget(m_missRateCurvesView);
+
+        auto* buttons = new QDialogButtonBox(QDialogButtonBox::Close, m_missRateCurvesDialog);
+        auto* copyButton = buttons->addButton("Copy CSV", QDialogButtonBox::ActionRole);
+        auto* saveButton = buttons->addButton("Save CSV...", QDialogButtonBox::ActionRole);
+        connect(copyButton, &QPushButton::clicked, this,
+                [=] { QApplication::clipboard()->setText(m_cache->getStackDistance().csv()); });
+        connect(saveButton, &QPushButton::clicked, this, [=] {
+            const QString filename =
+                QFileDialog::getSaveFileName(m_missRateCurvesDialog, "Save file", "", "CSV files (*.csv)");
+            if (filename.isEmpty()) {
+                return;
+            }
+            QFile file(filename);
+            if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+                QMessageBox::warning(m_missRateCurvesDialog, "Error",
+                                     "Could not open file " + filename + " for writing");
+                return;
+            }
+            QTextStream(&file) << m_cache->getStackDistance().csv();
+        });
+        connect(buttons, &QDialogButtonBox::rejected, m_missRateCurvesDialog, &QDialog::reject);
+        layout->addWidget(buttons);
+
+        // Closing the dialog stops the analysis
+        connect(m_missRateCurvesDialog, &QDialog::finished, m_missRateCurvesAction,
+                [=] { m_missRateCurvesAction->setChecked(false); });
+    }
+    updateMissRateCurves();
+    m_missRateCurvesDialog->show();
+}
+
+void CachePlotWidget::updateMissRateCurves() {
+    if (!m_missRateCurvesDialog || !m_missRateCurvesDialog->isVisible() || ProcessorHandler::isRunning()) {
+        // The analysis is updated from within the simulator thread
+        return;
+    }
+    const auto& analysis = m_cache->getStackDistance();
+
+    auto* chart = new QChart();
+    auto* axisX = new QLogValueAxis(chart);
+    axisX->setBase(2);
+    axisX->setLabelFormat("%d  ");
+    axisX->setTitleText("Cache size (words)");
+    auto* axisY = new QValueAxis(chart);
+    axisY->setRange(0, 100);
+    axisY->setLabelFormat("%d  ");
+    axisY->setTitleText("Miss rate (%)");
+    chart->addAxis(axisX, Qt::AlignBottom);
+    chart->addAxis(axisY, Qt::AlignLeft);
+
+    // One curve per associativity, over the number of lines
+    for (unsigned wayBits = 0; wayBits <= analysis.getMaxWayBits(); wayBits++) {
+        auto* series = new QLineSeries(chart);
+        series->setName(QString::number(1 << wayBits) + (wayBits == 0 ? " way" : " ways"));
+        for (unsigned lineBits = 0; lineBits <= analysis.getMaxLineBits(); lineBits++) {
+            series->append(1ull << (lineBits + wayBits + analysis.getBlockBits()),
+                           analysis.getMissRate(lineBits, wayBits) * 100.0);
+        }
+        chart->addSeries(series);
+        series->attachAxis(axisX);
+        series->attachAxis(axisY);
+    }
+    chart->setTitle(QString::number(analysis.getAccesses()) + " accesses since cycle " +
+                    QString::number(m_cache->getStackDistanceStartCycle()) + ", " +
+                    QString::number(m_cache->getBlocks()) + " words per block");
+
+    // The chart view does not take ownership of the chart which it replaces.
+    auto* oldChart = m_missRateCurvesView->chart();
+    m_missRateCurvesView->setChart(chart);
+    delete oldChart;
 }
 
 void CachePlotWidget::savePlot() {
@@ -10,6 +10,7 @@
 
 QT_FORWARD_DECLARE_CLASS(QToolBar);
 QT_FORWARD_DECLARE_CLASS(QAction);
+QT_FORWARD_DECLARE_CLASS(QDialog);
 
 QT_CHARTS_BEGIN_NAMESPACE
 class QChartView;
@@ -67,6 +68,13 @@ private:
     std::map<Variable, QList<QPoint>> gatherData(unsigned fromCycle = 0) const;
     void setupPlotActions();
     void showSizeBreakdown();
+    /**
+     * @brief setMissRateCurvesShown
+     * Shows or hides the miss rate of the cache at all power-of-two sizes and associativities, as determined by the
+     * stack distance analysis of the cache. The analysis is only performed while the curves are shown.
+     */
+    void setMissRateCurvesShown(bool shown);
+    void updateMissRateCurves();
     void copyPlotDataToClipboard() const;
     void savePlot();
     void updateRatioPlot();
@@ -105,6 +113,9 @@ private:
     QAction* m_savePlotAction = nullptr;
     QAction* m_totalMarkerAction = nullptr;
     QAction* m_mavgMarkerAction = nullptr;
+    QAction* m_missRateCurvesAction = nullptr;
+    QDialog* m_missRateCurvesDialog = nullptr;
+    QChartView* m_missRateCurvesView = nullptr;
 
     std::vector<QWidget*> m_rangeWidgets;
 };
@@ -5,11 +5,26 @@
 
 #include <QApplication>
 #include <QThread>
+#include <algorithm>
 #include <random>
 #include <utility>
 
 namespace Ripes {
 
+void CacheInterface::setNextLevelCache(const std::shared_ptr<CacheSim>& cache) {
+    // Caches register with their next level cache, such that an inclusive next level may invalidate their blocks.
+    if (auto* self = qobject_cast<CacheSim*>(this)) {
+        if (m_nextLevelCache) {
+            auto& prevLevels = m_nextLevelCache->m_prevLevelCaches;
+            prevLevels.erase(std::remove(prevLevels.begin(), prevLevels.end(), self), prevLevels.end());
+        }
+        if (cache) {
+            cache->m_prevLevelCaches.push_back(self);
+        }
+    }
+    m_nextLevelCache = cache;
+}
+
 void CacheInterface::reset() {
     if (m_nextLevelCache) {
         static_cast<CacheInterface*>(m_nextLevelCache.get())->reset();
@@ -22,6 +37,18 @@ void CacheInterface::reverse() {
     }
 }
 
+void CacheInterface::saveSnapshot(long long cycle) {
+    if (m_nextLevelCache) {
+        static_cast<CacheInterface*>(m_nextLevelCache.get())->saveSnapshot(cycle);
+    }
+}
+
+void CacheInterface::restoreSnapshot(long long cycle) {
+    if (m_nextLevelCache) {
+        static_cast<CacheInterface*>(m_nextLevelCache.get())->restoreSnapshot(cycle);
+    }
+}
+
 CacheSim::CacheSim(QObject* parent) : CacheInterface(parent) {
     connect(ProcessorHandler::get(), &ProcessorHandler::runFinished, this, [=] {
         // Given that we are not updating the graphical state of the cache simulator whilst the processor is running,
@@ -32,15 +59,54 @@ CacheSim::CacheSim(QObject* parent) : CacheInterface(parent) {
     updateConfiguration();
 }
 
-void CacheSim::updateCacheLineReplFields(CacheLine& line, unsigned wayIdx) {
+CacheSim::~CacheSim() {
+    // Unregister from the next level cache
+    setNextLevelCache(nullptr);
+}
+
+unsigned CacheSim::CacheLine::size() const {
+    return m_cache.m_wayCount;
+}
+
+const CacheSim::CacheWay& CacheSim::CacheLine::at(unsigned wayIdx) const {
+    Q_ASSERT(wayIdx < size());
+    return m_cache.m_contents.ways[m_lineIdx * m_cache.m_wayCount + wayIdx];
+}
+
+bool CacheSim::CacheLine::isDirtyBlock(unsigned wayIdx, unsigned blockIdx) const {
+    const uint64_t* dirtyBlocks = m_cache.dirtyBlocksAt(m_lineIdx, wayIdx);
+    return (dirtyBlocks[blockIdx / 64] >> (blockIdx % 64)) & 1;
+}
+
+std::set<unsigned> CacheSim::CacheLine::dirtyBlocks(unsigned wayIdx) const {
+    std::set<unsigned> blocks;
+    for (int i = 0; i < m_cache.getBlocks(); i++) {
+        if (isDirtyBlock(wayIdx, i)) {
+            blocks.insert(i);
+        }
+    }
+    return blocks;
+}
+
+void CacheSim::clearContents() {
+    m_wayCount = getWays();
+    m_dirtyWordsPerWay = (getBlocks() + 63) / 64;
+    const unsigned entries = getLines() * m_wayCount;
+    m_contents.ways.assign(entries, CacheWay());
+    m_contents.dirtyBlocks.assign(entries * m_dirtyWordsPerWay, 0);
+}
+
+void CacheSim::updateCacheLineReplFields(unsigned lineIdx, unsigned wayIdx) {
     if (getReplacementPolicy() == ReplPolicy::LRU) {
+        CacheWay* line = &wayAt(lineIdx, 0);
+
         // Find previous LRU value for the updated index
         const unsigned preLRU = line[wayIdx].lru;
 
         // All indicies which are curently more recent than preLRU shall be incremented
-        for (auto& set : line) {
-            if (set.second.valid && set.second.lru < preLRU) {
-                set.second.lru++;
+        for (unsigned i = 0; i < m_wayCount; i++) {
+            if (line[i].valid && line[i].lru < preLRU) {
+                line[i].lru++;
             }
         }
 
@@ -49,12 +115,14 @@ void CacheSim::updateCacheLineReplFields(CacheLine& line, unsigned wayIdx) {
     }
 }
 
-void CacheSim::revertCacheLineReplFields(CacheLine& line, const CacheWay& oldWay, unsigned wayIdx) {
+void CacheSim::revertCacheLineReplFields(unsigned lineIdx, const CacheWay& oldWay, unsigned wayIdx) {
     if (getReplacementPolicy() == ReplPolicy::LRU) {
+        CacheWay* line = &wayAt(lineIdx, 0);
+
         // All indicies which are curently less than or equal to the old LRU shall be decremented
-        for (auto& set : line) {
-            if (set.second.valid && set.second.lru <= oldWay.lru) {
-                set.second.lru--;
+        for (unsigned i = 0; i < m_wayCount; i++) {
+            if (line[i].valid && line[i].lru <= oldWay.lru) {
+                line[i].lru--;
             }
         }
 
@@ -100,42 +168,31 @@ CacheSim::CacheSize CacheSim::getCacheSize() const {
     return size;
 }
 
-std::pair<unsigned, CacheSim::CacheWay*> CacheSim::locateEvictionWay(const CacheTransaction& transaction) {
-    auto& cacheLine = m_cacheLines[transaction.index.line];
-
-    std::pair<unsigned, CacheSim::CacheWay*> ew;
-    ew.first = s_invalidIndex;
-    ew.second = nullptr;
+unsigned CacheSim::locateEvictionWay(const CacheTransaction& transaction) const {
+    const CacheWay* line = &m_contents.ways[transaction.index.line * m_wayCount];
+    unsigned wayIdx = s_invalidIndex;
 
     // Locate a new way based on replacement policy
     if (m_replPolicy == ReplPolicy::Random) {
         // Select a random way
-        ew.first = std::rand() % getWays();
-        ew.second = &cacheLine[ew.first];
+        wayIdx = std::rand() % m_wayCount;
     } else if (m_replPolicy == ReplPolicy::LRU) {
-        if (getWays() == 1) {
+        if (m_wayCount == 1) {
             // Nothing to do if we are in LRU and only have 1 set
-            ew.first = 0;
-            ew.second = &cacheLine[ew.first];
+            wayIdx = 0;
         } else {
-            // Lazily all ways in the cacheline before starting to iterate
-            for (int i = 0; i < getWays(); i++) {
-                cacheLine[i];
-            }
-
             // If there is an invalid cache line, select that
-            auto it =
-                std::find_if(cacheLine.begin(), cacheLine.end(), [=](const auto& way) { return !way.second.valid; });
-            if (it != cacheLine.end()) {
-                ew.first = it->first;
-                ew.second = &it->second;
+            for (unsigned i = 0; i < m_wayCount; i++) {
+                if (!line[i].valid) {
+                    wayIdx = i;
+                    break;
+                }
             }
-            if (ew.second == nullptr) {
+            if (wayIdx == s_invalidIndex) {
                 // Else, Find LRU way
-                for (auto& way : cacheLine) {
-                    if (static_cast<long>(way.second.lru) == getWays() - 1) {
-                        ew.first = way.first;
-                        ew.second = &way.second;
+                for (unsigned i = 0; i < m_wayCount; i++) {
+                    if (line[i].lru == m_wayCount - 1) {
+                        wayIdx = i;
                         break;
                     }
                 }
@@ -143,40 +200,39 @@ std::pair<unsigned, CacheSim::CacheWay*> CacheSim::locateEvictionWay(const Cache
         }
     }
 
-    Q_ASSERT(ew.first != s_invalidIndex && "Unable to locate way for eviction");
-    Q_ASSERT(ew.second != nullptr && "Unable to locate way for eviction");
-    return ew;
+    Q_ASSERT(wayIdx != s_invalidIndex && "Unable to locate way for eviction");
+    return wayIdx;
 }
 
-CacheSim::CacheWay CacheSim::evictAndUpdate(CacheTransaction& transaction) {
-    const auto [wayIdx, wayPtr] = locateEvictionWay(transaction);
+void CacheSim::evictAndUpdate(CacheTransaction& transaction, CacheTrace& trace) {
+    const unsigned wayIdx = locateEvictionWay(transaction);
+    CacheWay& way = wayAt(transaction.index.line, wayIdx);
+    uint64_t* dirtyBlocks = dirtyBlocksAt(transaction.index.line, wayIdx);
 
-    CacheWay eviction;
-
-    if (!wayPtr->valid) {
+    if (!way.valid) {
         // Record that this was an invalid->valid transition
         transaction.transToValid = true;
     } else {
         // Store the old way info in our eviction trace, in case of rollbacks
-        eviction = *wayPtr;
+        trace.oldWay = way;
 
-        if (eviction.dirty) {
+        if (way.dirty) {
             // The eviction will result in a writeback
             transaction.isWriteback = true;
+            trace.oldDirtyBlocks.assign(dirtyBlocks, dirtyBlocks + m_dirtyWordsPerWay);
         }
     }
 
     // Invalidate the target way
-    *wayPtr = CacheWay();
+    way = CacheWay();
+    std::fill_n(dirtyBlocks, m_dirtyWordsPerWay, 0);
 
     // Set required values in way, reflecting the newly loaded address
-    wayPtr->valid = true;
-    wayPtr->dirty = false;
-    wayPtr->tag = getTag(transaction.address);
+    way.valid = true;
+    way.dirty = false;
+    way.tag = getTag(transaction.address);
     transaction.tagChanged = true;
     transaction.index.way = wayIdx;
-
-    return eviction;
 }
 
 unsigned CacheSim::getHits() const {
@@ -197,6 +253,15 @@ unsigned CacheSim::getMisses() const {
     }
 }
 
+unsigned CacheSim::getFills() const {
+    if (m_accessTrace.size() == 0) {
+        return 0;
+    } else {
+        auto& trace = m_accessTrace.rbegin()->second;
+        return trace.fills;
+    }
+}
+
 unsigned CacheSim::getWritebacks() const {
     if (m_accessTrace.size() == 0) {
         return 0;
@@ -220,13 +285,13 @@ void CacheSim::analyzeCacheAccess(CacheTransaction& transaction) const {
     transaction.index.block = getBlockIdx(transaction.address);
 
     transaction.isHit = false;
-    if (m_cacheLines.count(transaction.index.line) != 0) {
-        for (const auto& way : m_cacheLines.at(transaction.index.line)) {
-            if ((way.second.tag == getTag(transaction.address)) && way.second.valid) {
-                transaction.index.way = way.first;
-                transaction.isHit = true;
-                break;
-            }
+    const CacheWay* line = &m_contents.ways[transaction.index.line * m_wayCount];
+    const unsigned tag = getTag(transaction.address);
+    for (unsigned i = 0; i < m_wayCount; i++) {
+        if ((line[i].tag == tag) && line[i].valid) {
+            transaction.index.way = i;
+            transaction.isHit = true;
+            break;
         }
     }
 }
@@ -234,18 +299,35 @@ void CacheSim::analyzeCacheAccess(CacheTransaction& transaction) const {
 void CacheSim::pushAccessTrace(const CacheTransaction& transaction) {
     // Access traces are pushed in sorted order into the access trace map; indexed by a key corresponding to the cycle
     // of the acces.
-    const unsigned currentCycle = ProcessorHandler::getProcessor()->getCycleCount();
+    const unsigned currentCycle = m_offline ? 0 : ProcessorHandler::getProcessor()->getCycleCount();
 
     const CacheAccessTrace& mostRecentTrace =
         m_accessTrace.size() == 0 ? CacheAccessTrace() : m_accessTrace.rbegin()->second;
 
     m_accessTrace[currentCycle] = CacheAccessTrace(mostRecentTrace, transaction);
 
-    if (!ProcessorHandler::isRunning()) {
+    if (updatesGraphics()) {
         emit hitrateChanged();
     }
 }
 
+void CacheSim::restartStackDistance(long long cycle) {
+    m_stackDistance.reset();
+    m_stackDistanceStartCycle = cycle;
+}
+
+void CacheSim::setStackDistanceEnabled(bool enabled) {
+    if (enabled && !m_stackDistanceEnabled) {
+        restartStackDistance(m_offline ? 0 : ProcessorHandler::getProcessor()->getCycleCount());
+    }
+    m_stackDistanceEnabled = enabled;
+}
+
+bool CacheSim::updatesGraphics() const {
+    // The graphical state of the cache is reloaded once running finishes.
+    return !m_offline && !ProcessorHandler::isRunning();
+}
+
 void CacheSim::popAccessTrace() {
     Q_ASSERT(m_accessTrace.size() > 0);
     // The access trace should have an entry
@@ -253,50 +335,66 @@ void CacheSim::popAccessTrace() {
     emit hitrateChanged();
 }
 
-void CacheSim::access(AInt address, MemoryAccess::Type type) {
+unsigned CacheSim::access(AInt address, MemoryAccess::Type type) {
     address = address & ~0b11;  // Disregard unaligned accesses
+    if (m_stackDistanceEnabled) {
+        m_stackDistance.access(address);
+    }
     CacheTrace trace;
-    CacheWay oldWay;
     CacheTransaction transaction;
     transaction.address = address;
     transaction.type = type;
 
     analyzeCacheAccess(transaction);
 
+    const bool exclusive = m_inclusionPolicy == InclusionPolicy::Exclusive && !m_prevLevelCaches.empty();
+    if (type == MemoryAccess::Read && exclusive) {
+        return accessExclusive(transaction);
+    }
+    // Writes from a lower level which does not hold the block (write-through or no-write-allocate lower levels) must not
+    // allocate the block in an exclusive cache; a hit is updated in place, and a miss is forwarded to the next level.
+    const bool writeAllocate = getWriteAllocPolicy() == WriteAllocPolicy::WriteAllocate && !exclusive;
+
     if (!transaction.isHit) {
-        if (type == MemoryAccess::Read ||
-            (type == MemoryAccess::Write && getWriteAllocPolicy() == WriteAllocPolicy::WriteAllocate)) {
-            oldWay = evictAndUpdate(transaction);
+        if (type == MemoryAccess::Read || (type == MemoryAccess::Write && writeAllocate)) {
+            evictAndUpdate(transaction, trace);
+            transaction.isFill = true;
         }
     } else {
-        oldWay = m_cacheLines[transaction.index.line][transaction.index.way];
+        trace.oldWay = wayAt(transaction.index.line, transaction.index.way);
+        const uint64_t* dirtyBlocks = dirtyBlocksAt(transaction.index.line, transaction.index.way);
+        trace.oldBlockDirty = (dirtyBlocks[transaction.index.block / 64] >> (transaction.index.block % 64)) & 1;
+    }
+
+    const bool evicted = transaction.tagChanged && !transaction.transToValid;
+    bool evictedDirty = false;
+    if (evicted) {
+        evictedDirty = invalidateLowerLevels(trace.oldWay, transaction.index.line);
+        transaction.isWriteback |= evictedDirty;
     }
 
     // === Update dirty and LRU bits ===
 
     // Initially, we need a check for the case of "write + miss + noWriteAlloc". In this case, we should not update
     // replacement/dirty fields. In all other cases, this is a valid action.
-    const bool writeMissNoAlloc =
-        !transaction.isHit && type == MemoryAccess::Write && getWriteAllocPolicy() == WriteAllocPolicy::NoWriteAllocate;
+    const bool writeMissNoAlloc = !transaction.isHit && type == MemoryAccess::Write && !writeAllocate;
 
     if (!writeMissNoAlloc) {
-        // Lazily ensure that the located way has been initialized
-        m_cacheLines[transaction.index.line][transaction.index.way];
-
         if (type == MemoryAccess::Write && getWritePolicy() == WritePolicy::WriteBack) {
-            CacheWay& way = m_cacheLines[transaction.index.line][transaction.index.way];
-            way.dirty = true;
-            way.dirtyBlocks.insert(transaction.index.block);
+            wayAt(transaction.index.line, transaction.index.way).dirty = true;
+            dirtyBlocksAt(transaction.index.line, transaction.index.way)[transaction.index.block / 64] |=
+                uint64_t(1) << (transaction.index.block % 64);
         }
 
-        updateCacheLineReplFields(m_cacheLines[transaction.index.line], transaction.index.way);
+        updateCacheLineReplFields(transaction.index.line, transaction.index.way);
     } else {
         // In case of a write miss with no write allocate, the value is always written through to memory (a writeback)
         transaction.isWriteback = true;
     }
 
     // If our WritePolicy is WriteThrough and this access is a write, the transaction will always result in a WriteBack
-    if (type == MemoryAccess::Write && getWritePolicy() == WritePolicy::WriteThrough) {
+    const bool writeThrough = type == MemoryAccess::Write && getWritePolicy() == WritePolicy::WriteThrough;
+    if (writeThrough) {
         transaction.isWriteback = true;
     }
 
@@ -304,7 +402,6 @@ void CacheSim::access(AInt address, MemoryAccess::Type type) {
 
     // At this point, no further changes shall be made to the transaction.
     // We record the transaction as well as a possible eviction
-    trace.oldWay = oldWay;
     trace.transaction = transaction;
     pushTrace(trace);
     pushAccessTrace(transaction);
@@ -316,60 +413,239 @@ void CacheSim::access(AInt address, MemoryAccess::Type type) {
     }
 
     // It should never be possible that a write returns an invalid way index if we write-allocate
-    if (type == MemoryAccess::Write && getWriteAllocPolicy() == WriteAllocPolicy::WriteAllocate) {
+    if (type == MemoryAccess::Write && writeAllocate) {
         transaction.index.assertValid();
     }
 
     // ===========================
-    if (writeMissNoAlloc) {
-        // There are no graphical changes to perform since nothing is pulled into the cache upon a missed write without
-        // write allocation
-        return;
+    // There are no graphical changes to perform if nothing is pulled into the cache upon a missed write without write
+    // allocation
+    if (!writeMissNoAlloc && updatesGraphics()) {
+        emit dataChanged(transaction);
     }
 
-    if (!ProcessorHandler::isRunning()) {
-        emit dataChanged(transaction);
+    // === Propagate the access through the memory hierarchy ===
+    // The evicted block is written back before the missed block is filled, such that a next level cache does not evict
+    // the block which is being filled. Writes to the next level are assumed to be buffered, and as such only a fill adds
+    // to the latency of the access.
+    unsigned latency = m_hitLatency;
+    if (evicted) {
+        evictToNextLevel(buildAddress(trace.oldWay.tag, transaction.index.line, 0), evictedDirty);
+    }
+    if (writeMissNoAlloc || writeThrough) {
+        accessNextLevel(address, MemoryAccess::Write);
+    }
+    if (transaction.isFill) {
+        latency += m_missPenalty + accessNextLevel(address, MemoryAccess::Read);
+    }
+    return latency;
+}
+
+unsigned CacheSim::accessExclusive(CacheTransaction& transaction) {
+    // A block read by a lower level cache is moved to that level, and a missed block is read from the next level without
+    // being allocated in this cache. The lower levels do not track whether a received block is dirty, so a dirty block
+    // is written back when moved.
+    bool dirty = false;
+    if (transaction.isHit) {
+        dirty = invalidateWay(transaction.index.line, transaction.index.way);
+        transaction.isWriteback = dirty;
+    } else {
+        transaction.isFill = true;
+    }
+    pushAccessTrace(transaction);
+
+    unsigned latency = m_hitLatency;
+    if (dirty) {
+        accessNextLevel(getBlockAddress(transaction.address), MemoryAccess::Write);
+    }
+    if (transaction.isFill) {
+        latency += m_missPenalty + accessNextLevel(transaction.address, MemoryAccess::Read);
+    }
+    return latency;
+}
+
+void CacheSim::insertVictim(AInt address, bool dirty) {
+    CacheTrace trace;
+    CacheTransaction transaction;
+    transaction.address = address & ~0b11;
+
+    analyzeCacheAccess(transaction);
+    if (!transaction.isHit) {
+        evictAndUpdate(transaction, trace);
+    } else {
+        trace.oldWay = wayAt(transaction.index.line, transaction.index.way);
+        const uint64_t* dirtyBlocks = dirtyBlocksAt(transaction.index.line, transaction.index.way);
+        trace.oldDirtyBlocks.assign(dirtyBlocks, dirtyBlocks + m_dirtyWordsPerWay);
+    }
+
+    const bool evicted = transaction.tagChanged && !transaction.transToValid;
+    bool evictedDirty = false;
+    if (evicted) {
+        evictedDirty = invalidateLowerLevels(trace.oldWay, transaction.index.line);
+        transaction.isWriteback |= evictedDirty;
+    }
+
+    const bool writeThrough = dirty && getWritePolicy() == WritePolicy::WriteThrough;
+    if (dirty && !writeThrough) {
+        markDirty(transaction.index.line, transaction.index.way);
+    }
+    updateCacheLineReplFields(transaction.index.line, transaction.index.way);
+
+    trace.transaction = transaction;
+    pushTrace(trace);
+
+    if (updatesGraphics()) {
+        emit wayInvalidated(transaction.index.line, transaction.index.way);
+    }
+
+    if (evicted) {
+        evictToNextLevel(buildAddress(trace.oldWay.tag, transaction.index.line, 0), evictedDirty);
+    }
+    if (writeThrough) {
+        accessNextLevel(getBlockAddress(transaction.address), MemoryAccess::Write);
+    }
+}
+
+bool CacheSim::invalidate(AInt address, unsigned bytes) {
+    const unsigned blockBytes = getBlocks() * 4;
+    bool dirty = false;
+    for (AInt blockAddress = getBlockAddress(address); blockAddress < address + bytes; blockAddress += blockBytes) {
+        CacheTransaction transaction;
+        transaction.address = blockAddress;
+        analyzeCacheAccess(transaction);
+        if (transaction.isHit) {
+            dirty |= invalidateWay(transaction.index.line, transaction.index.way);
+        }
+    }
+    return dirty;
+}
+
+bool CacheSim::invalidateWay(unsigned lineIdx, unsigned wayIdx) {
+    CacheWay* line = &wayAt(lineIdx, 0);
+    CacheWay& way = line[wayIdx];
+    uint64_t* dirtyBlocks = dirtyBlocksAt(lineIdx, wayIdx);
+    const bool dirty = invalidateLowerLevels(way, lineIdx);
+
+    CacheTrace trace;
+    trace.isInvalidation = true;
+    trace.oldWay = way;
+    trace.oldDirtyBlocks.assign(dirtyBlocks, dirtyBlocks + m_dirtyWordsPerWay);
+    trace.transaction.address = buildAddress(way.tag, lineIdx, 0);
+    trace.transaction.index.line = lineIdx;
+    trace.transaction.index.way = wayIdx;
+
+    if (getReplacementPolicy() == ReplPolicy::LRU) {
+        // All ways which are less recently used than the invalidated way move up by one
+        for (unsigned i = 0; i < m_wayCount; i++) {
+            if (i != wayIdx && line[i].valid && line[i].lru > way.lru) {
+                line[i].lru--;
+            }
+        }
+    }
+
+    way = CacheWay();
+    std::fill_n(dirtyBlocks, m_dirtyWordsPerWay, 0);
+    pushTrace(trace);
+
+    if (updatesGraphics()) {
+        emit wayInvalidated(lineIdx, wayIdx);
+    }
+    return dirty;
+}
+
+bool CacheSim::invalidateLowerLevels(const CacheWay& way, unsigned lineIdx) {
+    bool dirty = way.dirty;
+    if (m_inclusionPolicy == InclusionPolicy::Inclusive) {
+        const AInt address = buildAddress(way.tag, lineIdx, 0);
+        for (auto* cache : m_prevLevelCaches) {
+            dirty |= cache->invalidate(address, getBlocks() * 4);
+        }
     }
+    return dirty;
 }
 
-void CacheSim::undo() {
-    if (m_traceStack.size() == 0)
+void CacheSim::evictToNextLevel(AInt address, bool dirty) {
+    if (!m_nextLevelCache) {
         return;
+    }
+    if (m_nextLevelCache->getInclusionPolicy() == InclusionPolicy::Exclusive) {
+        m_nextLevelCache->insertVictim(address, dirty);
+    } else if (dirty) {
+        m_nextLevelCache->access(address, MemoryAccess::Write);
+    }
+}
 
-    const auto trace = popTrace();
-    popAccessTrace();
+unsigned CacheSim::accessNextLevel(AInt address, MemoryAccess::Type type) {
+    return m_nextLevelCache ? m_nextLevelCache->access(address, type) : 0;
+}
 
+void CacheSim::markDirty(unsigned lineIdx, unsigned wayIdx) {
+    wayAt(lineIdx, wayIdx).dirty = true;
+    uint64_t* dirtyBlocks = dirtyBlocksAt(lineIdx, wayIdx);
+    for (int i = 0; i < getBlocks(); i++) {
+        dirtyBlocks[i / 64] |= uint64_t(1) << (i % 64);
+    }
+}
+
+void CacheSim::undoTrace(const CacheTrace& trace) {
     const auto& oldWay = trace.oldWay;
     const unsigned& lineIdx = trace.transaction.index.line;
     const unsigned& wayIdx = trace.transaction.index.way;
-    auto& line = m_cacheLines.at(lineIdx);
-    auto& way = line.at(wayIdx);
-
-    // Case 1: A cache way was transitioned to valid. In this case, we simply invalidate the cache way
-    if (trace.transaction.transToValid) {
-        // Invalidate the way
-        Q_ASSERT(m_cacheLines.at(lineIdx).count(wayIdx) != 0);
-        way = CacheWay();
-    }
-    // Case 2: A miss occured on a valid entry. In this case, we have to restore the old way, which was evicted
-    // - Restore the old entry which was evicted
-    else if (!trace.transaction.isHit) {
-        way = oldWay;
+
+    // A write miss without write allocation did not modify the contents of the cache
+    if (wayIdx == s_invalidIndex) {
+        return;
     }
-    // Case 3: Else, it was a cache hit; Revert replacement fields and dirty blocks
-    way.dirtyBlocks = oldWay.dirtyBlocks;
-    revertCacheLineReplFields(line, oldWay, wayIdx);
 
-    // Notify that changes to the way has been performed
-    emit wayInvalidated(lineIdx, wayIdx);
+    CacheWay* line = &wayAt(lineIdx, 0);
+    auto& way = line[wayIdx];
+    uint64_t* dirtyBlocks = dirtyBlocksAt(lineIdx, wayIdx);
 
-    // Finally, re-emit the transaction which occurred in the previous cache access to update the cache
-    // highlighting state
-    if (m_traceStack.size() > 0) {
-        emit dataChanged(m_traceStack.begin()->transaction);
+    if (trace.isInvalidation) {
+        // Case 0: The way was invalidated by the next level cache. Restore it, and move all ways which were less
+        // recently used than it back down.
+        way = oldWay;
+        std::copy(trace.oldDirtyBlocks.begin(), trace.oldDirtyBlocks.end(), dirtyBlocks);
+        if (getReplacementPolicy() == ReplPolicy::LRU) {
+            for (unsigned i = 0; i < m_wayCount; i++) {
+                if (i != wayIdx && line[i].valid && line[i].lru >= oldWay.lru) {
+                    line[i].lru++;
+                }
+            }
+        }
     } else {
-        emit dataChanged(CacheTransaction());
+        // Case 1: A cache way was transitioned to valid. In this case, we simply invalidate the cache way
+        if (trace.transaction.transToValid) {
+            way = CacheWay();
+            std::fill_n(dirtyBlocks, m_dirtyWordsPerWay, 0);
+        }
+        // Case 2: A miss occured on a valid entry. In this case, we have to restore the old way, which was evicted
+        // - Restore the old entry which was evicted
+        else if (!trace.transaction.isHit) {
+            way = oldWay;
+            if (trace.oldDirtyBlocks.empty()) {
+                std::fill_n(dirtyBlocks, m_dirtyWordsPerWay, 0);
+            } else {
+                std::copy(trace.oldDirtyBlocks.begin(), trace.oldDirtyBlocks.end(), dirtyBlocks);
+            }
+        }
+        // Case 3: Else, it was a cache hit; Revert the dirty state of the accessed block, or of all blocks if a victim
+        // was inserted into the way
+        else {
+            way.dirty = oldWay.dirty;
+            if (!trace.oldDirtyBlocks.empty()) {
+                std::copy(trace.oldDirtyBlocks.begin(), trace.oldDirtyBlocks.end(), dirtyBlocks);
+            } else {
+                const unsigned block = trace.transaction.index.block;
+                dirtyBlocks[block / 64] &= ~(uint64_t(1) << (block % 64));
+                dirtyBlocks[block / 64] |= uint64_t(trace.oldBlockDirty) << (block % 64);
+            }
+        }
+        revertCacheLineReplFields(lineIdx, oldWay, wayIdx);
     }
+
+    // Notify that changes to the way has been performed
+    emit wayInvalidated(lineIdx, wayIdx);
 }
 
 CacheSim::CacheTrace CacheSim::popTrace() {
@@ -379,9 +655,13 @@ CacheSim::CacheTrace CacheSim::popTrace() {
     return val;
 }
 
-void CacheSim::pushTrace(const CacheTrace& eviction) {
-    m_traceStack.push_front(eviction);
-    if (m_traceStack.size() > vsrtl::core::ClockedComponent::reverseStackSize()) {
+void CacheSim::pushTrace(CacheTrace trace) {
+    if (m_offline) {
+        return;
+    }
+    trace.cycle = ProcessorHandler::getProcessor()->getCycleCount();
+    m_traceStack.push_front(trace);
+    while (m_traceStack.back().cycle + vsrtl::core::ClockedComponent::reverseStackSize() < trace.cycle) {
         m_traceStack.pop_back();
     }
 }
@@ -412,32 +692,117 @@ unsigned CacheSim::getBlockIdx(const AInt address) const {
     return maskedAddress;
 }
 
-const CacheSim::CacheLine* CacheSim::getLine(unsigned idx) const {
-    if (m_cacheLines.count(idx)) {
-        return &m_cacheLines.at(idx);
+std::optional<CacheSim::CacheLine> CacheSim::getLine(unsigned idx) const {
+    if (idx < m_contents.ways.size() / m_wayCount) {
+        return CacheLine(*this, idx);
     } else {
-        return nullptr;
+        return {};
     }
 }
 
-void CacheSim::reverse() {
-    if (m_accessTrace.size() == 0) {
-        // Nothing to reverse
-        return;
+CacheSim::CacheState CacheSim::getState() const {
+    CacheState state;
+    state.blocks = m_blocks;
+    state.lines = m_lines;
+    state.ways = m_ways;
+    state.wrPolicy = m_wrPolicy;
+    state.wrAllocPolicy = m_wrAllocPolicy;
+    state.replPolicy = m_replPolicy;
+    state.inclusionPolicy = m_inclusionPolicy;
+    state.contents = m_contents;
+    if (m_accessTrace.size() != 0) {
+        // Only the accumulated statistics of the most recent access are required to continue simulation.
+        state.accessTrace.insert(*m_accessTrace.rbegin());
+    }
+    return state;
+}
+
+bool CacheSim::setState(const CacheState& state) {
+    if (state.blocks != m_blocks || state.lines != m_lines || state.ways != m_ways || state.wrPolicy != m_wrPolicy ||
+        state.wrAllocPolicy != m_wrAllocPolicy || state.replPolicy != m_replPolicy ||
+        state.inclusionPolicy != m_inclusionPolicy ||
+        state.contents.ways.size() != m_contents.ways.size() ||
+        state.contents.dirtyBlocks.size() != m_contents.dirtyBlocks.size()) {
+        return false;
     }
 
+    m_contents = state.contents;
+    m_accessTrace = state.accessTrace;
+    m_traceStack.clear();
+    restartStackDistance(ProcessorHandler::getProcessor()->getCycleCount());
+
+    emit hitrateChanged();
+    emit cacheInvalidated();
+    return true;
+}
+
+void CacheSim::reverse() {
     const unsigned cycleToUndo = ProcessorHandler::getProcessor()->getCycleCount() + 1;
-    if (m_accessTrace.rbegin()->first != cycleToUndo) {
+    bool modified = false;
+
+    // Undo all modifications made within the cycle, most recent first. Besides its own accesses, a cache may have been
+    // modified by the accesses of the other caches in the hierarchy.
+    while (m_traceStack.size() > 0 && m_traceStack.front().cycle == cycleToUndo) {
+        undoTrace(popTrace());
+        modified = true;
+    }
+    if (m_accessTrace.size() > 0 && m_accessTrace.rbegin()->first == cycleToUndo) {
+        popAccessTrace();
+        modified = true;
+    }
+
+    if (!modified) {
         // No cache access in this cycle
         return;
     }
+    restartStackDistance(cycleToUndo - 1);
 
-    // It is now safe to undo the cycle at the top of our access stack(s).
-    undo();
+    // Finally, re-emit the transaction which occurred in the previous cache access to update the cache
+    // highlighting state
+    if (m_traceStack.size() > 0) {
+        emit dataChanged(m_traceStack.begin()->transaction);
+    } else {
+        emit dataChanged(CacheTransaction());
+    }
 
     CacheInterface::reverse();
 }
 
+void CacheSim::saveSnapshot(long long cycle) {
+    // Drop the contents of snapshots which the processor handler has discarded since.
+    for (auto it = m_snapshots.begin(); it != m_snapshots.end();) {
+        it = it->first < cycle && ProcessorHandler::hasSnapshot(it->first) ? std::next(it) : m_snapshots.erase(it);
+    }
+    m_snapshots[cycle] = m_contents;
+
+    CacheInterface::saveSnapshot(cycle);
+}
+
+void CacheSim::restoreSnapshot(long long cycle) {
+    const auto it = m_snapshots.find(cycle);
+    if (it != m_snapshots.end()) {
+        m_contents = it->second;
+    } else {
+        // A cache which did not observe the snapshot starts out cold.
+        clearContents();
+    }
+    m_accessTrace.erase(m_accessTrace.upper_bound(static_cast<unsigned>(cycle)), m_accessTrace.end());
+    m_traceStack.clear();
+    restartStackDistance(cycle);
+
+    // The processor is re-executed from the snapshot after this, so the graphical view is reloaded once that has
+    // finished.
+    QMetaObject::invokeMethod(
+        this,
+        [=] {
+            emit hitrateChanged();
+            emit cacheInvalidated();
+        },
+        Qt::QueuedConnection);
+
+    CacheInterface::restoreSnapshot(cycle);
+}
+
 void CacheSim::reset() {
     /** see comment of m_isResetting */
     if (m_isResetting) {
@@ -446,9 +811,10 @@ void CacheSim::reset() {
 
     m_isResetting = true;
 
-    m_cacheLines.clear();
     m_accessTrace.clear();
     m_traceStack.clear();
+    m_snapshots.clear();
+    restartStackDistance(0);
 
     int bitoffset = 2;  // 2^2 = 4-byte offset (32-bit words in cache)
     m_blockMask = vsrtl::generateBitmask(getBlockBits()) << bitoffset;
@@ -456,6 +822,7 @@ void CacheSim::reset() {
     m_lineMask = vsrtl::generateBitmask(getLineBits()) << bitoffset;
     bitoffset += getLineBits();
     m_tagMask = vsrtl::generateBitmask(32 - bitoffset) << bitoffset;
+    clearContents();
     m_isResetting = false;
 
     emit hitrateChanged();
@@ -472,6 +839,9 @@ void CacheSim::updateConfiguration() {
     m_lineMask = vsrtl::generateBitmask(getLineBits()) << bitoffset;
     bitoffset += getLineBits();
     m_tagMask = vsrtl::generateBitmask(32 - bitoffset) << bitoffset;
+    clearContents();
+    m_stackDistance.setBlockBits(m_blocks);
+    m_stackDistanceStartCycle = 0;
     emit configurationChanged();
 }
 
@@ -505,6 +875,21 @@ void CacheSim::setReplacementPolicy(ReplPolicy policy) {
     updateConfiguration();
 }
 
+void CacheSim::setInclusionPolicy(InclusionPolicy policy) {
+    m_inclusionPolicy = policy;
+    updateConfiguration();
+}
+
+void CacheSim::setHitLatency(unsigned cycles) {
+    m_hitLatency = cycles;
+    updateConfiguration();
+}
+
+void CacheSim::setMissPenalty(unsigned cycles) {
+    m_missPenalty = cycles;
+    updateConfiguration();
+}
+
 void CacheSim::setPreset(const CachePreset& preset) {
     m_blocks = preset.blocks;
     m_ways = preset.ways;
@@ -1,7 +1,11 @@
 #pragma once
 
 #include <math.h>
+#include <atomic>
+#include <cstdint>
 #include <map>
+#include <optional>
+#include <set>
 #include <vector>
 
 #include <QDataStream>
@@ -10,6 +14,7 @@
 #include "../external/VSRTL/core/vsrtl_register.h"
 #include "processors/RISC-V/rv_memory.h"
 #include "processors/interface/ripesprocessor.h"
+#include "stackdistance.h"
 
 namespace Ripes {
 class CacheSim;
@@ -18,6 +23,18 @@ enum WriteAllocPolicy { WriteAllocate, NoWriteAllocate };
 enum WritePolicy { WriteThrough, WriteBack };
 enum ReplPolicy { Random, LRU };
 
+/**
+ * @brief The InclusionPolicy enum
+ * Describes the relation between the contents of a cache and the contents of the lower level caches (closer to the
+ * processor) which it is the next level cache of.
+ * - NonInclusive: Blocks are filled into the cache when missed by a lower level, but may be evicted independently.
+ * - Inclusive: All blocks of the lower levels are contained within the cache. Evicting a block invalidates it within the
+ *   lower levels.
+ * - Exclusive: The cache only contains blocks evicted from the lower levels (a victim cache). A block read by a lower
+ *   level is moved to that level.
+ */
+enum InclusionPolicy { NonInclusive, Inclusive, Exclusive };
+
 struct CachePreset {
     QString name;
     int blocks;
@@ -61,10 +78,18 @@ public:
 
     /**
      * @brief access
-     * A function called by the logical "child" of this cache, indicating that it desires to access this cache
+     * A function called by the logical "child" of this cache, indicating that it desires to access this cache. Returns
+     * the number of cycles taken to service the access.
      */
-    virtual void access(AInt address, MemoryAccess::Type type) = 0;
-    void setNextLevelCache(const std::shared_ptr<CacheSim>& cache) { m_nextLevelCache = cache; }
+    virtual unsigned access(AInt address, MemoryAccess::Type type) = 0;
+
+    /**
+     * @brief setNextLevelCache
+     * Sets the next level (logical parent) cache. A cache may be the next level of multiple caches, ie. a unified cache
+     * shared between the L1 instruction and data caches.
+     */
+    void setNextLevelCache(const std::shared_ptr<CacheSim>& cache);
+    const std::shared_ptr<CacheSim>& getNextLevelCache() const { return m_nextLevelCache; }
 
     /**
      * @brief reset
@@ -73,6 +98,14 @@ public:
     virtual void reset();
     virtual void reverse();
 
+    /**
+     * @brief saveSnapshot/restoreSnapshot
+     * Called by the logical child of this cache to propagate the taking or restoring of a processor snapshot at
+     * @p cycle up the cache hierarchy.
+     */
+    virtual void saveSnapshot(long long cycle);
+    virtual void restoreSnapshot(long long cycle);
+
 protected:
     /**
      * @brief m_nextLevelCache
@@ -93,13 +126,50 @@ public:
 
     struct CacheWay {
         VInt tag = -1;
-        std::set<unsigned> dirtyBlocks;
         bool dirty = false;
         bool valid = false;
 
         // LRU algorithm relies on invalid cache ways to have an initial high value. -1 ensures maximum value for all
         // way sizes.
         unsigned lru = -1;
+
+        template <class Archive>
+        void serialize(Archive& archive) {
+            archive(tag, dirty, valid, lru);
+        }
+    };
+
+    /**
+     * @brief The CacheContents struct
+     * The ways of all cache lines, stored contiguously such that way w of line l is located at index l * getWays() + w.
+     * The dirty blocks of each way are tracked as a bitmask of 64-bit words, stored contiguously in the same order.
+     */
+    struct CacheContents {
+        std::vector<CacheWay> ways;
+        std::vector<uint64_t> dirtyBlocks;
+
+        template <class Archive>
+        void serialize(Archive& archive) {
+            archive(ways, dirtyBlocks);
+        }
+    };
+
+    /**
+     * @brief The CacheLine class
+     * A view of the ways of a single line within the cache.
+     */
+    class CacheLine {
+    public:
+        unsigned size() const;
+        const CacheWay& at(unsigned wayIdx) const;
+        bool isDirtyBlock(unsigned wayIdx, unsigned blockIdx) const;
+        std::set<unsigned> dirtyBlocks(unsigned wayIdx) const;
+
+    private:
+        friend class CacheSim;
+        CacheLine(const CacheSim& cache, unsigned lineIdx) : m_cache(cache), m_lineIdx(lineIdx) {}
+        const CacheSim& m_cache;
+        unsigned m_lineIdx;
     };
 
     struct CacheIndex {
@@ -123,6 +193,7 @@ public:
 
         bool isHit = false;
         bool isWriteback = false;  // True if the transaction resulted in an eviction of a dirty cacheline
+        bool isFill = false;       // True if the accessed block was read from the next level of the memory hierarchy
         MemoryAccess::Type type = MemoryAccess::None;
         bool transToValid = false;  // True if the cacheline just transitioned from invalid to valid
         bool tagChanged = false;    // True if transToValid or the previous entry was evicted
@@ -134,38 +205,125 @@ public:
         int reads = 0;
         int writes = 0;
         int writebacks = 0;
+        int fills = 0;
         CacheAccessTrace() {}
         CacheAccessTrace(const CacheTransaction& transaction) : CacheAccessTrace(CacheAccessTrace(), transaction) {}
         CacheAccessTrace(const CacheAccessTrace& pre, const CacheTransaction& transaction) {
             reads = pre.reads + (transaction.type == MemoryAccess::Read ? 1 : 0);
             writes = pre.writes + (transaction.type == MemoryAccess::Write ? 1 : 0);
             writebacks = pre.writebacks + (transaction.isWriteback ? 1 : 0);
+            fills = pre.fills + (transaction.isFill ? 1 : 0);
             hits = pre.hits + (transaction.isHit ? 1 : 0);
             misses = pre.misses + (transaction.isHit ? 0 : 1);
         }
+
+        template <class Archive>
+        void serialize(Archive& archive) {
+            archive(hits, misses, reads, writes, writebacks, fills);
+        }
     };
 
-    using CacheLine = std::map<unsigned, CacheWay>;
+    /**
+     * @brief The CacheState struct
+     * Configuration and contents of the cache, alongside the most recent access statistics. Used for checkpointing.
+     */
+    struct CacheState {
+        int blocks;
+        int lines;
+        int ways;
+        WritePolicy wrPolicy;
+        WriteAllocPolicy wrAllocPolicy;
+        ReplPolicy replPolicy;
+        InclusionPolicy inclusionPolicy;
+        CacheContents contents;
+        std::map<unsigned, CacheAccessTrace> accessTrace;
+
+        template <class Archive>
+        void serialize(Archive& archive) {
+            archive(blocks, lines, ways, wrPolicy, wrAllocPolicy, replPolicy, inclusionPolicy, contents, accessTrace);
+        }
+    };
 
     CacheSim(QObject* parent);
+    ~CacheSim() override;
     void setWritePolicy(WritePolicy policy);
     void setWriteAllocatePolicy(WriteAllocPolicy policy);
     void setReplacementPolicy(ReplPolicy policy);
+    void setInclusionPolicy(InclusionPolicy policy);
+
+    /**
+     * @brief setHitLatency/setMissPenalty
+     * Timing of the cache. A hit takes the hit latency, whereas a miss additionally takes the miss penalty and the time
+     * taken by the next level cache to provide the block. The miss penalty of the last level cache is thus the latency
+     * of main memory.
+     */
+    void setHitLatency(unsigned cycles);
+    void setMissPenalty(unsigned cycles);
+
+    /**
+     * @brief setOffline
+     * An offline cache is detached from the processor, ie. when replaying a recorded memory trace. Accesses are not
+     * recorded for reversal, no graphical updates are signalled and the access statistics are accumulated in a single
+     * entry. Offline caches may be accessed from a worker thread.
+     */
+    void setOffline(bool offline) { m_offline = offline; }
+
+    unsigned access(AInt address, MemoryAccess::Type type) override;
+
+    /**
+     * @brief insertVictim
+     * Called by a lower level cache when evicting the block at @p address into this (exclusive) cache. The insertion is
+     * not counted as an access to this cache.
+     */
+    void insertVictim(AInt address, bool dirty);
+
+    /**
+     * @brief invalidate
+     * Invalidates all blocks within the @p bytes bytes starting at @p address, as requested by an inclusive next level
+     * cache evicting the range. Returns true if any of the invalidated blocks were dirty.
+     */
+    bool invalidate(AInt address, unsigned bytes);
 
-    void access(AInt address, MemoryAccess::Type type) override;
-    void undo();
     void reset() override;
+    void saveSnapshot(long long cycle) override;
+    void restoreSnapshot(long long cycle) override;
 
     WriteAllocPolicy getWriteAllocPolicy() const { return m_wrAllocPolicy; }
     ReplPolicy getReplacementPolicy() const { return m_replPolicy; }
     WritePolicy getWritePolicy() const { return m_wrPolicy; }
+    InclusionPolicy getInclusionPolicy() const { return m_inclusionPolicy; }
+    unsigned getHitLatency() const { return m_hitLatency; }
+    unsigned getMissPenalty() const { return m_missPenalty; }
 
     const std::map<unsigned, CacheAccessTrace>& getAccessTrace() const { return m_accessTrace; }
 
+    /**
+     * @brief getStackDistance
+     * Stack distance analysis of the accesses to this cache, from which the miss rate of this cache at any other
+     * power-of-two number of lines and ways is derived. The analysis cannot be reversed; reversing the cache or
+     * restoring a snapshot restarts the analysis at the current cycle, as returned by getStackDistanceStartCycle.
+     * The analysis is only performed while enabled through setStackDistanceEnabled.
+     */
+    const StackDistanceAnalyzer& getStackDistance() const { return m_stackDistance; }
+    long long getStackDistanceStartCycle() const { return m_stackDistanceStartCycle; }
+    /**
+     * @brief setStackDistanceEnabled
+     * Enables or disables the stack distance analysis, which is disabled by default given its per-access cost. Enabling
+     * the analysis restarts it at the current cycle. Must not be enabled while the processor is running.
+     */
+    void setStackDistanceEnabled(bool enabled);
+    bool isStackDistanceEnabled() const { return m_stackDistanceEnabled; }
+
     double getHitRate() const;
     unsigned getHits() const;
     unsigned getMisses() const;
     unsigned getWritebacks() const;
+    /**
+     * @brief getFills
+     * Returns the number of blocks read from the next level of the memory hierarchy. Together with the writebacks, this
+     * is the traffic between this cache and the next level; for the last level cache, the traffic to main memory.
+     */
+    unsigned getFills() const;
     CacheSize getCacheSize() const;
 
     AInt buildAddress(unsigned tag, unsigned lineIdx, unsigned blockIdx) const;
@@ -186,7 +344,16 @@ public:
     unsigned getBlockIdx(const AInt address) const;
     unsigned getTag(const AInt address) const;
 
-    const CacheLine* getLine(unsigned idx) const;
+    std::optional<CacheLine> getLine(unsigned idx) const;
+
+    /**
+     * @brief getState/setState
+     * Retrieves or restores the contents of the cache. The cache history is not captured; the restored cache cannot be
+     * reversed beyond the point of restoring. setState returns false, leaving the cache unmodified, if @p state was
+     * captured from a cache with a different configuration than the current.
+     */
+    CacheState getState() const;
+    bool setState(const CacheState& state);
 
 public slots:
     void setBlocks(unsigned blocks);
@@ -220,16 +387,55 @@ signals:
     void cacheInvalidated();
 
 private:
+    friend class CacheInterface;
+
     struct CacheTrace {
         CacheTransaction transaction;
         CacheWay oldWay;
+        // Dirty blocks of an evicted dirty way, or of a way which was invalidated or had a victim inserted. Otherwise,
+        // only the dirty state of the accessed block may have changed.
+        std::vector<uint64_t> oldDirtyBlocks;
+        bool oldBlockDirty = false;
+        // True if the way was invalidated by the next level cache rather than accessed.
+        bool isInvalidation = false;
+        unsigned cycle = 0;
     };
 
-    std::pair<unsigned, CacheSim::CacheWay*> locateEvictionWay(const CacheTransaction& transaction);
-    CacheWay evictAndUpdate(CacheTransaction& transaction);
+    unsigned locateEvictionWay(const CacheTransaction& transaction) const;
+    void evictAndUpdate(CacheTransaction& transaction, CacheTrace& trace);
     void analyzeCacheAccess(CacheTransaction& transaction) const;
+    void undoTrace(const CacheTrace& trace);
+
+    /**
+     * @brief invalidateWay
+     * Invalidates way @p wayIdx of line @p lineIdx, propagating the invalidation to the lower level caches if this cache
+     * is inclusive. Returns true if the way, or any of its copies in the lower levels, was dirty.
+     */
+    bool invalidateWay(unsigned lineIdx, unsigned wayIdx);
+
+    /**
+     * @brief invalidateLowerLevels
+     * Called when @p way of line @p lineIdx is about to be evicted or invalidated. An inclusive cache invalidates the
+     * block within the lower level caches. Returns true if the block, or any of its copies in the lower levels, is
+     * dirty and must be written back.
+     */
+    bool invalidateLowerLevels(const CacheWay& way, unsigned lineIdx);
+
+    /**
+     * @brief evictToNextLevel
+     * Hands the block at @p address, evicted from this cache, to the next level cache. Dirty blocks are written back,
+     * and an exclusive next level cache receives the block regardless.
+     */
+    void evictToNextLevel(AInt address, bool dirty);
+    unsigned accessNextLevel(AInt address, MemoryAccess::Type type);
+
+    unsigned accessExclusive(CacheTransaction& transaction);
+    void markDirty(unsigned lineIdx, unsigned wayIdx);
+    AInt getBlockAddress(AInt address) const { return address & (m_tagMask | m_lineMask); }
     void pushAccessTrace(const CacheTransaction& transaction);
     void popAccessTrace();
+    bool updatesGraphics() const;
+    void restartStackDistance(long long cycle);
 
     /**
      * @brief updateConfiguration
@@ -246,6 +452,15 @@ private:
     ReplPolicy m_replPolicy = ReplPolicy::LRU;
     WritePolicy m_wrPolicy = WritePolicy::WriteBack;
     WriteAllocPolicy m_wrAllocPolicy = WriteAllocPolicy::WriteAllocate;
+    InclusionPolicy m_inclusionPolicy = InclusionPolicy::NonInclusive;
+    unsigned m_hitLatency = 1;
+    unsigned m_missPenalty = 0;
+
+    /**
+     * @brief m_prevLevelCaches
+     * The lower level caches which this cache is the next level cache of.
+     */
+    std::vector<CacheSim*> m_prevLevelCaches;
 
     unsigned m_blockMask = -1;
     unsigned m_lineMask = -1;
@@ -256,18 +471,33 @@ private:
     int m_ways = 0;    // Some power of 2
 
     /**
-     * @brief m_cacheLines
+     * @brief m_contents
      * The datastructure for storing our cache hierachy, as per the current cache configuration.
      */
-    std::map<unsigned, CacheLine> m_cacheLines;
+    CacheContents m_contents;
+    unsigned m_wayCount = 1;
+    unsigned m_dirtyWordsPerWay = 1;
+
+    /**
+     * @brief clearContents
+     * Sizes m_contents to the current cache configuration, with all ways being invalid.
+     */
+    void clearContents();
+    CacheWay& wayAt(unsigned lineIdx, unsigned wayIdx) { return m_contents.ways[lineIdx * m_wayCount + wayIdx]; }
+    uint64_t* dirtyBlocksAt(unsigned lineIdx, unsigned wayIdx) {
+        return &m_contents.dirtyBlocks[(lineIdx * m_wayCount + wayIdx) * m_dirtyWordsPerWay];
+    }
+    const uint64_t* dirtyBlocksAt(unsigned lineIdx, unsigned wayIdx) const {
+        return &m_contents.dirtyBlocks[(lineIdx * m_wayCount + wayIdx) * m_dirtyWordsPerWay];
+    }
 
-    void updateCacheLineReplFields(CacheLine& line, unsigned wayIdx);
+    void updateCacheLineReplFields(unsigned lineIdx, unsigned wayIdx);
     /**
      * @brief revertCacheLineReplFields
      * Called whenever undoing a transaction to the cache. Reverts a cacheline's replacement fields according to the
      * configured replacement policy.
      */
-    void revertCacheLineReplFields(CacheLine& line, const CacheWay& oldWay, unsigned wayIdx);
+    void revertCacheLineReplFields(unsigned lineIdx, const CacheWay& oldWay, unsigned wayIdx);
 
     /**
      * @brief m_accessTrace
@@ -278,12 +508,20 @@ private:
 
     /**
      * @brief m_traceStack
-     * The following information is used to track all most-recent modifications made to the stack. The stack is of a
-     * fixed sized which is equal to the undo stack of VSRTL memory elements. Storing all modifications allows us to
-     * rollback any changes performed to the cache, when clock cycles are undone.
+     * The following information is used to track all most-recent modifications made to the stack. The stack covers as
+     * many cycles as the undo stack of VSRTL memory elements. A cache may be modified multiple times within a cycle, ie.
+     * when shared between multiple lower level caches. Storing all modifications allows us to rollback any changes
+     * performed to the cache, when clock cycles are undone.
      */
     std::deque<CacheTrace> m_traceStack;
 
+    /**
+     * @brief m_snapshots
+     * Contents of the cache at each of the processor snapshots, indexed by the cycle of the snapshot. The access trace
+     * needs not be stored; it is truncated to the snapshot cycle upon restoring.
+     */
+    std::map<long long, CacheContents> m_snapshots;
+
     /**
      * @brief m_isResetting
      * The cacheSim can be reset by either internally modyfing cache configuration parameters or externally through a
@@ -293,8 +531,15 @@ private:
      */
     bool m_isResetting = false;
 
+    bool m_offline = false;
+
+    StackDistanceAnalyzer m_stackDistance;
+    long long m_stackDistanceStartCycle = 0;
+    // May be disabled from the GUI thread while the simulator thread accesses the cache.
+    std::atomic<bool> m_stackDistanceEnabled{false};
+
     CacheTrace popTrace();
-    void pushTrace(const CacheTrace& trace);
+    void pushTrace(CacheTrace trace);
 };
 
 const static std::map<ReplPolicy, QString> s_cacheReplPolicyStrings{{ReplPolicy::Random, "Random"},
@@ -306,6 +551,11 @@ const static std::map<WriteAllocPolicy, QString> s_cacheWriteAllocateStrings{
 const static std::map<WritePolicy, QString> s_cacheWritePolicyStrings{{WritePolicy::WriteThrough, "Write-through"},
                                                                       {WritePolicy::WriteBack, "Write-back"}};
 
+const static std::map<InclusionPolicy, QString> s_cacheInclusionPolicyStrings{
+    {InclusionPolicy::NonInclusive, "Non-inclusive"},
+    {InclusionPolicy::Inclusive, "Inclusive"},
+    {InclusionPolicy::Exclusive, "Exclusive"}};
+
 }  // namespace Ripes
 
 Q_DECLARE_METATYPE(Ripes::CacheSim::CacheTransaction);
@@ -1,6 +1,7 @@
 #include "l1cacheshim.h"
 
 #include "processorhandler.h"
+#include "profiler.h"
 
 namespace Ripes {
 
@@ -14,12 +15,18 @@ L1CacheShim::L1CacheShim(CacheType type, QObject* parent) : CacheInterface(paren
             Qt::DirectConnection);
     connect(ProcessorHandler::get(), &ProcessorHandler::processorReversed, this, &L1CacheShim::processorReversed);
 
+    // Snapshots may be taken from within the simulator thread, in lockstep with the processor.
+    connect(ProcessorHandler::get(), &ProcessorHandler::snapshotTaken, this, &L1CacheShim::saveSnapshot,
+            Qt::DirectConnection);
+    connect(ProcessorHandler::get(), &ProcessorHandler::snapshotRestored, this, &L1CacheShim::restoreSnapshot);
+
     processorReset();
 }
 
-void L1CacheShim::access(AInt, MemoryAccess::Type) {
+unsigned L1CacheShim::access(AInt, MemoryAccess::Type) {
     // Should never occur; the shim determines accesses based on investigating the associated memory.
     Q_ASSERT(false);
+    return 0;
 }
 
 void L1CacheShim::processorReset() {
@@ -29,7 +36,7 @@ void L1CacheShim::processorReset() {
     if (m_nextLevelCache) {
         // Reload the initial (cycle 0) state of the processor. This is necessary to reflect ie. the instruction which
         // is loaded from the instruction memory in cycle 0.
-        processorWasClocked();
+        accessMemory();
     }
 }
 
@@ -39,16 +46,33 @@ void L1CacheShim::processorReversed() {
 }
 
 void L1CacheShim::processorWasClocked() {
+    auto* proc = ProcessorHandler::getProcessorNonConst();
+    if (proc->isStalledForMemory()) {
+        // The accesses of a stalled processor have already been serviced in the cycle which caused the stall.
+        return;
+    }
+
+    // An access which takes longer than a single cycle holds the processor until the access completes.
+    const unsigned latency = accessMemory();
+    if (latency > 1) {
+        proc->stallForMemory(latency - 1);
+    }
+}
+
+unsigned L1CacheShim::accessMemory() {
+    const bool profiling = Profiler::get().isEnabled();
+    const unsigned misses = profiling ? m_nextLevelCache->getMisses() : 0;
+    unsigned latency = 0;
     if (m_type == CacheType::DataCache) {
         const auto dataAccess = ProcessorHandler::getProcessor()->dataMemAccess();
 
         // Determine whether the memory is being accessed in the current cycle, and if so, the access type.
         switch (dataAccess.type) {
             case MemoryAccess::Write:
-                m_nextLevelCache->access(dataAccess.address, MemoryAccess::Write);
+                latency = m_nextLevelCache->access(dataAccess.address, MemoryAccess::Write);
                 break;
             case MemoryAccess::Read:
-                m_nextLevelCache->access(dataAccess.address, MemoryAccess::Read);
+                latency = m_nextLevelCache->access(dataAccess.address, MemoryAccess::Read);
                 break;
             case MemoryAccess::None:
             default:
@@ -57,9 +81,27 @@ void L1CacheShim::processorWasClocked() {
     } else {
         const auto instrAccess = ProcessorHandler::getProcessor()->instrMemAccess();
         if (instrAccess.type == MemoryAccess::Read) {
-            m_nextLevelCache->access(instrAccess.address, MemoryAccess::Read);
+            latency = m_nextLevelCache->access(instrAccess.address, MemoryAccess::Read);
         }
     }
+
+    if (profiling && m_nextLevelCache->getMisses() != misses) {
+        profileMiss();
+    }
+    return latency;
+}
+
+void L1CacheShim::profileMiss() {
+    const auto* proc = ProcessorHandler::getProcessor();
+    if (m_type == CacheType::DataCache) {
+        // Attribute the miss to the instruction performing the data memory access
+        const auto info = proc->stageInfo(proc->dataMemoryStage());
+        if (info.stage_valid) {
+            Profiler::get().recordCacheMiss(info.pc);
+        }
+    } else {
+        Profiler::get().recordCacheMiss(proc->instrMemAccess().address);
+    }
 }
 
 }  // namespace Ripes
@@ -19,13 +19,23 @@ class L1CacheShim : public CacheInterface {
 public:
     enum class CacheType { DataCache, InstrCache };
     L1CacheShim(CacheType type, QObject* parent);
-    void access(AInt address, MemoryAccess::Type type) override;
+    unsigned access(AInt address, MemoryAccess::Type type) override;
 
     void setType(CacheType type);
 
 private:
     void processorReset();
     void processorWasClocked();
+    /**
+     * @brief accessMemory
+     * Propagates the memory access of the current cycle to the cache hierarchy. Returns the latency of the access.
+     */
+    unsigned accessMemory();
+    /**
+     * @brief profileMiss
+     * Attributes a miss of the access of the current cycle to the instruction which performed it.
+     */
+    void profileMiss();
     void processorReversed();
 
     /**
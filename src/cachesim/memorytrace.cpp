@@ -0,0 +1,189 @@
+#include "memorytrace.h"
+
+#include <QFile>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+
+#include "processorhandler.h"
+
+namespace Ripes {
+
+namespace {
+
+constexpr uint32_t s_traceMagic = 0x52544d52;  // "RMTR"
+constexpr uint32_t s_traceVersion = 1;
+// Trace data is read and written in chunks, since QDataStream sizes are ints.
+constexpr size_t s_traceChunkSize = 1 << 24;
+// A zigzag encoded 64-bit delta takes up at most 1 + ceil(59 / 7) bytes.
+constexpr unsigned s_maxEntryBytes = 10;
+
+}  // namespace
+
+void MemoryTrace::append(const Entry& entry) {
+    const unsigned stream = static_cast<unsigned>(entry.stream);
+    const int64_t delta = static_cast<int64_t>(entry.address - m_prevAddress[stream]);
+    m_prevAddress[stream] = entry.address;
+    // Zigzag encoding keeps small negative deltas small
+    uint64_t value = (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+
+    // The first byte holds the access type and stream alongside 5 bits of the delta, followed by 7 bits of the delta
+    // per byte.
+    uint8_t first = (entry.type == MemoryAccess::Write ? 0b1 : 0b0) | (stream << 1) | ((value & 0x1F) << 2);
+    value >>= 5;
+    if (value != 0) {
+        first |= 0x80;
+    }
+    m_data.push_back(first);
+    while (value != 0) {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        if (value != 0) {
+            byte |= 0x80;
+        }
+        m_data.push_back(byte);
+    }
+    m_size++;
+}
+
+void MemoryTrace::clear() {
+    m_data.clear();
+    m_size = 0;
+    m_prevAddress[0] = m_prevAddress[1] = 0;
+}
+
+std::optional<QString> MemoryTrace::save(const QString& path) const {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return "Could not open file " + path + " for writing";
+    }
+    QDataStream out(&file);
+    out << s_traceMagic << s_traceVersion << static_cast<quint64>(m_size) << static_cast<quint64>(m_data.size());
+    for (size_t pos = 0; pos < m_data.size(); pos += s_traceChunkSize) {
+        const size_t chunk = std::min(s_traceChunkSize, m_data.size() - pos);
+        out.writeRawData(reinterpret_cast<const char*>(m_data.data() + pos), static_cast<int>(chunk));
+    }
+    if (out.status() != QDataStream::Ok) {
+        return "Could not write memory trace to " + path;
+    }
+    return {};
+}
+
+std::optional<QString> MemoryTrace::load(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return "Could not open file " + path;
+    }
+    QDataStream in(&file);
+    uint32_t magic, version;
+    quint64 entries, bytes;
+    in >> magic >> version >> entries >> bytes;
+    if (in.status() != QDataStream::Ok || magic != s_traceMagic || version != s_traceVersion) {
+        return path + " is not a memory trace of a supported version";
+    }
+
+    // The byte count is validated against the file before allocating memory for the trace.
+    if (bytes > static_cast<quint64>(file.size() - file.pos())) {
+        return "Memory trace " + path + " is truncated";
+    }
+    std::vector<uint8_t> data(bytes);
+    for (size_t pos = 0; pos < data.size(); pos += s_traceChunkSize) {
+        const int chunk = static_cast<int>(std::min(s_traceChunkSize, data.size() - pos));
+        if (in.readRawData(reinterpret_cast<char*>(data.data() + pos), chunk) != chunk) {
+            return "Memory trace " + path + " is truncated";
+        }
+    }
+
+    // Verify that the trace is well-formed before accepting it; decoding assumes so.
+    size_t count = 0;
+    unsigned entryBytes = 0;
+    bool continued = false;
+    for (const uint8_t byte : data) {
+        count += continued ? 0 : 1;
+        entryBytes = continued ? entryBytes + 1 : 1;
+        continued = byte & 0x80;
+        if (entryBytes > s_maxEntryBytes) {
+            break;
+        }
+    }
+    if (continued || entryBytes > s_maxEntryBytes || count != entries) {
+        return "Memory trace " + path + " is corrupt";
+    }
+
+    m_data = std::move(data);
+    m_size = count;
+    m_prevAddress[0] = m_prevAddress[1] = 0;
+    forEach([&](const Entry& entry) { m_prevAddress[static_cast<unsigned>(entry.stream)] = entry.address; });
+    return {};
+}
+
+MemoryTraceRecorder::MemoryTraceRecorder(QObject* parent) : QObject(parent) {
+    connect(ProcessorHandler::get(), &ProcessorHandler::processorReset, this, &MemoryTraceRecorder::processorReset);
+    // Accesses are recorded in lockstep with the processor, see L1CacheShim.
+    connect(ProcessorHandler::get(), &ProcessorHandler::processorClocked, this, &MemoryTraceRecorder::recordAccesses,
+            Qt::DirectConnection);
+    processorReset();
+}
+
+void MemoryTraceRecorder::processorReset() {
+    m_trace.clear();
+    // The accesses of the initial cycle are performed upon reset.
+    recordAccesses();
+}
+
+void MemoryTraceRecorder::recordAccesses() {
+    const auto* proc = ProcessorHandler::getProcessor();
+    if (proc->isStalledForMemory() || ProcessorHandler::isRewinding()) {
+        // Accesses of a stalled processor were recorded in the cycle which caused the stall, and accesses of cycles
+        // re-executed when rewinding were recorded as they were first executed.
+        return;
+    }
+
+    const auto instrAccess = proc->instrMemAccess();
+    if (instrAccess.type == MemoryAccess::Read) {
+        m_trace.append({instrAccess.address, MemoryAccess::Read, MemoryTrace::Stream::Instruction});
+    }
+    const auto dataAccess = proc->dataMemAccess();
+    if (dataAccess.type == MemoryAccess::Read || dataAccess.type == MemoryAccess::Write) {
+        m_trace.append({dataAccess.address, dataAccess.type, MemoryTrace::Stream::Data});
+    }
+}
+
+std::vector<CacheReplayResult> replayMemoryTrace(const MemoryTrace& trace, const std::vector<CachePreset>& presets) {
+    std::vector<CacheReplayResult> results(presets.size());
+    for (size_t i = 0; i < presets.size(); i++) {
+        results[i].preset = presets[i];
+    }
+
+    // Each configuration is replayed as a separate task on the global thread pool.
+    std::vector<QFuture<void>> futures;
+    for (auto& result : results) {
+        futures.push_back(QtConcurrent::run([&trace, &result] {
+            CacheSim instrCache(nullptr);
+            CacheSim dataCache(nullptr);
+            for (auto* cache : {&instrCache, &dataCache}) {
+                cache->setOffline(true);
+                cache->setPreset(result.preset);
+            }
+
+            trace.forEach([&](const MemoryTrace::Entry& entry) {
+                auto& cache = entry.stream == MemoryTrace::Stream::Instruction ? instrCache : dataCache;
+                cache.access(entry.address, entry.type);
+            });
+
+            const auto statistics = [](const CacheSim& cache) {
+                const auto& accessTrace = cache.getAccessTrace();
+                return accessTrace.empty() ? CacheSim::CacheAccessTrace() : accessTrace.rbegin()->second;
+            };
+            result.instr = statistics(instrCache);
+            result.data = statistics(dataCache);
+        }));
+    }
+    for (auto& future : futures) {
+        future.waitForFinished();
+    }
+
+    return results;
+}
+
+}  // namespace Ripes
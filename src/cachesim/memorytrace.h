@@ -0,0 +1,111 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "cachesim.h"
+#include "ripes_types.h"
+
+namespace Ripes {
+
+/**
+ * Memory traces
+ * A memory trace is the stream of instruction- and data memory accesses performed by the processor, as observed by the
+ * L1 caches. Recording the trace once allows for exploring cache configurations without re-simulating the processor;
+ * a trace is replayed through any number of cache configurations in parallel.
+ *
+ * Traces are stored compactly: each access is encoded as the difference to the previous address of the same stream,
+ * which for sequential instruction fetches and strided data accesses fits in a single byte.
+ */
+class MemoryTrace {
+public:
+    enum class Stream : uint8_t { Instruction, Data };
+
+    struct Entry {
+        AInt address;
+        MemoryAccess::Type type;
+        Stream stream;
+    };
+
+    void append(const Entry& entry);
+    void clear();
+    size_t size() const { return m_size; }
+    size_t sizeInBytes() const { return m_data.size(); }
+
+    /**
+     * @brief forEach
+     * Calls @p f with each entry of the trace, in the order that they were recorded.
+     */
+    template <typename F>
+    void forEach(F&& f) const {
+        AInt prevAddress[2] = {0, 0};
+        size_t pos = 0;
+        while (pos < m_data.size()) {
+            const uint8_t first = m_data[pos++];
+            uint64_t value = (first >> 2) & 0x1F;
+            unsigned shift = 5;
+            for (bool more = first & 0x80; more; shift += 7) {
+                const uint8_t byte = m_data[pos++];
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                more = byte & 0x80;
+            }
+            const unsigned stream = (first >> 1) & 0b1;
+            // Zigzag decoding of the address delta
+            prevAddress[stream] += static_cast<AInt>((value >> 1) ^ (~(value & 1) + 1));
+            f(Entry{prevAddress[stream], first & 0b1 ? MemoryAccess::Write : MemoryAccess::Read,
+                    static_cast<Stream>(stream)});
+        }
+    }
+
+    /**
+     * @brief save/load
+     * Saves or loads the trace to/from @p path.
+     * @returns an error message if the trace could not be saved or loaded.
+     */
+    std::optional<QString> save(const QString& path) const;
+    std::optional<QString> load(const QString& path);
+
+private:
+    std::vector<uint8_t> m_data;
+    size_t m_size = 0;
+    AInt m_prevAddress[2] = {0, 0};
+};
+
+/**
+ * @brief The MemoryTraceRecorder class
+ * Records the memory accesses of the current processor into a memory trace. The recording restarts whenever the
+ * processor is reset. Reversing the processor is not supported; reversed cycles remain in the trace. Cycles which are
+ * re-executed when rewinding are not recorded again.
+ */
+class MemoryTraceRecorder : public QObject {
+    Q_OBJECT
+public:
+    MemoryTraceRecorder(QObject* parent);
+    const MemoryTrace& trace() const { return m_trace; }
+
+private:
+    void processorReset();
+    void recordAccesses();
+
+    MemoryTrace m_trace;
+};
+
+struct CacheReplayResult {
+    CachePreset preset;
+    // Access statistics of the L1 instruction- and data cache, both configured by the preset.
+    CacheSim::CacheAccessTrace instr;
+    CacheSim::CacheAccessTrace data;
+};
+
+/**
+ * @brief replayMemoryTrace
+ * Replays @p trace through a pair of L1 instruction- and data caches for each of @p presets. The configurations are
+ * simulated concurrently on the global thread pool. Results are returned in the order of @p presets.
+ */
+std::vector<CacheReplayResult> replayMemoryTrace(const MemoryTrace& trace, const std::vector<CachePreset>& presets);
+
+}  // namespace Ripes
@@ -0,0 +1,99 @@
+#include "stackdistance.h"
+
+#include <QStringList>
+
+#include <algorithm>
+
+namespace Ripes {
+
+StackDistanceAnalyzer::StackDistanceAnalyzer(unsigned blockBits, unsigned maxLineBits, unsigned maxWayBits)
+    : m_blockBits(blockBits), m_maxLineBits(maxLineBits), m_maxWayBits(maxWayBits), m_ways(1u << maxWayBits) {
+    reset();
+}
+
+void StackDistanceAnalyzer::setBlockBits(unsigned blockBits) {
+    m_blockBits = blockBits;
+    reset();
+}
+
+void StackDistanceAnalyzer::reset() {
+    m_accesses = 0;
+    m_levels.resize(m_maxLineBits + 1);
+    for (unsigned lineBits = 0; lineBits <= m_maxLineBits; lineBits++) {
+        auto& level = m_levels[lineBits];
+        const size_t sets = size_t(1) << lineBits;
+        level.stacks.assign(sets * m_ways, 0);
+        level.depths.assign(sets, 0);
+        level.histogram.assign(m_ways, 0);
+    }
+}
+
+void StackDistanceAnalyzer::access(AInt address) {
+    const AInt block = address >> (2 /*byte offset*/ + m_blockBits);
+    m_accesses++;
+
+    for (unsigned lineBits = 0; lineBits <= m_maxLineBits; lineBits++) {
+        auto& level = m_levels[lineBits];
+        const size_t set = block & ((AInt(1) << lineBits) - 1);
+        AInt* stack = &level.stacks[set * m_ways];
+        auto& depth = level.depths[set];
+
+        unsigned distance = 0;
+        while (distance < depth && stack[distance] != block) {
+            distance++;
+        }
+        if (distance < depth) {
+            level.histogram[distance]++;
+        } else if (depth < m_ways) {
+            // Cold miss; the stack grows. Otherwise, the least recently used block falls off the end of the stack.
+            distance = depth++;
+        } else {
+            distance = m_ways - 1;
+        }
+
+        // Move the block to the top of the stack
+        std::copy_backward(stack, stack + distance, stack + distance + 1);
+        stack[0] = block;
+    }
+}
+
+uint64_t StackDistanceAnalyzer::getHits(unsigned lineBits, unsigned wayBits) const {
+    if (lineBits > m_maxLineBits || wayBits > m_maxWayBits) {
+        return 0;
+    }
+    const auto& histogram = m_levels[lineBits].histogram;
+    uint64_t hits = 0;
+    for (unsigned distance = 0; distance < (1u << wayBits); distance++) {
+        hits += histogram[distance];
+    }
+    return hits;
+}
+
+double StackDistanceAnalyzer::getMissRate(unsigned lineBits, unsigned wayBits) const {
+    if (m_accesses == 0) {
+        return 0;
+    }
+    return static_cast<double>(m_accesses - getHits(lineBits, wayBits)) / m_accesses;
+}
+
+QString StackDistanceAnalyzer::csv() const {
+    QStringList rows;
+    rows << "lines,ways,blocks,size (words),accesses,hits,misses,miss rate";
+    for (unsigned lineBits = 0; lineBits <= m_maxLineBits; lineBits++) {
+        for (unsigned wayBits = 0; wayBits <= m_maxWayBits; wayBits++) {
+            const uint64_t hits = getHits(lineBits, wayBits);
+            rows << QStringList{QString::number(1u << lineBits),
+                                QString::number(1u << wayBits),
+                                QString::number(1u << m_blockBits),
+                                QString::number(1ull << (lineBits + wayBits + m_blockBits)),
+                                QString::number(m_accesses),
+                                QString::number(hits),
+                                QString::number(m_accesses - hits),
+                                QString::number(getMissRate(lineBits, wayBits), 'f', 4)}
+                        .join(',');
+        }
+    }
+    return rows.join('\n') + '\n';
+}
+
+}  // namespace Ripes
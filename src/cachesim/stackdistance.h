@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QString>
+
+#include <cstdint>
+#include <vector>
+
+#include "ripes_types.h"
+
+namespace Ripes {
+
+/**
+ * @brief The StackDistanceAnalyzer class
+ * Single-pass LRU stack distance (Mattson) analysis of a memory access stream. For every number of cache lines, the
+ * analyzer maintains an LRU stack for each set. An access which is found at depth d of its stack hits in any LRU cache
+ * with the same number of lines and more than d ways. Thus, a single pass over the stream yields the hit count of every
+ * power-of-two combination of lines and ways, for a fixed block size.
+ *
+ * The analysis models write-allocating caches; writes are treated as any other access.
+ */
+class StackDistanceAnalyzer {
+public:
+    static constexpr unsigned s_maxLineBits = 10;
+    static constexpr unsigned s_maxWayBits = 4;
+
+    StackDistanceAnalyzer(unsigned blockBits = 0, unsigned maxLineBits = s_maxLineBits,
+                          unsigned maxWayBits = s_maxWayBits);
+
+    void access(AInt address);
+    void reset();
+
+    /**
+     * @brief setBlockBits
+     * Sets log2 of the number of words per block, resetting the analysis.
+     */
+    void setBlockBits(unsigned blockBits);
+
+    unsigned getBlockBits() const { return m_blockBits; }
+    unsigned getMaxLineBits() const { return m_maxLineBits; }
+    unsigned getMaxWayBits() const { return m_maxWayBits; }
+    uint64_t getAccesses() const { return m_accesses; }
+
+    /**
+     * @brief getHits
+     * @returns the number of accesses which would have hit in an LRU cache of 2^@p lineBits lines and 2^@p wayBits
+     * ways.
+     */
+    uint64_t getHits(unsigned lineBits, unsigned wayBits) const;
+    double getMissRate(unsigned lineBits, unsigned wayBits) const;
+
+    /**
+     * @brief csv
+     * @returns the miss rate of every analyzed cache geometry as comma-separated values, including a header row.
+     */
+    QString csv() const;
+
+private:
+    struct Level {
+        // LRU stacks of all sets, each of m_ways entries with the most recently used block first.
+        std::vector<AInt> stacks;
+        std::vector<uint8_t> depths;
+        // Number of accesses found at each stack depth
+        std::vector<uint64_t> histogram;
+    };
+
+    unsigned m_blockBits;
+    unsigned m_maxLineBits;
+    unsigned m_maxWayBits;
+    unsigned m_ways;
+    uint64_t m_accesses = 0;
+    std::vector<Level> m_levels;
+};
+
+}  // namespace Ripes
@@ -5,6 +5,7 @@
 #include "memoryviewerwidget.h"
 #include "ripessettings.h"
 
+#include <QLabel>
 #include <QTabBar>
 #include <QWheelEvent>
 
@@ -67,10 +68,39 @@ CacheTabWidget::CacheTabWidget(QWidget* parent) : QWidget(parent), m_ui(new Ui::
     m_ui->tabWidget->tabBar()->installEventFilter(new ScrollEventFilter(this));
 }
 
+CacheWidget* CacheTabWidget::cacheWidgetAt(int index) const {
+    auto* widget = m_ui->tabWidget->widget(index);
+    if (!widget) {
+        return nullptr;
+    }
+    if (auto* cw = dynamic_cast<CacheWidget*>(widget)) {
+        return cw;
+    }
+    for (const auto& ch : widget->children()) {
+        if (auto* cw = dynamic_cast<CacheWidget*>(ch)) {
+            return cw;
+        }
+    }
+    return nullptr;
+}
+
+void CacheTabWidget::setNextLevelCache(int index, const std::shared_ptr<CacheSim>& cache) {
+    if (index <= InstrCache) {
+        m_ui->dataCacheWidget->setNextLevelCache(cache);
+        m_ui->instructionCacheWidget->setNextLevelCache(cache);
+    } else {
+        cacheWidgetAt(index)->setNextLevelCache(cache);
+    }
+
+    // Restart the simulation with the modified cache hierarchy
+    RipesSettings::getObserver(RIPES_GLOBALSIGNAL_REQRESET)->trigger();
+}
+
 void CacheTabWidget::handleTabCloseRequest(int index) {
     // Only the last-level cache should be closeable
     Q_ASSERT(index == m_addTabIdx - 1 && index > InstrCache);
     const int newIndex = index - 1;
+    setNextLevelCache(newIndex, nullptr);
     m_ui->tabWidget->setCurrentIndex(newIndex);
     m_ui->tabWidget->removeTab(index);
     m_addTabIdx = m_ui->tabWidget->count() - 1;
@@ -87,6 +117,7 @@ void CacheTabWidget::handleTabIndexChanged(int index) {
         auto* cw = new CacheWidget(this);
         m_ui->tabWidget->insertTab(m_addTabIdx, cw, QString("L%1 Cache").arg(m_nextCacheLevel));
         m_nextCacheLevel++;
+        setNextLevelCache(m_addTabIdx - 1, cw->getCacheSim());
 
         // The new cache is the deleteable cache, the one below it is thus no longer deleteable
         m_ui->tabWidget->tabBar()->tabButton(m_addTabIdx, QTabBar::RightSide)->resize(m_defaultTabButtonSize);
@@ -96,12 +127,8 @@ void CacheTabWidget::handleTabIndexChanged(int index) {
     }
 
     // Locate cacheWidget for the current index
-    for (const auto& ch : m_ui->tabWidget->widget(index)->children()) {
-        auto* cw = dynamic_cast<CacheWidget*>(ch);
-        if (cw) {
-            emit cacheFocusChanged(cw);
-            break;
-        }
+    if (auto* cw = cacheWidgetAt(index)) {
+        emit cacheFocusChanged(cw);
     }
 }
 
@@ -3,7 +3,7 @@
 
 #include "cachesim/l1cacheshim.h"
 
-// #define N_CACHES_ENABLED
+#define N_CACHES_ENABLED
 
 namespace Ripes {
 class CacheWidget;
@@ -33,6 +33,14 @@ signals:
 private:
     enum FixedCacheIdx { DataCache, InstrCache };
     void connectCacheWidget(CacheWidget* w);
+    CacheWidget* cacheWidgetAt(int index) const;
+
+    /**
+     * @brief setNextLevelCache
+     * Sets the next level cache of the last-level cache(s) at tab @p index. The L1 data and instruction caches share
+     * their next level cache.
+     */
+    void setNextLevelCache(int index, const std::shared_ptr<CacheSim>& cache);
     void handleTabIndexChanged(int index);
     void handleTabCloseRequest(int index);
 
@@ -0,0 +1,272 @@
+#include "checkpoint.h"
+
+#include <QCryptographicHash>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "cachesim/cachesim.h"
+#include "io/iomanager.h"
+#include "processorhandler.h"
+#include "ripessettings.h"
+#include "syscall/systemio.h"
+
+#include "cereal/archives/portable_binary.hpp"
+#include "cereal/types/map.hpp"
+#include "cereal/types/set.hpp"
+#include "cereal/types/string.hpp"
+#include "cereal/types/vector.hpp"
+
+namespace Ripes {
+
+namespace {
+
+constexpr uint32_t s_checkpointMagic = 0x504b4352;  // "RCKP"
+constexpr uint32_t s_checkpointVersion = 4;
+
+std::string programHash(const Program& program) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const auto& section : program.sections) {
+        hash.addData(section.first.toUtf8());
+        hash.addData(QByteArray::number(static_cast<qulonglong>(section.second.address)));
+        hash.addData(section.second.data);
+    }
+    return hash.result().toHex().toStdString();
+}
+
+/**
+ * @brief resumeAddress
+ * The oldest instruction in flight is the instruction in the last valid stage of the processor. Instructions in flight
+ * have not yet written the register file. A store in flight may already have written memory, but re-executing it
+ * writes the same value, given that its operands were produced by instructions which have retired. System calls are
+ * not idempotent in this way, and checkpoints are not captured while an executed system call is in flight; see
+ * executedEcallInFlight.
+ */
+AInt resumeAddress(const RipesProcessor& proc) {
+    for (int stage = static_cast<int>(proc.stageCount()) - 1; stage >= 0; stage--) {
+        const auto info = proc.stageInfo(stage);
+        if (info.stage_valid) {
+            return info.pc;
+        }
+    }
+    return proc.nextFetchedAddress();
+}
+
+// Encoding of the ecall instruction
+constexpr VInt s_ecallInstr = 0x00000073;
+
+bool isIOPage(AInt page) {
+    for (const auto& entry : IOManager::get().memoryMap()) {
+        if (entry.second.startAddr < page + ProcessorHandler::s_memoryPageSize && page < entry.second.end()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<uint8_t> readPage(AInt page) {
+    std::vector<uint8_t> data(ProcessorHandler::s_memoryPageSize);
+    auto& mem = ProcessorHandler::getMemory();
+    for (AInt offset = 0; offset < ProcessorHandler::s_memoryPageSize; offset += sizeof(VInt)) {
+        VInt value = mem.readMemConst(page + offset, sizeof(VInt));
+        for (unsigned i = 0; i < sizeof(VInt); i++) {
+            data[offset + i] = value & 0xFF;
+            value >>= CHAR_BIT;
+        }
+    }
+    return data;
+}
+
+void writePage(AInt page, const std::vector<uint8_t>& data) {
+    for (AInt offset = 0; offset < data.size(); offset += sizeof(VInt)) {
+        VInt value = 0;
+        for (int i = sizeof(VInt) - 1; i >= 0; i--) {
+            value = (value << CHAR_BIT) | data[offset + i];
+        }
+        ProcessorHandler::writeMem(page + offset, value, sizeof(VInt));
+    }
+}
+
+unsigned registerBytes(const RegDesc& reg) {
+    return std::min<unsigned>((reg.bitWidth + CHAR_BIT - 1) / CHAR_BIT, sizeof(uint32_t));
+}
+
+PeripheralState capturePeripheral(IOBase& peripheral) {
+    PeripheralState state;
+    std::ostringstream out;
+    {
+        cereal::PortableBinaryOutputArchive archive(out);
+        archive(peripheral);
+    }
+    state.parameters = out.str();
+    for (const auto& reg : peripheral.registers()) {
+        if (reg.rw == RegDesc::RW::RW) {
+            state.registers[reg.address] = peripheral.ioRead(reg.address, registerBytes(reg));
+        }
+    }
+    return state;
+}
+
+void restorePeripheral(IOBase& peripheral, const PeripheralState& state) {
+    std::istringstream in(state.parameters);
+    {
+        cereal::PortableBinaryInputArchive archive(in);
+        archive(peripheral);
+    }
+    // The register map may have changed with the restored parameters.
+    for (const auto& reg : peripheral.registers()) {
+        auto it = state.registers.find(reg.address);
+        if (reg.rw == RegDesc::RW::RW && it != state.registers.end()) {
+            peripheral.ioWrite(reg.address, it->second, registerBytes(reg));
+        }
+    }
+}
+
+}  // namespace
+
+bool executedEcallInFlight() {
+    const auto* proc = ProcessorHandler::getProcessor();
+    const auto ecallStage = proc->ecallStage();
+    if (!ecallStage) {
+        return false;
+    }
+    for (unsigned stage = *ecallStage; stage < proc->stageCount(); stage++) {
+        const auto info = proc->stageInfo(stage);
+        if (info.stage_valid && ProcessorHandler::getMemory().readMemConst(info.pc, 4) == s_ecallInstr) {
+            return true;
+        }
+    }
+    return false;
+}
+
+Checkpoint captureCheckpoint(const CheckpointCaches& caches, bool includeStdin) {
+    const auto* proc = ProcessorHandler::getProcessor();
+
+    Checkpoint cp;
+    cp.isa = ProcessorHandler::currentISA()->name().toStdString();
+    cp.pc = resumeAddress(*proc);
+    cp.cycleCount = proc->getCycleCount();
+    cp.instructionsRetired = proc->getInstructionsRetired();
+    for (unsigned i = 0; i < ProcessorHandler::currentISA()->regCnt(); i++) {
+        cp.registers.push_back(proc->getRegister(RegisterFileType::GPR, i));
+    }
+    for (const auto& page : ProcessorHandler::getWrittenPages()) {
+        // Memory-mapped peripherals are captured through their own state.
+        if (!isIOPage(page)) {
+            cp.memory[page] = readPage(page);
+        }
+    }
+    for (const auto& cache : caches) {
+        cp.caches[cache.first.toStdString()] = cache.second->getState();
+    }
+    cp.systemIO = SystemIO::getState(includeStdin);
+    for (auto* peripheral : IOManager::get().peripherals()) {
+        cp.peripherals[peripheral->serializedUniqueID()] = capturePeripheral(*peripheral);
+    }
+    return cp;
+}
+
+void applyCheckpoint(const Checkpoint& cp, const CheckpointCaches& caches, QStringList& warnings) {
+    for (const auto& page : cp.memory) {
+        writePage(page.first, page.second);
+    }
+    // Register 0 is hardwired
+    for (unsigned i = 1; i < cp.registers.size(); i++) {
+        ProcessorHandler::setRegisterValue(RegisterFileType::GPR, i, cp.registers.at(i));
+    }
+    auto* proc = ProcessorHandler::getProcessorNonConst();
+    proc->setProgramCounter(cp.pc);
+    proc->restoreCounters(cp.cycleCount, cp.instructionsRetired);
+
+    for (const auto& cache : caches) {
+        auto it = cp.caches.find(cache.first.toStdString());
+        if (it == cp.caches.end()) {
+            warnings << "Checkpoint contains no state for cache '" + cache.first + "'";
+        } else if (!cache.second->setState(it->second)) {
+            warnings << "Cache '" + cache.first + "' has a different configuration than when the checkpoint was saved";
+        }
+    }
+
+    for (auto* peripheral : IOManager::get().peripherals()) {
+        auto it = cp.peripherals.find(peripheral->serializedUniqueID());
+        if (it == cp.peripherals.end()) {
+            warnings << "Checkpoint contains no state for peripheral '" + peripheral->name() + "'";
+            continue;
+        }
+        try {
+            restorePeripheral(*peripheral, it->second);
+        } catch (const cereal::Exception& e) {
+            warnings << "Could not restore peripheral '" + peripheral->name() + "': " + e.what();
+        }
+    }
+}
+
+std::optional<QString> saveCheckpoint(const QString& path, const CheckpointCaches& caches) {
+    const auto program = ProcessorHandler::getProgram();
+    if (!program) {
+        return QString("No program is loaded");
+    }
+
+    if (executedEcallInFlight()) {
+        return QString("A system call is being executed; clock the processor until it has retired before saving a "
+                       "checkpoint");
+    }
+
+    Checkpoint cp = captureCheckpoint(caches);
+    cp.programHash = programHash(*program);
+
+    std::ofstream out(path.toStdString(), std::ios::binary);
+    if (!out) {
+        return "Could not open file " + path + " for writing";
+    }
+    try {
+        cereal::PortableBinaryOutputArchive archive(out);
+        archive(s_checkpointMagic, s_checkpointVersion, cp);
+    } catch (const cereal::Exception& e) {
+        return "Could not save checkpoint: " + QString(e.what());
+    }
+    return {};
+}
+
+std::optional<QString> restoreCheckpoint(const QString& path, const CheckpointCaches& caches, QStringList& warnings) {
+    std::ifstream in(path.toStdString(), std::ios::binary);
+    if (!in) {
+        return "Could not open file " + path;
+    }
+
+    Checkpoint cp;
+    try {
+        cereal::PortableBinaryInputArchive archive(in);
+        uint32_t magic, version;
+        archive(magic, version);
+        if (magic != s_checkpointMagic || version != s_checkpointVersion) {
+            return path + " is not a checkpoint of a supported version";
+        }
+        archive(cp);
+    } catch (const cereal::Exception& e) {
+        return "Could not read checkpoint: " + QString(e.what());
+    }
+
+    const auto program = ProcessorHandler::getProgram();
+    if (ProcessorHandler::currentISA()->name().toStdString() != cp.isa) {
+        return "Checkpoint was saved from a processor implementing " + QString::fromStdString(cp.isa) +
+               ", but the current processor implements " + ProcessorHandler::currentISA()->name();
+    }
+    if (!program || programHash(*program) != cp.programHash) {
+        return QString("Checkpoint was saved from a different program than the currently loaded program");
+    }
+
+    // Reset the processor (and everything observing processor resets, ie. caches) to the initial state of the program,
+    // and apply the checkpoint on top of that.
+    RipesSettings::getObserver(RIPES_GLOBALSIGNAL_REQRESET)->trigger();
+
+    applyCheckpoint(cp, caches, warnings);
+    if (auto err = SystemIO::setState(cp.systemIO)) {
+        warnings << *err;
+    }
+
+    return {};
+}
+
+}  // namespace Ripes
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+#include <map>
+#include <memory>
+#include <optional>
+
+#include "cachesim/cachesim.h"
+#include "syscall/systemio.h"
+
+namespace Ripes {
+
+/**
+ * Simulator checkpoints
+ * A checkpoint captures the state of the simulated system: the register file, program counter and counters of the
+ * processor, the contents of memory, the state of caches, the files opened by the simulated program and the state of
+ * the instantiated peripherals.
+ *
+ * Only architectural state is captured; the contents of pipeline registers are not. A restored processor starts out
+ * with an empty pipeline, executing from the oldest instruction which was in flight when the checkpoint was saved.
+ * Consequently, a checkpoint may be restored onto any processor model implementing the same ISA, e.g. by
+ * fast-forwarding a program on the instruction-set simulator, and restoring the checkpoint onto a pipelined model.
+ *
+ * Caches are identified by name. A cache is only restored if its configuration matches that of the cache which the
+ * checkpoint was saved from, and otherwise starts out cold.
+ */
+using CheckpointCaches = std::map<QString, std::shared_ptr<CacheSim>>;
+
+struct PeripheralState {
+    // IOBase::serialize'd parameters of the peripheral.
+    std::string parameters;
+    // Values of the readable and writeable registers of the peripheral, indexed by register address.
+    std::map<AInt, VInt> registers;
+
+    template <class Archive>
+    void serialize(Archive& archive) {
+        archive(parameters, registers);
+    }
+};
+
+struct Checkpoint {
+    std::string isa;
+    std::string programHash;
+    AInt pc;
+    long long cycleCount;
+    long long instructionsRetired;
+    std::vector<VInt> registers;
+    // Contents of all pages of memory which were written during simulation, indexed by page address. All other memory
+    // is restored from the initialization memories of the program.
+    std::map<AInt, std::vector<uint8_t>> memory;
+    std::map<std::string, CacheSim::CacheState> caches;
+    SystemIO::State systemIO;
+    std::map<std::string, PeripheralState> peripherals;
+
+    template <class Archive>
+    void serialize(Archive& archive) {
+        archive(isa, programHash, pc, cycleCount, instructionsRetired, registers, memory, caches, systemIO,
+                peripherals);
+    }
+};
+
+/**
+ * @brief executedEcallInFlight
+ * @returns whether a system call instruction which has already been executed is in flight in the pipeline of the
+ * current processor. A checkpoint captured in this state would execute the system call again once restored.
+ */
+bool executedEcallInFlight();
+
+/**
+ * @brief captureCheckpoint
+ * Captures a checkpoint of the current processor and @p caches. The program hash is left empty. Unconsumed stdin data
+ * is only captured if @p includeStdin is set.
+ */
+Checkpoint captureCheckpoint(const CheckpointCaches& caches = {}, bool includeStdin = true);
+
+/**
+ * @brief applyCheckpoint
+ * Applies @p checkpoint onto the current processor and @p caches, which must have just been reset to the initial state
+ * of the program. The state of SystemIO is left to the caller. Non-fatal issues are appended to @p warnings.
+ */
+void applyCheckpoint(const Checkpoint& checkpoint, const CheckpointCaches& caches, QStringList& warnings);
+
+/**
+ * @brief saveCheckpoint
+ * Saves a checkpoint of the current processor, program and @p caches to @p path. Checkpoints cannot be saved while
+ * executedEcallInFlight().
+ * @returns an error message if the checkpoint could not be saved.
+ */
+std::optional<QString> saveCheckpoint(const QString& path, const CheckpointCaches& caches = {});
+
+/**
+ * @brief restoreCheckpoint
+ * Restores the checkpoint at @p path onto the current processor and @p caches. The program which the checkpoint was
+ * saved from must already be loaded. Non-fatal issues, such as a cache which could not be restored, are appended to
+ * @p warnings.
+ * @returns an error message if the checkpoint could not be restored.
+ */
+std::optional<QString> restoreCheckpoint(const QString& path, const CheckpointCaches& caches, QStringList& warnings);
+
+}  // namespace Ripes
@@ -15,7 +15,13 @@ Console::Console(QWidget* parent) : QPlainTextEdit(parent) {
     }
     setFont(m_font);
 
-    document()->setMaximumBlockCount(100);
+    document()->setMaximumBlockCount(s_maxLines);
+
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(1000 / RipesSettings::value(RIPES_SETTING_UIUPDATEPS).toUInt());
+    connect(RipesSettings::getObserver(RIPES_SETTING_UIUPDATEPS), &SettingObserver::modified, this,
+            [=] { m_flushTimer.setInterval(1000 / RipesSettings::value(RIPES_SETTING_UIUPDATEPS).toUInt()); });
+    connect(&m_flushTimer, &QTimer::timeout, this, &Console::flush);
 
     auto paletteChangeFunctor = [=] {
         QPalette p = palette();
@@ -41,19 +47,75 @@ Console::Console(QWidget* parent) : QPlainTextEdit(parent) {
 }
 
 void Console::putData(const QByteArray& bytes) {
+    // Preserve ordering with respect to buffered output
+    flush();
+    insertText(QString::fromUtf8(bytes));
+}
+
+void Console::insertText(const QString& text) {
     // Text can always only be inserted at the end of the console
     auto cursorAtEnd = QTextCursor(document());
     cursorAtEnd.movePosition(QTextCursor::End);
     setTextCursor(cursorAtEnd);
-    insertPlainText(bytes);
+    insertPlainText(text);
 
     QScrollBar* bar = verticalScrollBar();
     bar->setValue(bar->maximum());
 }
 
+void Console::print(const QString& text) {
+    bool wasEmpty;
+    {
+        QMutexLocker lock(&m_outputMutex);
+        wasEmpty = m_output.isEmpty();
+        m_output += text;
+        if (m_output.size() > s_maxBufferedOutput) {
+            // Only the most recent lines are retained by the console; drop the oldest half of the buffer.
+            const int keep = s_maxBufferedOutput / 2;
+            const int lineStart = m_output.indexOf('\n', m_output.size() - keep);
+            m_output.remove(0, lineStart < 0 ? m_output.size() - keep : lineStart + 1);
+        }
+    }
+
+    if (wasEmpty) {
+        // Output is inserted on the GUI thread; one flush is scheduled per batch of output rather than per call.
+        QMetaObject::invokeMethod(
+            this,
+            [=] {
+                if (!m_flushTimer.isActive()) {
+                    m_flushTimer.start();
+                }
+            },
+            Qt::QueuedConnection);
+    }
+}
+
+void Console::flush() {
+    QString output;
+    {
+        QMutexLocker lock(&m_outputMutex);
+        output.swap(m_output);
+    }
+    if (output.isEmpty()) {
+        return;
+    }
+
+    // Lines beyond the maximum line count would be removed from the console right away; don't insert them.
+    int lineStart = output.size();
+    for (int lines = 0; lines < s_maxLines && lineStart > 0; lines++) {
+        lineStart = output.lastIndexOf('\n', lineStart - 1);
+    }
+    if (lineStart > 0) {
+        output.remove(0, lineStart + 1);
+    }
+    insertText(output);
+}
+
 void Console::clearConsole() {
     clear();
     m_buffer.clear();
+    QMutexLocker lock(&m_outputMutex);
+    m_output.clear();
 }
 
 void Console::backspace() {
@@ -100,7 +162,8 @@ void Console::keyPressEvent(QKeyEvent* e) {
                             backspace();
                         }
                     } else {
-                        putData(text.toUtf8());
+                        flush();
+                        insertText(text);
                     }
                 }
             }
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <QFont>
+#include <QMutex>
 #include <QPlainTextEdit>
+#include <QTimer>
 
 namespace Ripes {
 
@@ -16,15 +18,39 @@ public:
     void putData(const QByteArray& data);
     void clearConsole();
 
+    /**
+     * @brief print
+     * Appends @p text to the console. May be called from any thread. Text is buffered, and inserted into the console at
+     * most RIPES_SETTING_UIUPDATEPS times per second.
+     */
+    void print(const QString& text);
+
+    /**
+     * @brief flush
+     * Inserts any buffered text into the console.
+     */
+    void flush();
+
+    // Maximum number of lines retained in the console
+    static constexpr int s_maxLines = 100;
+
 protected:
     void keyPressEvent(QKeyEvent* e) override;
 
 private:
     void backspace();
+    void insertText(const QString& text);
 
     bool m_localEchoEnabled = false;
     QFont m_font;
     QString m_buffer;
+
+    QMutex m_outputMutex;
+    QString m_output;
+    QTimer m_flushTimer;
+
+    // Maximum number of buffered characters; older output is discarded if the console cannot keep up.
+    static constexpr int s_maxBufferedOutput = 1 << 20;
 };
 
 }  // namespace Ripes
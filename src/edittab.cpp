@@ -1,8 +1,6 @@
 #include "edittab.h"
 #include "ui_edittab.h"
 
-#include "elfio/elfio.hpp"
-
 #include <QCheckBox>
 #include <QLabel>
 #include <QLineEdit>
@@ -16,6 +14,7 @@
 #include "editor/codeeditor.h"
 #include "io/iomanager.h"
 #include "processorhandler.h"
+#include "programutilities.h"
 #include "ripessettings.h"
 #include "symbolnavigator.h"
 
@@ -112,7 +111,7 @@ EditTab::EditTab(QToolBar* toolbar, QWidget* parent) : RipesTab(toolbar, parent)
 
 void EditTab::showSymbolNavigator() {
     if (auto program = ProcessorHandler::getProgram()) {
-        SymbolNavigator nav(program->symbols, this);
+        SymbolNavigator nav(program->symbolIndex, this);
         if (nav.exec()) {
             m_ui->programViewer->setCenterAddress(nav.getSelectedSymbolAddress());
         }
@@ -240,8 +239,10 @@ void EditTab::sourceCodeChanged() {
 }
 
 void EditTab::assemble() {
-    auto res = ProcessorHandler::getAssembler()->assembleRaw(m_ui->codeEditor->document()->toPlainText(),
-                                                             &IOManager::get().assemblerSymbols());
+    auto assembler = ProcessorHandler::getAssembler();
+    // The program is reassembled on every edit; only re-process the lines which changed since the last assembly.
+    assembler->setIncremental(true);
+    auto res = assembler->assembleRaw(m_ui->codeEditor->document()->toPlainText(), &IOManager::get().assemblerSymbols());
     *m_sourceErrors = res.errors;
     if (m_sourceErrors->size() == 0) {
         ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
@@ -313,13 +314,9 @@ void EditTab::on_disassembledViewButton_toggled() {
 }
 
 bool EditTab::loadFlatBinaryFile(Program& program, QFile& file, unsigned long entryPoint, unsigned long loadAt) {
-    ProgramSection section;
-    section.name = TEXT_SECTION_NAME;
-    section.address = loadAt;
-    section.data = file.readAll();
-
-    program.sections[TEXT_SECTION_NAME] = section;
-    program.entryPoint = entryPoint;
+    if (!Ripes::loadFlatBinaryFile(program, file, entryPoint, loadAt)) {
+        return false;
+    }
 
     m_ui->curInputSrcLabel->setText("Flat binary");
     m_ui->inputSrcPath->setText(file.fileName());
@@ -334,47 +331,10 @@ bool EditTab::loadSourceFile(Program&, QFile& file) {
 }
 
 bool EditTab::loadElfFile(Program& program, QFile& file) {
-    ELFIO::elfio reader;
-
-    // No file validity checking is performed - it is expected that Loaddialog has done all validity
-    // checking.
-    if (!reader.load(file.fileName().toStdString())) {
-        assert(false);
-    }
-
-    for (const auto& elfSection : reader.sections) {
-        // Do not load .debug sections
-        if (!QString::fromStdString(elfSection->get_name()).startsWith(".debug")) {
-            ProgramSection section;
-            section.name = QString::fromStdString(elfSection->get_name());
-            section.address = elfSection->get_address();
-            // QByteArray performs a deep copy of the data when the data array is initialized at construction
-            section.data = QByteArray(elfSection->get_data(), static_cast<int>(elfSection->get_size()));
-            program.sections[section.name] = section;
-        }
-
-        if (elfSection->get_type() == SHT_SYMTAB) {
-            // Collect function symbols
-            const ELFIO::symbol_section_accessor symbols(reader, elfSection);
-            for (unsigned int j = 0; j < symbols.get_symbols_num(); ++j) {
-                std::string name;
-                ELFIO::Elf64_Addr value = 0;
-                ELFIO::Elf_Xword size;
-                unsigned char bind;
-                unsigned char type = STT_NOTYPE;
-                ELFIO::Elf_Half section_index;
-                unsigned char other;
-                symbols.get_symbol(j, name, value, size, bind, type, section_index, other);
-
-                if (type != STT_FUNC)
-                    continue;
-                program.symbols[value] = QString::fromStdString(name);
-            }
-        }
+    if (!Ripes::loadElfFile(program, file)) {
+        return false;
     }
 
-    program.entryPoint = reader.get_entry();
-
     m_ui->curInputSrcLabel->setText("Executable (ELF)");
     m_ui->inputSrcPath->setText(file.fileName());
 
@@ -41,6 +41,20 @@ AInt IOManager::nextPeripheralAddress() const {
     return base;
 }
 
+std::optional<MemoryMapEntry> IOManager::peripheralRegionFrom(AInt address) const {
+    std::optional<MemoryMapEntry> region;
+    for (const auto& periph : m_periphMMappings) {
+        const auto& mapping = periph.second;
+        if (mapping.end() <= address) {
+            continue;
+        }
+        if (!region || mapping.startAddr < region->startAddr) {
+            region = mapping;
+        }
+    }
+    return region;
+}
+
 AInt IOManager::assignBaseAddress(IOBase* peripheral) {
     unregisterPeripheralWithProcessor(peripheral);
     const AInt base = nextPeripheralAddress();
@@ -72,8 +86,9 @@ void IOManager::registerPeripheralWithProcessor(IOBase* peripheral) {
             [peripheral](AInt offset, VInt value, unsigned size) { peripheral->ioWrite(offset, value, size); },
             [peripheral](AInt offset, unsigned size) { return peripheral->ioRead(offset, size); }});
 
+    // Written through the processor handler, such that the write is tracked like any other write to memory.
     peripheral->memWrite = [](AInt address, VInt value, unsigned size) {
-        ProcessorHandler::getMemory().writeMem(address, value, size);
+        ProcessorHandler::writeMem(address, value, size);
     };
     peripheral->memRead = [](AInt address, unsigned size) {
         return ProcessorHandler::getMemory().readMem(address, size);
@@ -134,7 +149,7 @@ void IOManager::refreshMemoryMap() {
     if (program) {
         for (const auto& section : program.get()->sections) {
             m_memoryMap[section.second.address] = MemoryMapEntry{
-                section.second.address, static_cast<unsigned>(section.second.data.size()), section.second.name};
+                section.second.address, static_cast<unsigned>(section.second.size()), section.second.name};
         }
     }
 
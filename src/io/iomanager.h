@@ -6,6 +6,8 @@
 
 #include <QFile>
 
+#include <optional>
+
 namespace Ripes {
 
 struct PeripheralID {
@@ -40,6 +42,14 @@ public:
     IOBase* createPeripheral(IOType type, unsigned forcedId = UINT_MAX);
     void removePeripheral(IOBase* peripheral, std::atomic<bool>& ok);
     const MemoryMap& memoryMap() const { return m_memoryMap; }
+    const std::set<IOBase*>& peripherals() const { return m_peripherals; }
+
+    /**
+     * @brief peripheralRegionFrom
+     * @returns the memory mapping of the peripheral containing @p address, or otherwise of the first peripheral mapped
+     * above @p address, if any.
+     */
+    std::optional<MemoryMapEntry> peripheralRegionFrom(AInt address) const;
 
     /**
      * @brief cSymbolsHeaderpath
@@ -8,6 +8,7 @@
 #include "memorytab.h"
 #include "processorhandler.h"
 #include "processortab.h"
+#include "profiler.h"
 #include "registerwidget.h"
 #include "ripessettings.h"
 #include "savedialog.h"
@@ -42,6 +43,10 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), m_ui(new Ui::Main
     // Initialize processor handler
     ProcessorHandler::get();
 
+    // Initialize profiler. This must be done before the cache shims are created, such that the profile is cleared
+    // before the shims record the accesses of the initial cycle upon a processor reset.
+    Profiler::get();
+
     // Initialize fonts
     QFontDatabase::addApplicationFont(":/fonts/Inconsolata/Inconsolata-Regular.ttf");
     QFontDatabase::addApplicationFont(":/fonts/Inconsolata/Inconsolata-Bold.ttf");
@@ -97,7 +102,8 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), m_ui(new Ui::Main
 
     // setup and connect widgets
     connect(editTab, &EditTab::editorStateChanged, [=] { RipesSettings::setValue(RIPES_SETTING_HAS_SAVEFILE, false); });
-    connect(&SystemIO::get(), &SystemIO::doPrint, processorTab, &ProcessorTab::printToLog);
+    // Program output is buffered by the console, which may be done directly from the thread handling the system call.
+    connect(&SystemIO::get(), &SystemIO::doPrint, processorTab, &ProcessorTab::printToLog, Qt::DirectConnection);
 
     // Setup status bar
     setupStatusBar();
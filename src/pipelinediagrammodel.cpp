@@ -3,21 +3,23 @@
 #include "processorhandler.h"
 #include "ripessettings.h"
 
-#include <vector>
+#include <algorithm>
 
 namespace Ripes {
 
-static inline AInt indexToAddress(unsigned index) {
-    if (auto spt = ProcessorHandler::getProgram()) {
-        return (index * ProcessorHandler::currentISA()->instrBytes()) + spt->getSection(TEXT_SECTION_NAME)->address;
-    }
-    return 0;
-}
-
 PipelineDiagramModel::PipelineDiagramModel(QObject* parent) : QAbstractTableModel(parent) {
     connect(ProcessorHandler::get(), &ProcessorHandler::processorClocked, this,
             &PipelineDiagramModel::processorWasClocked, Qt::DirectConnection);
     connect(ProcessorHandler::get(), &ProcessorHandler::processorReset, this, &PipelineDiagramModel::reset);
+
+    // runStarted is emitted before the run is started, such that no cycle of the run is clocked before m_running is
+    // set.
+    connect(ProcessorHandler::get(), &ProcessorHandler::runStarted, this, [=] { m_running = true; });
+    connect(ProcessorHandler::get(), &ProcessorHandler::runFinished, this, [=] { m_running = false; });
+
+    m_recordRuns = RipesSettings::value(RIPES_SETTING_PIPEDIAGRAM_RECORDRUNS).toBool();
+    connect(RipesSettings::getObserver(RIPES_SETTING_PIPEDIAGRAM_RECORDRUNS), &SettingObserver::modified, this,
+            [=](const auto& record) { m_recordRuns = record.toBool(); });
 }
 
 QVariant PipelineDiagramModel::headerData(int section, Qt::Orientation orientation, int role) const {
@@ -25,10 +27,9 @@ QVariant PipelineDiagramModel::headerData(int section, Qt::Orientation orientati
         return QVariant();
     if (orientation == Qt::Horizontal) {
         // Cycle number
-        return QString::number(section);
+        return QString::number(m_stageInfos.firstCycle() + section);
     } else {
-        const auto addr = indexToAddress(section);
-        return ProcessorHandler::disassembleInstr(addr);
+        return ProcessorHandler::disassembleInstr(m_stageInfos.rowAddress(section));
     }
 }
 
@@ -37,24 +38,23 @@ int PipelineDiagramModel::rowCount(const QModelIndex&) const {
 }
 
 int PipelineDiagramModel::columnCount(const QModelIndex&) const {
-    return m_cycleStageInfos.size();
+    return m_stageInfos.size();
 }
 
 void PipelineDiagramModel::processorWasClocked() {
-    if (m_atMaxCycles) {
+    // Called on the simulating thread for every cycle. Recording full-speed runs is opt-in, since it slows down
+    // execution.
+    if (m_running && !m_recordRuns) {
         return;
     }
     gatherStageInfo();
-
-    const auto cycleCount = ProcessorHandler::getProcessor()->getCycleCount();
-    if (cycleCount >= RipesSettings::value(RIPES_SETTING_PIPEDIAGRAM_MAXCYCLES).toInt()) {
-        m_atMaxCycles = true;
-    }
 }
 
 void PipelineDiagramModel::reset() {
-    m_atMaxCycles = false;
-    m_cycleStageInfos.clear();
+    // The diagram capacity is sampled upon reset, such that the store never has to be resized while recording.
+    m_stageInfos.reset(ProcessorHandler::getProcessor()->stageCount(),
+                       std::max(RipesSettings::value(RIPES_SETTING_PIPEDIAGRAM_MAXCYCLES).toInt(), 1),
+                       ProcessorHandler::getTextStart(), ProcessorHandler::currentISA()->instrBytes());
     gatherStageInfo();
 }
 
@@ -64,14 +64,12 @@ void PipelineDiagramModel::prepareForView() {
 }
 
 void PipelineDiagramModel::gatherStageInfo() {
-    long long cycleCount = ProcessorHandler::getProcessor()->getCycleCount();
-    if (m_cycleStageInfos.count(cycleCount)) {
+    const auto* processor = ProcessorHandler::getProcessor();
+    if (m_stageInfos.stages() != processor->stageCount()) {
+        // The processor changed since the store was last reset
         return;
     }
-    for (unsigned i = 0; i < ProcessorHandler::getProcessor()->stageCount(); i++) {
-        m_cycleStageInfos[ProcessorHandler::getProcessor()->getCycleCount()][i] =
-            ProcessorHandler::getProcessor()->stageInfo(i);
-    }
+    m_stageInfos.record(processor->getCycleCount(), *processor);
 }
 
 QVariant PipelineDiagramModel::data(const QModelIndex& index, int role) const {
@@ -85,33 +83,29 @@ QVariant PipelineDiagramModel::data(const QModelIndex& index, int role) const {
     if (role != Qt::DisplayRole)
         return QVariant();
 
-    if (!m_cycleStageInfos.count(index.column()))
+    const long long cycle = m_stageInfos.firstCycle() + index.column();
+    if (!m_stageInfos.contains(cycle))
         return QVariant();
 
-    const AInt addr = indexToAddress(index.row());
-    const auto& stageInfo = m_cycleStageInfos.at(index.column());
+    const int row = index.row();
+    const bool hasPrevCycle = m_stageInfos.contains(cycle - 1);
 
     QStringList stagesForAddr;
     QString stageStr;
-    for (const auto& si : stageInfo) {
-        if (si.second.pc == addr && si.second.stage_valid && si.second.state == StageInfo::State::None) {
-            if (m_cycleStageInfos.count(index.column() - 1)) {
-                const auto& prevCycleStageInfo = m_cycleStageInfos.at(index.column() - 1);
-                if (prevCycleStageInfo.at(si.first).stage_valid && prevCycleStageInfo.at(si.first).pc == si.second.pc) {
-                    stageStr = "-";
-                    if (!si.second.namedState.isEmpty()) {
-                        stageStr += " (" + si.second.namedState + ")";
-                    }
-                    stagesForAddr << stageStr;
-                    continue;
-                }
-            }
-            stageStr = ProcessorHandler::getProcessor()->stageName(si.first);
-            if (!si.second.namedState.isEmpty()) {
-                stageStr += " (" + si.second.namedState + ")";
-            }
-            stagesForAddr << stageStr;
+    for (unsigned stage = 0; stage < m_stageInfos.stages(); stage++) {
+        if (m_stageInfos.row(cycle, stage) != row || m_stageInfos.state(cycle, stage) != StageInfo::State::None) {
+            continue;
+        }
+        if (hasPrevCycle && m_stageInfos.row(cycle - 1, stage) == row) {
+            stageStr = "-";
+        } else {
+            stageStr = ProcessorHandler::getProcessor()->stageName(stage);
+        }
+        const QString& namedState = m_stageInfos.namedState(cycle, stage);
+        if (!namedState.isEmpty()) {
+            stageStr += " (" + namedState + ")";
         }
+        stagesForAddr << stageStr;
     }
 
     if (stagesForAddr.size() == 0) {
@@ -1,7 +1,11 @@
 #pragma once
 
 #include <QAbstractTableModel>
+
+#include <atomic>
+
 #include "processors/interface/ripesprocessor.h"
+#include "stageinfostore.h"
 
 namespace Ripes {
 
@@ -26,17 +30,18 @@ private:
     void gatherStageInfo();
 
     /**
-     * @brief m_cycleStageInfos
-     * map<cycle, map<stageId, stageInfo>>
+     * @brief m_stageInfos
+     * Stage information of the latest RIPES_SETTING_PIPEDIAGRAM_MAXCYCLES cycles. Column 0 of the model is the first
+     * cycle in the store, and the rows of the model are the rows of the store; one per instruction of the text section.
      */
-    std::map<long long, std::map<unsigned, StageInfo>> m_cycleStageInfos;
+    StageInfoStore m_stageInfos;
 
     /**
-     * @brief m_atMaxCycles
-     * Records the state that we've crossed the threshold set for RIPES_SETTING_PIPEDIAGRAM_MAXCYCLES.
-     * This is to speed up execution by not having to check the settings value during each cycle of simulation,
-     * after the value has been reached.
+     * @brief m_running/m_recordRuns
+     * Cycles executed while running the processor are only recorded if RIPES_SETTING_PIPEDIAGRAM_RECORDRUNS is set.
+     * Both are set on the GUI thread, and read on the simulator thread for every cycle.
      */
-    bool m_atMaxCycles = false;
+    std::atomic<bool> m_running = false;
+    std::atomic<bool> m_recordRuns = false;
 };
 }  // namespace Ripes
@@ -1,5 +1,7 @@
 #include "processorhandler.h"
 
+#include "checkpoint.h"
+#include "io/iomanager.h"
 #include "processorregistry.h"
 #include "processors/ripesvsrtlprocessor.h"
 #include "ripessettings.h"
@@ -12,8 +14,11 @@
 #include "syscall/riscv_syscall.h"
 
 #include <QMessageBox>
+#include <QSignalBlocker>
 #include <QtConcurrent/QtConcurrent>
 
+#include <limits>
+
 namespace Ripes {
 
 ProcessorHandler::ProcessorHandler() {
@@ -55,6 +60,10 @@ ProcessorHandler::ProcessorHandler() {
     // Update VSRTL reverse stack size to reflect current settings
     m_currentProcessor->setMaxReverseCycles(RipesSettings::value(RIPES_SETTING_REWINDSTACKSIZE).toUInt());
 
+    _setSnapshotInterval(RipesSettings::value(RIPES_SETTING_SNAPSHOTINTERVAL).toUInt());
+    connect(RipesSettings::getObserver(RIPES_SETTING_SNAPSHOTINTERVAL), &SettingObserver::modified,
+            [=](const auto& interval) { _setSnapshotInterval(interval.toUInt()); });
+
     // Reset request handling
     connect(RipesSettings::getObserver(RIPES_GLOBALSIGNAL_REQRESET), &SettingObserver::modified, this,
             &ProcessorHandler::_reset);
@@ -78,27 +87,39 @@ void ProcessorHandler::_loadProgram(const std::shared_ptr<Program>& p) {
     auto& mem = m_currentProcessor->getMemory();
 
     m_program = p;
+    m_disassembly.clear();
+    if (p->symbolIndex.empty()) {
+        // Programs without a symbol table of their own (e.g. assembled programs) are indexed by their labels.
+        p->symbolIndex = SymbolIndex::fromSymbolMap(p->symbols);
+    }
     // Memory initializations
     mem.clearInitializationMemories();
-    for (const auto& seg : p->sections) {
-        mem.addInitializationMemory(seg.second.address, seg.second.data.data(), seg.second.data.length());
+    if (!p->segments.empty()) {
+        for (const auto& seg : p->segments) {
+            mem.addInitializationMemory(seg.address, seg.data.data(), seg.data.length());
+        }
+    } else {
+        for (const auto& seg : p->sections) {
+            mem.addInitializationMemory(seg.second.address, seg.second.data.data(), seg.second.data.length());
+        }
     }
 
     m_currentProcessor->setPCInitialValue(p->entryPoint);
 
-    const auto textStart = textSection->address;
-    const auto textEnd = textSection->address + textSection->data.length();
+    m_textStart = textSection->address;
+    m_textSize = textSection->data.length();
 
     // Update breakpoints to stay within the loaded program range
     std::vector<AInt> bpsToRemove;
     for (const auto& bp : m_breakpoints) {
-        if ((bp < textStart) || (bp >= textEnd)) {
+        if (!_isExecutableAddress(bp)) {
             bpsToRemove.push_back(bp);
         }
     }
     for (const auto& bp : bpsToRemove) {
         m_breakpoints.erase(bp);
     }
+    rebuildBreakpointBitmap();
 
     RipesSettings::getObserver(RIPES_GLOBALSIGNAL_REQRESET)->trigger();
     emit programChanged();
@@ -106,6 +127,126 @@ void ProcessorHandler::_loadProgram(const std::shared_ptr<Program>& p) {
 
 void ProcessorHandler::_writeMem(AInt address, VInt value, int size) {
     m_currentProcessor->getMemory().writeMem(address, value, size);
+    markWrittenPages(address, size);
+    markWatchedWrite(address, size);
+}
+
+unsigned ProcessorHandler::blockAccessBytes(AInt address, AInt end) const {
+    // Memory is accessed in aligned words. Peripherals are not guaranteed to be mapped at word-aligned addresses, nor
+    // to support word accesses; they are accessed a byte at a time, and word accesses stop at their base address.
+    AInt bytes = std::min<AInt>(sizeof(VInt) - (address % sizeof(VInt)), end - address);
+    if (const auto region = IOManager::get().peripheralRegionFrom(address)) {
+        if (region->startAddr <= address) {
+            return 1;
+        }
+        bytes = std::min(bytes, region->startAddr - address);
+    }
+    return static_cast<unsigned>(bytes);
+}
+
+QByteArray ProcessorHandler::_readMemBlock(AInt address, size_t size) {
+    auto& mem = m_currentProcessor->getMemory();
+    // The size of a QByteArray is an int.
+    size = std::min<size_t>(size, std::numeric_limits<int>::max());
+    QByteArray data;
+    // At most 1 MiB is reserved up front, such that an oversized request does not allocate memory before being read.
+    data.reserve(static_cast<int>(std::min<size_t>(size, 1 << 20)));
+    const AInt end = address + size;
+    while (address < end) {
+        const unsigned bytes = blockAccessBytes(address, end);
+        VInt value = mem.readMemConst(address, bytes);
+        for (unsigned i = 0; i < bytes; i++) {
+            data.append(static_cast<char>(value & 0xFF));
+            value >>= 8;
+        }
+        address += bytes;
+    }
+    return data;
+}
+
+void ProcessorHandler::_writeMemBlock(AInt address, const QByteArray& data) {
+    auto& mem = m_currentProcessor->getMemory();
+    const AInt start = address;
+    const AInt end = address + data.size();
+    const char* bytePtr = data.constData();
+    while (address < end) {
+        const unsigned bytes = blockAccessBytes(address, end);
+        VInt value = 0;
+        for (unsigned i = 0; i < bytes; i++) {
+            value |= static_cast<VInt>(static_cast<uint8_t>(bytePtr[i])) << (8 * i);
+        }
+        mem.writeMem(address, value, bytes);
+        bytePtr += bytes;
+        address += bytes;
+    }
+    markWrittenPages(start, data.size());
+    markWatchedWrite(start, data.size());
+}
+
+QByteArray ProcessorHandler::_readMemCString(AInt address, size_t maxLength) {
+    auto& mem = m_currentProcessor->getMemory();
+    QByteArray string;
+    while (static_cast<size_t>(string.size()) < maxLength) {
+        const unsigned bytes = blockAccessBytes(address, address + (maxLength - string.size()));
+        VInt value = mem.readMemConst(address, bytes);
+        for (unsigned i = 0; i < bytes; i++) {
+            const char byte = static_cast<char>(value & 0xFF);
+            if (byte == '\0') {
+                return string;
+            }
+            string.append(byte);
+            value >>= 8;
+        }
+        address += bytes;
+    }
+    return string;
+}
+
+void ProcessorHandler::markWrittenPages(AInt address, unsigned bytes) {
+    if (bytes == 0) {
+        return;
+    }
+    const AInt lastPage = (address + bytes - 1) / s_memoryPageSize;
+    for (AInt page = address / s_memoryPageSize; page <= lastPage; page++) {
+        if (page < s_maxBitmapPages) {
+            if (page / 64 >= m_writtenPageBitmap.size()) {
+                m_writtenPageBitmap.resize(page / 64 + 1, 0);
+            }
+            m_writtenPageBitmap[page / 64] |= uint64_t(1) << (page % 64);
+        } else {
+            m_writtenPagesBeyondBitmap.insert(page * s_memoryPageSize);
+        }
+    }
+}
+
+void ProcessorHandler::clearWrittenPages() {
+    // The bitmap keeps its size, as the program is likely to write the same pages again.
+    std::fill(m_writtenPageBitmap.begin(), m_writtenPageBitmap.end(), 0);
+    m_writtenPagesBeyondBitmap.clear();
+}
+
+std::vector<AInt> ProcessorHandler::_getWrittenPages() const {
+    std::vector<AInt> pages;
+    for (size_t word = 0; word < m_writtenPageBitmap.size(); word++) {
+        const uint64_t bits = m_writtenPageBitmap[word];
+        if (bits == 0) {
+            continue;
+        }
+        for (unsigned bit = 0; bit < 64; bit++) {
+            if ((bits >> bit) & 1) {
+                pages.push_back((static_cast<AInt>(word) * 64 + bit) * s_memoryPageSize);
+            }
+        }
+    }
+    pages.insert(pages.end(), m_writtenPagesBeyondBitmap.begin(), m_writtenPagesBeyondBitmap.end());
+    return pages;
+}
+
+void ProcessorHandler::markDataMemWrite() {
+    const auto dataAccess = m_currentProcessor->dataMemAccess();
+    if (dataAccess.type == MemoryAccess::Write) {
+        markWrittenPages(dataAccess.address, dataAccess.bytes);
+    }
 }
 
 vsrtl::core::AddressSpaceMM& ProcessorHandler::_getMemory() {
@@ -129,7 +270,7 @@ public:
     void run() override {
         ProcessorHandler::getProcessorNonConst()->clockProcessor();
         ProcessorHandler::checkProcessorFinished();
-        if (ProcessorHandler::checkBreakpoint()) {
+        if (ProcessorHandler::checkBreakpoint() || ProcessorHandler::checkWatchpoints()) {
             ProcessorHandler::stopRun();
         }
         m_finished = true;
@@ -146,7 +287,7 @@ void ProcessorHandler::_clock() {
     }
 }
 
-void ProcessorHandler::_run() {
+void ProcessorHandler::_run(const RunCondition& condition) {
     ProcessorStatusManager::setStatus("Running...");
     emit runStarted();
 
@@ -158,29 +299,208 @@ void ProcessorHandler::_run() {
     connect(&m_runWatcher, &QFutureWatcher<void>::finished, this, [=] { ProcessorStatusManager::clearStatus(); });
 
     m_runWatcher.setFuture(QtConcurrent::run([=] {
-        auto* vsrtl_proc = dynamic_cast<vsrtl::SimDesign*>(m_currentProcessor.get());
+        m_lastRunStopReason = runUntil(condition);
+        emit runFinished();
+    }));
+}
 
-        if (vsrtl_proc) {
-            vsrtl_proc->setEnableSignals(false);
-        }
+RunStopReason ProcessorHandler::_runBlocking(const RunCondition& condition) {
+    Q_ASSERT(!_isRunning());
+    emit runStarted();
+    m_runningBlocking = true;
+    m_lastRunStopReason = runUntil(condition);
+    m_runningBlocking = false;
+    m_stopRunningFlag = false;
+    SystemIO::abortSyscall(false);
+    emit runFinished();
+    _triggerProcStateChangeTimer();
+    return m_lastRunStopReason;
+}
+
+RunStopReason ProcessorHandler::runUntil(const RunCondition& condition) {
+    auto* vsrtl_proc = dynamic_cast<vsrtl::SimDesign*>(m_currentProcessor.get());
 
-        while (!(_checkBreakpoint() || m_currentProcessor->finished() || m_stopRunningFlag)) {
+    if (vsrtl_proc) {
+        vsrtl_proc->setEnableSignals(false);
+    }
+
+    const long long cycleLimit = m_currentProcessor->getCycleCount() + condition.cycles;
+    const long long instructionLimit = m_currentProcessor->getInstructionsRetired() + condition.instructions;
+    RunStopReason reason;
+    while (true) {
+        if (_checkBreakpoint()) {
+            reason = RunStopReason::Breakpoint;
+        } else if (m_currentProcessor->finished()) {
+            reason = RunStopReason::Finished;
+        } else if (m_stopRunningFlag) {
+            reason = RunStopReason::Stopped;
+        } else if (condition.cycles != 0 && m_currentProcessor->getCycleCount() >= cycleLimit) {
+            reason = RunStopReason::CycleBudget;
+        } else if (condition.instructions != 0 && m_currentProcessor->getInstructionsRetired() >= instructionLimit) {
+            reason = RunStopReason::InstructionBudget;
+        } else if (condition.until && condition.until()) {
+            reason = RunStopReason::Condition;
+        } else {
             m_currentProcessor->clockProcessor();
+            if (m_watchpoints.empty() || !_checkWatchpoints()) {
+                continue;
+            }
+            reason = RunStopReason::Watchpoint;
         }
+        break;
+    }
 
-        if (vsrtl_proc) {
-            vsrtl_proc->setEnableSignals(true);
-        }
-        emit runFinished();
-    }));
+    if (vsrtl_proc) {
+        vsrtl_proc->setEnableSignals(true);
+    }
+    return reason;
+}
+
+RunCondition RunCondition::forCycles(long long n) {
+    RunCondition condition;
+    condition.cycles = n;
+    return condition;
+}
+
+RunCondition RunCondition::forInstructions(long long n) {
+    RunCondition condition;
+    condition.instructions = n;
+    return condition;
+}
+
+std::function<bool()> RunCondition::registerEquals(RegisterFileType rfid, unsigned idx, VInt value) {
+    return [=] { return ProcessorHandler::getProcessor()->getRegister(rfid, idx) == value; };
+}
+
+std::function<bool()> RunCondition::pcInRange(AInt start, AInt end) {
+    return [=] {
+        const AInt pc = ProcessorHandler::getProcessor()->getPcForStage(0);
+        return start <= pc && pc < end;
+    };
+}
+
+std::function<bool()> RunCondition::memoryChanged(AInt address, unsigned size) {
+    const QByteArray initial = ProcessorHandler::readMemBlock(address, size);
+    return [=] { return ProcessorHandler::readMemBlock(address, size) != initial; };
 }
 
 void ProcessorHandler::_setBreakpoint(const AInt address, bool enabled) {
-    if (enabled && _isExecutableAddress(address)) {
+    const bool active = enabled && _isExecutableAddress(address);
+    if (active) {
         m_breakpoints.insert(address);
     } else {
         m_breakpoints.erase(address);
     }
+    if (_isExecutableAddress(address)) {
+        const AInt offset = address - m_textStart;
+        const uint64_t bit = uint64_t(1) << (offset % 64);
+        if (active) {
+            m_breakpointBitmap[offset / 64] |= bit;
+        } else {
+            m_breakpointBitmap[offset / 64] &= ~bit;
+        }
+    }
+}
+
+void ProcessorHandler::rebuildBreakpointBitmap() {
+    m_breakpointBitmap.assign((m_textSize + 63) / 64, 0);
+    for (const auto& bp : m_breakpoints) {
+        if (_isExecutableAddress(bp)) {
+            const AInt offset = bp - m_textStart;
+            m_breakpointBitmap[offset / 64] |= uint64_t(1) << (offset % 64);
+        }
+    }
+}
+
+void ProcessorHandler::_setWatchpoint(AInt address, AInt size, unsigned types) {
+    _removeWatchpoint(address, size);
+    if (size == 0 || types == 0) {
+        return;
+    }
+    WatchedRange range;
+    range.watchpoint = Watchpoint{address, size, types};
+    if (types & Watchpoint::Change) {
+        range.contents = _readMemBlock(address, size);
+    }
+    m_watchpoints.push_back(range);
+}
+
+void ProcessorHandler::_removeWatchpoint(AInt address, AInt size) {
+    m_watchpoints.erase(std::remove_if(m_watchpoints.begin(), m_watchpoints.end(),
+                                       [=](const WatchedRange& range) {
+                                           return range.watchpoint.address == address &&
+                                                  range.watchpoint.size == size;
+                                       }),
+                        m_watchpoints.end());
+}
+
+void ProcessorHandler::_clearWatchpoints() {
+    m_watchpoints.clear();
+    m_watchpointHit.reset();
+}
+
+std::vector<Watchpoint> ProcessorHandler::_getWatchpoints() const {
+    std::vector<Watchpoint> watchpoints;
+    for (const auto& range : m_watchpoints) {
+        watchpoints.push_back(range.watchpoint);
+    }
+    return watchpoints;
+}
+
+bool ProcessorHandler::_checkWatchpoints() {
+    if (m_watchpoints.empty()) {
+        return false;
+    }
+
+    // The access of a processor stalled for memory was checked in the cycle which caused the stall.
+    const MemoryAccess access =
+        m_currentProcessor->isStalledForMemory() ? MemoryAccess() : m_currentProcessor->dataMemAccess();
+    bool triggered = false;
+    const auto trigger = [&](const Watchpoint& watchpoint, Watchpoint::Type type, const MemoryAccess& triggerAccess) {
+        if (!triggered) {
+            m_watchpointHit = WatchpointHit{watchpoint, type, triggerAccess};
+            triggered = true;
+        }
+    };
+
+    for (auto& range : m_watchpoints) {
+        const auto& wp = range.watchpoint;
+        const bool overlaps = access.type != MemoryAccess::None && access.address < wp.address + wp.size &&
+                              wp.address < access.address + access.bytes;
+
+        if (overlaps && access.type == MemoryAccess::Read && (wp.types & Watchpoint::Read)) {
+            trigger(wp, Watchpoint::Read, access);
+        } else if (overlaps && access.type == MemoryAccess::Write && (wp.types & Watchpoint::Write)) {
+            trigger(wp, Watchpoint::Write, access);
+        }
+
+        if (wp.types & Watchpoint::Change) {
+            // A write reported by the processor is performed in the following cycle; compare the contents once it has.
+            if (range.writePending) {
+                range.writePending = false;
+                QByteArray contents = _readMemBlock(wp.address, wp.size);
+                if (contents != range.contents) {
+                    range.contents = std::move(contents);
+                    trigger(wp, Watchpoint::Change, range.pendingWrite);
+                }
+            }
+            if (overlaps && access.type == MemoryAccess::Write) {
+                range.writePending = true;
+                range.pendingWrite = access;
+            }
+        }
+    }
+    return triggered;
+}
+
+void ProcessorHandler::markWatchedWrite(AInt address, unsigned bytes) {
+    for (auto& range : m_watchpoints) {
+        const auto& wp = range.watchpoint;
+        if ((wp.types & Watchpoint::Change) && address < wp.address + wp.size && wp.address < address + bytes) {
+            range.writePending = true;
+            range.pendingWrite = MemoryAccess{MemoryAccess::Write, address, bytes};
+        }
+    }
 }
 
 void ProcessorHandler::_loadProcessorToWidget(vsrtl::VSRTLWidget* widget, bool doPlaceAndRoute) {
@@ -197,9 +517,14 @@ bool ProcessorHandler::_hasBreakpoint(const AInt address) const {
 }
 
 bool ProcessorHandler::_checkBreakpoint() {
-    for (const auto& stage : m_currentProcessor->breakpointTriggeringStages()) {
-        const auto it = m_breakpoints.find(m_currentProcessor->getPcForStage(stage));
-        if (it != m_breakpoints.end()) {
+    // Called every cycle while running; most programs are run without any breakpoints set.
+    if (m_breakpoints.empty()) {
+        return false;
+    }
+    for (const auto& stage : m_breakpointStages) {
+        // Addresses below the .text section wrap around to large offsets.
+        const AInt offset = m_currentProcessor->getPcForStage(stage) - m_textStart;
+        if (offset < m_textSize && (m_breakpointBitmap[offset / 64] >> (offset % 64)) & 1) {
             return true;
         }
     }
@@ -212,6 +537,7 @@ void ProcessorHandler::_toggleBreakpoint(const AInt address) {
 
 void ProcessorHandler::_clearBreakpoints() {
     m_breakpoints.clear();
+    std::fill(m_breakpointBitmap.begin(), m_breakpointBitmap.end(), 0);
 }
 
 void ProcessorHandler::createAssemblerForCurrentISA() {
@@ -232,6 +558,16 @@ void ProcessorHandler::_reset() {
     }
 
     getProcessorNonConst()->resetProcessor();
+    clearWrittenPages();
+    m_snapshots.clear();
+    markDataMemWrite();
+    m_watchpointHit.reset();
+    for (auto& range : m_watchpoints) {
+        if (range.watchpoint.types & Watchpoint::Change) {
+            range.contents = _readMemBlock(range.watchpoint.address, range.watchpoint.size);
+            range.writePending = false;
+        }
+    }
 
     // Rewrite register initializations
     for (const auto& kv : m_currentRegInits) {
@@ -255,43 +591,33 @@ void ProcessorHandler::_selectProcessor(const ProcessorID& id, const QStringList
     // Processor initializations
     m_currentProcessor = ProcessorRegistry::constructProcessor(m_currentID, extensions);
     m_currentProcessor->isExecutableAddress = [=](AInt address) { return _isExecutableAddress(address); };
+    m_breakpointStages = m_currentProcessor->breakpointTriggeringStages();
 
     // Syscall handling initialization
     m_currentProcessor->trapHandler = [=] { syscallTrap(); };
 
     m_currentProcessor->postConstruct();
     createAssemblerForCurrentISA();
+    m_disassembly.clear();
 
     if (keepProgram && m_program) {
         loadProgram(m_program);
     } else {
         m_program = nullptr;
+        m_textStart = 0;
+        m_textSize = 0;
+        rebuildBreakpointBitmap();
         emit programChanged();
     }
 
     // Connect wrappers for making processor signal emissions thread safe.
     m_signalWrappers.clear();
-    m_signalWrappers.push_back(std::unique_ptr<GallantSignalWrapperBase>(new GallantSignalWrapper(
-        this,
-        [=] {
-            if (!_isRunning()) {
-                emit processorClockedNonRun();
-                _triggerProcStateChangeTimer();
-            }
-        },
-        m_currentProcessor->processorWasClocked)));
     // Connect ProcessorHandler::processorClocked since things connected to this signal _must_ be updated _for each_
     // processor cycle, in order. Which would not be possible through processorClockedNonRun, which might be
     // cross-thread and out of order.
-    m_currentProcessor->processorWasClocked.Connect(this, &ProcessorHandler::processorClocked);
+    m_currentProcessor->processorWasClocked.Connect(this, &ProcessorHandler::processorWasClocked);
 
-    m_signalWrappers.push_back(std::unique_ptr<GallantSignalWrapperBase>(new GallantSignalWrapper(
-        this,
-        [=] {
-            emit processorReset();
-            _triggerProcStateChangeTimer();
-        },
-        m_currentProcessor->processorWasReset)));
+    m_currentProcessor->processorWasReset.Connect(this, &ProcessorHandler::processorWasReset);
 
     m_signalWrappers.push_back(std::unique_ptr<GallantSignalWrapperBase>(new GallantSignalWrapper(
         this,
@@ -329,31 +655,195 @@ AInt ProcessorHandler::_getTextStart() const {
 
 QString ProcessorHandler::_disassembleInstr(const AInt addr) const {
     if (m_program) {
-        return m_currentAssembler
-            ->disassemble(m_currentProcessor->getMemory().readMem(addr), m_program.get()->symbols, addr)
-            .first;
+        const VInt instr = m_currentProcessor->getMemory().readMemConst(addr);
+        auto it = m_disassembly.find(addr);
+        if (it == m_disassembly.end() || it->second.first != instr) {
+            const QString disassembled = m_currentAssembler->disassemble(instr, m_program.get()->symbols, addr).first;
+            it = m_disassembly.insert_or_assign(addr, std::make_pair(instr, disassembled)).first;
+        }
+        return it->second.second;
     } else {
         return QString();
     }
 }
 
 void ProcessorHandler::syscallTrap() {
-    auto futureWatcher = QFutureWatcher<bool>();
-    futureWatcher.setFuture(QtConcurrent::run([=] {
-        const unsigned int function =
-            m_currentProcessor->getRegister(RegisterFileType::GPR, _currentISA()->syscallReg());
-        return m_syscallManager->execute(function);
-    }));
+    const unsigned int function = m_currentProcessor->getRegister(RegisterFileType::GPR, _currentISA()->syscallReg());
+    const auto* syscall = m_syscallManager->getSyscall(function);
+
+    bool success;
+    if (syscall && syscall->blocksOnInput()) {
+        // Syscalls waiting for user input are executed on the thread pool.
+        auto futureWatcher = QFutureWatcher<bool>();
+        futureWatcher.setFuture(QtConcurrent::run([=] { return m_syscallManager->execute(function); }));
+        futureWatcher.waitForFinished();
+        success = futureWatcher.result();
+    } else {
+        // All other syscalls are executed directly on the simulating thread.
+        success = m_syscallManager->execute(function);
+    }
 
-    futureWatcher.waitForFinished();
-    if (!futureWatcher.result()) {
+    if (!success) {
         // Syscall handling failed, stop running processor
         setStopRunFlag();
     }
 }
 
+void ProcessorHandler::processorWasClocked() {
+    markDataMemWrite();
+    emit processorClocked();
+
+    // Snapshots do not capture pipeline registers, and as such are only taken for processors which have no pipeline
+    // registers. A snapshot is postponed while an executed system call is in flight, as rewinding to it would execute
+    // the system call again.
+    if (m_snapshotInterval != 0 && m_currentProcessor->stageCount() == 1 &&
+        m_currentProcessor->getCycleCount() >= m_nextSnapshotCycle && !executedEcallInFlight()) {
+        adaptSnapshotInterval();
+        takeSnapshot();
+    }
+
+    // GUI updates are only posted when not running. This avoids flooding the GUI event loop with an event for each
+    // cycle executed while running.
+    if (!_isRunning()) {
+        QMetaObject::invokeMethod(this, [=] {
+            emit processorClockedNonRun();
+            _triggerProcStateChangeTimer();
+        });
+    }
+}
+
+void ProcessorHandler::processorWasReset() {
+    // Resetting the processor as part of rewinding it is not a reset of the simulation.
+    if (m_rewinding) {
+        return;
+    }
+
+    QMetaObject::invokeMethod(this, [=] {
+        emit processorReset();
+        // Everything observing the processor has now been reset; this is the initial state which rewinding may always
+        // start from. No instructions are in flight upon reset, so this snapshot is also valid for pipelined
+        // processors. These are not snapshotted at later cycles, and are thus rewound by re-executing from reset, at a
+        // cost proportional to the target cycle.
+        takeSnapshot();
+        _triggerProcStateChangeTimer();
+    });
+}
+
+void ProcessorHandler::_setSnapshotInterval(unsigned cycles) {
+    m_snapshotInterval = cycles;
+    m_adaptiveSnapshotInterval = cycles;
+    m_nextSnapshotCycle = m_currentProcessor->getCycleCount() + cycles;
+}
+
+void ProcessorHandler::adaptSnapshotInterval() {
+    // Snapshots should take up no more than ~1% of the simulation time. The cost of the previous snapshot is taken as
+    // an estimate of the cost of the next.
+    if (!m_snapshotTimer.isValid()) {
+        return;
+    }
+    const qint64 simulationTime = m_snapshotTimer.nsecsElapsed();
+    const long long maxInterval = static_cast<long long>(m_snapshotInterval) * s_maxSnapshotIntervalScale;
+    if (m_snapshotCost * 100 > simulationTime) {
+        m_adaptiveSnapshotInterval = std::min(m_adaptiveSnapshotInterval * 2, maxInterval);
+    } else if (m_snapshotCost * 400 < simulationTime) {
+        m_adaptiveSnapshotInterval = std::max<long long>(m_adaptiveSnapshotInterval / 2, m_snapshotInterval);
+    }
+}
+
+void ProcessorHandler::takeSnapshot() {
+    QElapsedTimer timer;
+    timer.start();
+    const long long cycle = m_currentProcessor->getCycleCount();
+
+    // Snapshots from beyond the current cycle are stale.
+    m_snapshots.erase(m_snapshots.lower_bound(cycle), m_snapshots.end());
+    if (m_snapshots.size() >= s_maxSnapshots) {
+        // Keeps memory usage bounded, at the cost of having to re-execute more cycles when rewinding into the thinned
+        // out range. The initial snapshot is always kept.
+        bool discard = false;
+        for (auto it = std::next(m_snapshots.begin()); it != m_snapshots.end(); discard = !discard) {
+            it = discard ? m_snapshots.erase(it) : std::next(it);
+        }
+    }
+
+    // Unconsumed stdin data is not copied; rewinding the stdin stream to stdinPos makes it available again.
+    m_snapshots[cycle] = {std::make_shared<const Checkpoint>(captureCheckpoint({}, false)), SystemIO::stdinPos(),
+                          m_currentProcessor->memoryStallCycles()};
+    emit snapshotTaken(cycle);
+
+    m_snapshotCost = timer.nsecsElapsed();
+    m_nextSnapshotCycle = cycle + m_adaptiveSnapshotInterval;
+    m_snapshotTimer.start();
+}
+
+bool ProcessorHandler::_canReverse() {
+    if (_isRunning()) {
+        return false;
+    }
+    if (m_vsrtlWidget && isVSRTLProcessor() && m_vsrtlWidget->isReversible()) {
+        return true;
+    }
+    return !m_snapshots.empty() && m_snapshots.begin()->first < m_currentProcessor->getCycleCount();
+}
+
+void ProcessorHandler::_reverse() {
+    if (m_vsrtlWidget && isVSRTLProcessor() && m_vsrtlWidget->isReversible()) {
+        m_vsrtlWidget->reverse();
+    } else {
+        _rewind(m_currentProcessor->getCycleCount() - 1);
+    }
+}
+
+void ProcessorHandler::_rewind(long long cycle) {
+    auto it = m_snapshots.upper_bound(cycle);
+    if (_isRunning() || it == m_snapshots.begin() || cycle >= m_currentProcessor->getCycleCount()) {
+        return;
+    }
+    // Copied, given that snapshots may be thinned out whilst re-executing.
+    const auto snapshotCycle = std::prev(it)->first;
+    const auto snapshot = std::prev(it)->second;
+
+    auto* vsrtl_proc = dynamic_cast<vsrtl::SimDesign*>(m_currentProcessor.get());
+    if (vsrtl_proc) {
+        vsrtl_proc->setEnableSignals(false);
+    }
+    m_rewinding = true;
+
+    {
+        // Output of the re-executed cycles has already been printed.
+        const QSignalBlocker blocker(SystemIO::get());
+
+        m_currentProcessor->resetProcessor();
+        clearWrittenPages();
+        QStringList warnings;
+        applyCheckpoint(*snapshot.checkpoint, {}, warnings);
+        m_currentProcessor->stallForMemory(snapshot.memoryStallCycles);
+        // Files are restored such that re-executed writes do not duplicate output which was already written.
+        if (auto error = SystemIO::restoreFiles(snapshot.checkpoint->systemIO.files)) {
+            SystemIOStatusManager::setStatusTimed(*error, 5000);
+        }
+        SystemIO::rewindStdin(snapshot.stdinPos);
+        emit snapshotRestored(snapshotCycle);
+        m_nextSnapshotCycle = snapshotCycle + m_adaptiveSnapshotInterval;
+        m_snapshotTimer.start();
+
+        while (m_currentProcessor->getCycleCount() < cycle) {
+            m_currentProcessor->clockProcessor();
+        }
+    }
+
+    m_rewinding = false;
+    if (vsrtl_proc) {
+        vsrtl_proc->setEnableSignals(true);
+    }
+
+    // Rewinding is equivalent to a run wrt. the views which were not updated whilst re-executing.
+    emit runFinished();
+    _triggerProcStateChangeTimer();
+}
+
 bool ProcessorHandler::_isRunning() {
-    return !m_runWatcher.isFinished();
+    return m_rewinding || m_runningBlocking || !m_runWatcher.isFinished();
 }
 
 void ProcessorHandler::_checkProcessorFinished() {
@@ -363,7 +853,7 @@ void ProcessorHandler::_checkProcessorFinished() {
 
 void ProcessorHandler::setStopRunFlag() {
     emit stopping();
-    if (m_runWatcher.isRunning()) {
+    if (m_runWatcher.isRunning() || m_runningBlocking) {
         m_stopRunningFlag = true;
         // We might be currently trapping for user I/O. Signal to abort the trap, in this avoiding a deadlock.
         SystemIO::abortSyscall(true);
@@ -372,20 +862,19 @@ void ProcessorHandler::setStopRunFlag() {
 
 void ProcessorHandler::_stopRun() {
     setStopRunFlag();
+    if (m_runningBlocking) {
+        // Cannot be waited for; the blocking run clears the stop flag once it returns.
+        return;
+    }
     m_runWatcher.waitForFinished();
     m_stopRunningFlag = false;
     SystemIO::abortSyscall(false);
 }
 
 bool ProcessorHandler::_isExecutableAddress(AInt address) const {
-    if (m_program) {
-        if (auto* textSection = m_program->getSection(TEXT_SECTION_NAME)) {
-            const auto textStart = textSection->address;
-            const auto textEnd = textSection->address + textSection->data.length();
-            return textStart <= address && address < textEnd;
-        }
-    }
-    return false;
+    // The bounds of the .text section are cached when loading the program; this is called for every pipeline stage
+    // each cycle.
+    return m_textStart <= address && address - m_textStart < m_textSize;
 }
 
 void ProcessorHandler::_setRegisterValue(RegisterFileType rfid, const unsigned idx, VInt value) {
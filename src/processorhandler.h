@@ -1,9 +1,13 @@
 #pragma once
 
+#include <QElapsedTimer>
 #include <QFuture>
 #include <QFutureWatcher>
 #include <QObject>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <unordered_map>
 
 #include "assembler/assembler.h"
 #include "assembler/program.h"
@@ -15,9 +19,59 @@
 #include "vsrtl_widget.h"
 
 namespace Ripes {
+struct Checkpoint;
 
 StatusManager(Processor);
 
+/**
+ * @brief The RunCondition struct
+ * Bounds a run of the processor. A run stops once either budget is exhausted or the stop condition holds, in addition
+ * to stopping upon hitting a breakpoint, finishing the program or through stopRun().
+ */
+struct RunCondition {
+    // Maximum number of cycles to execute; 0 for no limit.
+    long long cycles = 0;
+    // Maximum number of instructions to retire; 0 for no limit.
+    long long instructions = 0;
+    // Evaluated before each cycle, on the thread executing the run. The run stops once this returns true.
+    std::function<bool()> until;
+
+    static RunCondition forCycles(long long n);
+    static RunCondition forInstructions(long long n);
+
+    /**
+     * @brief Stop conditions for common scripted experiments.
+     * registerEquals holds once register @p idx of @p rfid has the value @p value. pcInRange holds once the first
+     * stage of the processor is within [@p start; @p end[. memoryChanged holds once the @p size bytes at @p address
+     * differ from their value at the time of calling memoryChanged.
+     */
+    static std::function<bool()> registerEquals(RegisterFileType rfid, unsigned idx, VInt value);
+    static std::function<bool()> pcInRange(AInt start, AInt end);
+    static std::function<bool()> memoryChanged(AInt address, unsigned size);
+};
+
+enum class RunStopReason { Breakpoint, Watchpoint, Finished, Stopped, CycleBudget, InstructionBudget, Condition };
+
+/**
+ * @brief The Watchpoint struct
+ * Watches the data memory accesses to [address; address + size[. Read and write watchpoints trigger when the processor
+ * is about to perform a load or store overlapping the range. Change watchpoints trigger once the contents of the range
+ * differ from when the watchpoint was set or last triggered, after any write to the range.
+ */
+struct Watchpoint {
+    enum Type : unsigned { Read = 0b001, Write = 0b010, Change = 0b100 };
+    AInt address;
+    AInt size;
+    unsigned types;
+};
+
+struct WatchpointHit {
+    Watchpoint watchpoint;
+    Watchpoint::Type type;
+    // The access which triggered the watchpoint. For change watchpoints, this is the write which changed the range.
+    MemoryAccess access;
+};
+
 /**
  * @brief The ProcessorHandler class
  * Manages construction and destruction of a VSRTL processor design, when selecting between processors.
@@ -105,6 +159,32 @@ public:
      */
     static void writeMem(AInt address, VInt value, int size = sizeof(VInt)) { get()->_writeMem(address, value, size); }
 
+    /**
+     * @brief readMemBlock/writeMemBlock
+     * Reads or writes @p size bytes of memory starting from @p address. Memory is accessed a word at a time rather than
+     * per byte, except for memory-mapped peripherals. At most INT_MAX bytes are read.
+     */
+    static QByteArray readMemBlock(AInt address, size_t size) { return get()->_readMemBlock(address, size); }
+    static void writeMemBlock(AInt address, const QByteArray& data) { get()->_writeMemBlock(address, data); }
+
+    /**
+     * @brief readMemCString
+     * @returns the null-terminated string starting at @p address, excluding the null terminator. At most
+     * @p maxLength bytes are read.
+     */
+    static QByteArray readMemCString(AInt address, size_t maxLength = s_maxCStringLength) {
+        return get()->_readMemCString(address, maxLength);
+    }
+    static constexpr size_t s_maxCStringLength = 1 << 20;
+
+    /**
+     * @brief getWrittenPages
+     * @returns the base addresses of all memory pages (of size s_memoryPageSize) which may have been written since the
+     * processor was last reset, either by the processor or through writeMem, in ascending order.
+     */
+    static std::vector<AInt> getWrittenPages() { return get()->_getWrittenPages(); }
+    static constexpr AInt s_memoryPageSize = 4096;
+
     /**
      * @brief getRegisterValue
      * @returns value of register @param idx
@@ -118,19 +198,100 @@ public:
     static void toggleBreakpoint(const AInt address) { get()->_toggleBreakpoint(address); }
     static bool hasBreakpoint(const AInt address) { return get()->_hasBreakpoint(address); }
     static void clearBreakpoints() { get()->_clearBreakpoints(); }
+
+    /**
+     * @brief setWatchpoint/removeWatchpoint
+     * Sets the watchpoint types (Watchpoint::Type flags) of the range [@p address; @p address + @p size[, replacing any
+     * watchpoint of the same range. Runs stop after the cycle in which a watchpoint is triggered.
+     */
+    static void setWatchpoint(AInt address, AInt size, unsigned types) {
+        get()->_setWatchpoint(address, size, types);
+    }
+    static void removeWatchpoint(AInt address, AInt size) { get()->_removeWatchpoint(address, size); }
+    static void clearWatchpoints() { get()->_clearWatchpoints(); }
+    static std::vector<Watchpoint> getWatchpoints() { return get()->_getWatchpoints(); }
+    static bool checkWatchpoints() { return get()->_checkWatchpoints(); }
+
+    /**
+     * @brief lastWatchpointHit
+     * @returns the latest triggered watchpoint, if any has triggered since the processor was reset.
+     */
+    static const std::optional<WatchpointHit>& lastWatchpointHit() { return get()->m_watchpointHit; }
     static void checkProcessorFinished() { get()->_checkProcessorFinished(); }
     static bool isRunning() { return get()->_isRunning(); }
+    /**
+     * @brief isRewinding
+     * @returns true while rewind() re-executes the processor from a snapshot. The re-executed cycles are clocked as
+     * usual, but were already observed before the processor was rewound.
+     */
+    static bool isRewinding() { return get()->m_rewinding; }
 
     /**
      * @brief run
      * Asynchronously runs the current processor. During this, the processor will not be emitting signals for updating
      * its graphical representation. Will break upon hitting a breakpoint, going out of bounds wrt. the allowed
-     * execution area or if the stop flag has been set through stop().
+     * execution area, if the stop flag has been set through stop() or once @p condition is met.
+     */
+    static void run(const RunCondition& condition = {}) { get()->_run(condition); }
+
+    /**
+     * @brief runBlocking
+     * Runs the current processor on the calling thread, with the same stop criteria as run(). The processor is
+     * considered to be running for the duration of the call, such that no GUI updates are posted for each cycle, and
+     * stop requests (ie. of failing system calls) are observed. Intended for batch simulation and scripted experiments
+     * which inspect the processor in between partial runs.
+     * @returns the reason for which the run stopped.
+     */
+    static RunStopReason runBlocking(const RunCondition& condition) { return get()->_runBlocking(condition); }
+
+    /**
+     * @brief lastRunStopReason
+     * @returns the reason for which the latest run stopped.
      */
-    static void run() { get()->_run(); }
+    static RunStopReason lastRunStopReason() { return get()->m_lastRunStopReason; }
 
     static void clock() { get()->_clock(); }
 
+    /**
+     * @brief canReverse
+     * @returns whether the latest clock cycle of the current processor can be undone, either through the reverse stack
+     * of the processor model or by rewinding from a snapshot. Pipelined processors are only snapshotted upon reset;
+     * beyond their reverse stack, undoing a cycle re-executes the program from reset.
+     */
+    static bool canReverse() { return get()->_canReverse(); }
+
+    /**
+     * @brief reverse
+     * Undoes the latest clock cycle of the current processor. Cycles within the reverse stack of the processor model
+     * are undone directly; beyond that, the processor is rewound.
+     */
+    static void reverse() { get()->_reverse(); }
+
+    /**
+     * @brief rewind
+     * Rewinds the current processor to @p cycle, by restoring the nearest snapshot taken at or before @p cycle and
+     * re-executing the processor from there. The files opened by the program are restored to the state of the
+     * snapshot, and stdin is rewound, such that re-executed reads and writes see the same data. Console output is not
+     * repeated whilst re-executing.
+     */
+    static void rewind(long long cycle) { get()->_rewind(cycle); }
+
+    /**
+     * @brief hasSnapshot
+     * @returns whether a snapshot of the processor state is kept for @p cycle.
+     */
+    static bool hasSnapshot(long long cycle) { return get()->m_snapshots.count(cycle); }
+
+    /**
+     * @brief setSnapshotInterval
+     * Sets the number of cycles between snapshots for the current session, overriding RIPES_SETTING_SNAPSHOTINTERVAL.
+     * The interval is a lower bound; it is scaled up while taking snapshots is expensive relative to simulating. 0
+     * disables periodic snapshots.
+     */
+    static void setSnapshotInterval(unsigned cycles) { get()->_setSnapshotInterval(cycles); }
+    static constexpr unsigned s_maxSnapshots = 64;
+    static constexpr unsigned s_maxSnapshotIntervalScale = 64;
+
     /**
      * @brief stopRun
      * Sets the m_stopRunningFlag, and waits for any currently running asynchronous run execution to finish.
@@ -178,6 +339,15 @@ signals:
     void processorClockedNonRun();  // Only emitted when _not_ running; i.e., for GUI updating
     void procStateChangedNonRun();  // processorReset | processorReversed | processorClockedNonRun
 
+    /**
+     * @brief snapshotTaken/snapshotRestored
+     * Emitted when a snapshot of the processor state is taken at, or restored to, @p cycle. Simulation state which is
+     * not part of the snapshot (ie. caches) must be kept per snapshot by its owner. snapshotTaken may be emitted from
+     * the simulator thread; connect using Qt::DirectConnection.
+     */
+    void snapshotTaken(long long cycle);
+    void snapshotRestored(long long cycle);
+
 private slots:
     /**
      * @brief syscallTrap
@@ -206,20 +376,66 @@ private:
     const vsrtl::core::AddressSpace& _getRegisters() const;
     void _setRegisterValue(RegisterFileType rfid, const unsigned idx, VInt value);
     void _writeMem(AInt address, VInt value, int size = sizeof(VInt));
+    QByteArray _readMemBlock(AInt address, size_t size);
+    void _writeMemBlock(AInt address, const QByteArray& data);
+    QByteArray _readMemCString(AInt address, size_t maxLength);
+    /**
+     * @brief blockAccessBytes
+     * @returns the number of bytes of the next access of a block access at @p address, of the block ending at @p end.
+     */
+    unsigned blockAccessBytes(AInt address, AInt end) const;
     VInt _getRegisterValue(RegisterFileType rfid, const unsigned idx) const;
     bool _checkBreakpoint();
     void _setBreakpoint(const AInt address, bool enabled);
     void _toggleBreakpoint(const AInt address);
     bool _hasBreakpoint(const AInt address) const;
     void _clearBreakpoints();
+    void rebuildBreakpointBitmap();
+    void _setWatchpoint(AInt address, AInt size, unsigned types);
+    void _removeWatchpoint(AInt address, AInt size);
+    void _clearWatchpoints();
+    std::vector<Watchpoint> _getWatchpoints() const;
+    bool _checkWatchpoints();
+    void markWatchedWrite(AInt address, unsigned bytes);
     void _checkProcessorFinished();
     bool _isRunning();
-    void _run();
+    void _run(const RunCondition& condition);
+    RunStopReason _runBlocking(const RunCondition& condition);
+    RunStopReason runUntil(const RunCondition& condition);
     void _clock();
     void _reset();
+    bool _canReverse();
+    void _reverse();
+    void _rewind(long long cycle);
     void _stopRun();
     void _triggerProcStateChangeTimer();
 
+    /**
+     * @brief processorWasClocked
+     * Called from the simulator thread for each cycle clocked by the current processor.
+     */
+    void processorWasClocked();
+    void processorWasReset();
+    /**
+     * @brief takeSnapshot
+     * Snapshots the current processor state. If s_maxSnapshots is exceeded, every other snapshot is discarded.
+     */
+    void takeSnapshot();
+    void _setSnapshotInterval(unsigned cycles);
+    /**
+     * @brief adaptSnapshotInterval
+     * Scales m_adaptiveSnapshotInterval such that taking snapshots makes up a small share of the simulation time.
+     */
+    void adaptSnapshotInterval();
+    void markWrittenPages(AInt address, unsigned bytes);
+    void clearWrittenPages();
+    std::vector<AInt> _getWrittenPages() const;
+    /**
+     * @brief markDataMemWrite
+     * Marks the pages written by the data memory access which the processor currently presents, if any.
+     */
+    void markDataMemWrite();
+
     void createAssemblerForCurrentISA();
     void setStopRunFlag();
     ProcessorHandler();
@@ -242,8 +458,87 @@ private:
     std::set<AInt> m_breakpoints;
     std::shared_ptr<Program> m_program;
 
+    /**
+     * @brief m_breakpointBitmap
+     * One bit for each byte of the .text section of the current program, set for each address in m_breakpoints. Allows
+     * for checking breakpoints each cycle without tree lookups.
+     */
+    std::vector<uint64_t> m_breakpointBitmap;
+    std::vector<unsigned> m_breakpointStages;
+    AInt m_textStart = 0;
+    AInt m_textSize = 0;
+
+    struct WatchedRange {
+        Watchpoint watchpoint;
+        // Contents of the range, for change watchpoints
+        QByteArray contents;
+        // Set when a write to the range may have been performed since the contents were last compared.
+        bool writePending = false;
+        MemoryAccess pendingWrite;
+    };
+    /**
+     * @brief m_watchpoints
+     * Only checked when non-empty, such that runs without watchpoints are unaffected by the watchpoint machinery.
+     */
+    std::vector<WatchedRange> m_watchpoints;
+    std::optional<WatchpointHit> m_watchpointHit;
+
+    /**
+     * @brief m_disassembly
+     * Disassembled instructions of the current program, keyed by address. Each entry records the instruction word which
+     * it was disassembled from. The processor may write to the .text segment, so entries are validated against the
+     * current contents of memory before being used.
+     */
+    mutable std::unordered_map<AInt, std::pair<VInt, QString>> m_disassembly;
+
+    /**
+     * @brief m_writtenPageBitmap
+     * Bitmap of the memory pages which may have been written since the processor was last reset, indexed by page
+     * number and grown as pages are written. Data memory writes are recorded as they are presented by the processor, so
+     * this may be a superset of the pages which were actually written (ie. if a store was flushed from the pipeline).
+     * Pages beyond s_maxBitmapPages (ie. in the upper part of a 64-bit address space) are instead kept in
+     * m_writtenPagesBeyondBitmap, by base address.
+     */
+    std::vector<uint64_t> m_writtenPageBitmap;
+    std::set<AInt> m_writtenPagesBeyondBitmap;
+    // Covers a 32-bit address space; a bitmap of 128 KiB.
+    static constexpr AInt s_maxBitmapPages = (AInt(1) << 32) / s_memoryPageSize;
+
+    struct Snapshot {
+        std::shared_ptr<const Checkpoint> checkpoint;
+        // Position of the stdin stream, see SystemIO::stdinPos.
+        qint64 stdinPos;
+        // Cycles which the processor was yet to be stalled for, waiting for memory.
+        unsigned memoryStallCycles;
+    };
+
+    /**
+     * @brief m_snapshots
+     * Snapshots of the processor state, indexed by the cycle which they were taken at. A snapshot is taken upon reset,
+     * and every m_adaptiveSnapshotInterval cycles thereafter. Snapshots do not capture pipeline registers, so pipelined
+     * processors are only snapshotted upon reset, where their pipeline is empty.
+     */
+    std::map<long long, Snapshot> m_snapshots;
+    // Configured number of cycles between snapshots.
+    unsigned m_snapshotInterval = 0;
+    // Current number of cycles between snapshots; between m_snapshotInterval and s_maxSnapshotIntervalScale times that.
+    long long m_adaptiveSnapshotInterval = 0;
+    long long m_nextSnapshotCycle = 0;
+    // Time taken by the latest snapshot, in nanoseconds, and the time elapsed since.
+    qint64 m_snapshotCost = 0;
+    QElapsedTimer m_snapshotTimer;
+
+    /**
+     * @brief m_rewinding
+     * Set while re-executing the processor from a snapshot. The processor is then considered to be running.
+     */
+    bool m_rewinding = false;
+    // Set during runBlocking. The processor is then considered to be running.
+    bool m_runningBlocking = false;
+
     QFutureWatcher<void> m_runWatcher;
     bool m_stopRunningFlag = false;
+    RunStopReason m_lastRunStopReason = RunStopReason::Stopped;
     bool m_clockFinished = true;
 
     /**
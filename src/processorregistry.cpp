@@ -7,6 +7,7 @@
 #include "processors/RISC-V/rv5s_no_fw_hz/rv5s_no_fw_hz.h"
 #include "processors/RISC-V/rv5s_no_hz/rv5s_no_hz.h"
 #include "processors/RISC-V/rv6s_dual/rv6s_dual.h"
+#include "processors/RISC-V/rviss/rviss.h"
 #include "processors/RISC-V/rvss/rvss.h"
 
 namespace Ripes {
@@ -102,5 +103,19 @@ ProcessorRegistry::ProcessorRegistry() {
         "A 6-stage dual-issue in-order processor. Each way may execute arithmetic instructions, whereas way 1 "
         "is reserved for controlflow and ecall instructions, and way 2 for memory accessing instructions.",
         layouts, defRegVals));
+
+    // RISC-V functional instruction-set simulator. Not a VSRTL model, and as such provides no layouts.
+    layouts = {};
+    defRegVals = {{2, 0x7ffffff0}, {3, 0x10000000}};
+    addProcessor(ProcInfo<RVISS<uint32_t>>(
+        ProcessorID::RV32_ISS, "Instruction-set simulator",
+        "A functional instruction-set simulator without any datapath model. Executes one instruction per cycle, and is "
+        "intended for quickly running long programs.",
+        layouts, defRegVals));
+    addProcessor(ProcInfo<RVISS<uint64_t>>(
+        ProcessorID::RV64_ISS, "Instruction-set simulator",
+        "A functional instruction-set simulator without any datapath model. Executes one instruction per cycle, and is "
+        "intended for quickly running long programs.",
+        layouts, defRegVals));
 }
 }  // namespace Ripes
@@ -11,7 +11,7 @@ Q_NAMESPACE
 
 // =============================== Processors =================================
 // The order of the ProcessorID enum defines the order of which the processors will appear in the processor selection
-// dialog.
+// dialog. Processor IDs are stored in the settings, so new processors should be appended to the end of the enum.
 enum ProcessorID {
     RV32_SS,
     RV32_5S_NO_FW_HZ,
@@ -25,6 +25,8 @@ enum ProcessorID {
     RV64_5S_NO_FW,
     RV64_5S,
     RV64_6S_DUAL,
+    RV32_ISS,
+    RV64_ISS,
     NUM_PROCESSORS
 };
 Q_ENUM_NS(Ripes::ProcessorID);  // Register with the metaobject system
@@ -345,7 +345,12 @@ public:
         Q_UNREACHABLE();
         // clang-format on
     }
-    StageInfo stageInfo(unsigned int stage) const override {
+    /**
+     * @brief isStageValid
+     * @returns whether @p stage currently carries a valid instruction. Cheaper than stageInfo(), which also determines
+     * the state of the stage.
+     */
+    bool isStageValid(unsigned int stage) const {
         bool stageValid = true;
         // Has the pipeline stage been filled?
         stageValid &= stage <= m_cycleCount;
@@ -374,6 +379,11 @@ public:
             stageValid &= !ecallChecker->isSysCallExiting();
         }
         // clang-format on
+        return stageValid;
+    }
+
+    StageInfo stageInfo(unsigned int stage) const override {
+        const bool stageValid = isStageValid(stage);
 
         // Gather stage state info
         StageInfo::State state = StageInfo ::State::None;
@@ -430,6 +440,8 @@ public:
         ecallChecker->setSysCallExiting(ecallChecker->isSysCallExiting() || (fr & FinalizeReason::exitSyscall));
     }
     const std::vector<unsigned> breakpointTriggeringStages() const override { return {IF}; }
+    unsigned dataMemoryStage() const override { return MEM; }
+    std::optional<unsigned> ecallStage() const override { return EX; }
 
     MemoryAccess dataMemAccess() const override { return memToAccessInfo(data_mem); }
     MemoryAccess instrMemAccess() const override {
@@ -442,7 +454,7 @@ public:
         // The processor is finished when there are no more valid instructions in the pipeline
         bool allStagesInvalid = true;
         for (int stage = IF; stage < STAGECOUNT; stage++) {
-            allStagesInvalid &= !stageInfo(stage).stage_valid;
+            allStagesInvalid &= !isStageValid(stage);
             if (!allStagesInvalid)
                 break;
         }
@@ -454,6 +466,9 @@ public:
     }
 
     void clock() override {
+        if (clockMemoryStall()) {
+            return;
+        }
         // An instruction has been retired if the instruction in the WB stage is valid and the PC is within the
         // executable range of the program
         if (memwb_reg->valid_out.uValue() != 0 && isExecutableAddress(memwb_reg->pc_out.uValue())) {
@@ -464,6 +479,9 @@ public:
     }
 
     void reverse() override {
+        if (reverseMemoryStall()) {
+            return;
+        }
         if (m_syscallExitCycle != -1 && m_cycleCount == m_syscallExitCycle) {
             // We are about to undo an exit syscall instruction. In this case, the syscall exiting sequence should
             // be terminate
@@ -606,7 +606,12 @@ public:
         Q_UNREACHABLE();
         // clang-format on
     }
-    StageInfo stageInfo(unsigned int stage) const override {
+    /**
+     * @brief isStageValid
+     * @returns whether @p stage currently carries a valid instruction. Cheaper than stageInfo(), which also determines
+     * the state of the stage.
+     */
+    bool isStageValid(unsigned int stage) const {
         bool stageValid = true;
         // Has the pipeline stage been filled?
         stageValid &= (stage / 2) <= m_cycleCount;
@@ -651,6 +656,11 @@ public:
             stageValid &= !ecallChecker->isSysCallExiting();
         }
         // clang-format on
+        return stageValid;
+    }
+
+    StageInfo stageInfo(unsigned int stage) const override {
+        const bool stageValid = isStageValid(stage);
 
         // Gather stage state info
         StageInfo::State state = StageInfo ::State::None;
@@ -736,6 +746,9 @@ public:
         ecallChecker->setSysCallExiting(ecallChecker->isSysCallExiting() || (fr & FinalizeReason::exitSyscall));
     }
     const std::vector<unsigned> breakpointTriggeringStages() const override { return {IF_1, IF_2}; };
+    const std::vector<unsigned> retiringStages() const override { return {WB_EXEC, WB_DATA}; }
+    unsigned dataMemoryStage() const override { return MEM_DATA; }
+    std::optional<unsigned> ecallStage() const override { return EX_EXEC; }
 
     MemoryAccess dataMemAccess() const override { return memToAccessInfo(data_mem); }
     MemoryAccess instrMemAccess() const override {
@@ -748,7 +761,7 @@ public:
         // The processor is finished when there are no more valid instructions in the pipeline
         bool allStagesInvalid = true;
         for (int stage = IF_1; stage < STAGECOUNT; stage++) {
-            allStagesInvalid &= !stageInfo(stage).stage_valid;
+            allStagesInvalid &= !isStageValid(stage);
             if (!allStagesInvalid)
                 break;
         }
@@ -775,6 +788,9 @@ public:
     }
 
     void clock() override {
+        if (clockMemoryStall()) {
+            return;
+        }
         // An instruction has been retired if the instruction in the WB stage is valid and the PC is within the
         // executable range of the program
         m_instructionsRetired += instructionsRetired();
@@ -783,6 +799,9 @@ public:
     }
 
     void reverse() override {
+        if (reverseMemoryStall()) {
+            return;
+        }
         if (m_syscallExitCycle != -1 && m_cycleCount == m_syscallExitCycle) {
             // We are about to undo an exit syscall instruction. In this case, the syscall exiting sequence should
             // be terminate
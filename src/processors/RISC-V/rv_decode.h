@@ -1,5 +1,7 @@
 ﻿#pragma once
 
+#include <vector>
+
 #include "VSRTL/core/vsrtl_component.h"
 #include "riscv.h"
 
@@ -10,223 +12,261 @@ using namespace Ripes;
 template <unsigned XLEN>
 class Decode : public Component {
 public:
-    void setISA(const std::shared_ptr<ISAInfoBase>& isa) { m_isa = isa; }
+    void setISA(const std::shared_ptr<ISAInfoBase>& isa) {
+        m_isa = isa;
+        m_mExtEnabled = m_isa && m_isa->extensionEnabled("M");
+        // Previously decoded instructions may decode differently under the new set of extensions.
+        clearDecodeTable();
+    }
 
     Decode(std::string name, SimComponent* parent) : Component(name, parent) {
+        clearDecodeTable();
+
         opcode << [=] {
             const auto instrValue = instr.uValue();
-            const unsigned l7 = instrValue & 0b1111111;
-
-            // clang-format off
-            switch(l7) {
-            case RVISA::Opcode::LUI: return RVInstr::LUI;
-            case RVISA::Opcode::AUIPC: return RVInstr::AUIPC;
-            case RVISA::Opcode::JAL: return RVInstr::JAL;
-            case RVISA::Opcode::JALR: return RVInstr::JALR;
-            case RVISA::Opcode::ECALL: return RVInstr::ECALL;
-
-            case RVISA::Opcode::OPIMM: {
-                // I-Type
-                const auto fields = RVInstrParser::getParser()->decodeI32Instr(instrValue);
-                switch(fields[2]) {
-                case 0b000: return RVInstr::ADDI;
-                case 0b010: return RVInstr::SLTI;
-                case 0b011: return RVInstr::SLTIU;
-                case 0b100: return RVInstr::XORI;
-                case 0b110: return RVInstr::ORI;
-                case 0b111: return RVInstr::ANDI;
-                case 0b001: return RVInstr::SLLI;
-                case 0b101: {
-                    switch (instrValue >> 26) {
-                    case 0b000000: return RVInstr::SRLI;
-                    case 0b010000: return RVInstr::SRAI;
-                    }
-                }
-                default: break;
-                }
-                break;
+            auto& entry = m_decodeTable[decodeTableIndex(instrValue)];
+            if (entry.instr != instrValue) {
+                entry.instr = instrValue;
+                entry.opcode = decodeOpcode(instrValue);
             }
+            return entry.opcode;
+        };
 
-            case RVISA::Opcode::OPIMM32: {
-                // I-Type (32-bit, in 64-bit ISA)
-                const auto fields = RVInstrParser::getParser()->decodeI32Instr(instrValue);
-                switch(fields[2]) {
-                case 0b000: return RVInstr::ADDIW;
-                case 0b001: return RVInstr::SLLIW;
-                case 0b101: {
-                    switch (instrValue >> 26) {
-                    case 0b000000: return RVInstr::SRLIW;
-                    case 0b010000: return RVInstr::SRAIW;
-                    }
+        wr_reg_idx << [=] {
+            return (instr.uValue() >> 7) & 0b11111;
+        };
+
+        r1_reg_idx << [=] {
+            return (instr.uValue() >> 15) & 0b11111;
+        };
+
+        r2_reg_idx << [=] {
+            return (instr.uValue() >> 20) & 0b11111;
+        };
+    }
+
+    INPUTPORT(instr, c_RVInstrWidth);
+    OUTPUTPORT_ENUM(opcode, RVInstr);
+    OUTPUTPORT(wr_reg_idx, c_RVRegsBits);
+    OUTPUTPORT(r1_reg_idx, c_RVRegsBits);
+    OUTPUTPORT(r2_reg_idx, c_RVRegsBits);
+
+private:
+    /**
+     * @brief The decode table is a direct-mapped cache of previously decoded instruction words. Since the decoded
+     * opcode is a pure function of the instruction word (and the enabled extensions), entries are tagged by the
+     * instruction word itself and thus never become stale when memory is modified.
+     */
+    struct DecodeTableEntry {
+        VSRTL_VT_U instr;
+        VSRTL_VT_U opcode;
+    };
+    static constexpr unsigned s_decodeTableBits = 12;
+
+    static unsigned decodeTableIndex(VSRTL_VT_U instrValue) {
+        // Fibonacci hashing; the low bits of an instruction word (the opcode) are poorly distributed.
+        return (static_cast<uint32_t>(instrValue) * 2654435769u) >> (32 - s_decodeTableBits);
+    }
+
+    void clearDecodeTable() {
+        // An all-zero instruction word decodes to a NOP, so a table filled with this entry is consistent.
+        m_decodeTable.assign(1 << s_decodeTableBits, DecodeTableEntry{0, RVInstr::NOP});
+    }
+
+    VSRTL_VT_U decodeOpcode(const VSRTL_VT_U instrValue) const {
+        const unsigned l7 = instrValue & 0b1111111;
+
+        // clang-format off
+        switch(l7) {
+        case RVISA::Opcode::LUI: return RVInstr::LUI;
+        case RVISA::Opcode::AUIPC: return RVInstr::AUIPC;
+        case RVISA::Opcode::JAL: return RVInstr::JAL;
+        case RVISA::Opcode::JALR: return RVInstr::JALR;
+        case RVISA::Opcode::ECALL: return RVInstr::ECALL;
+
+        case RVISA::Opcode::OPIMM: {
+            // I-Type
+            const auto fields = RVInstrParser::getParser()->decodeI32Instr(instrValue);
+            switch(fields[2]) {
+            case 0b000: return RVInstr::ADDI;
+            case 0b010: return RVInstr::SLTI;
+            case 0b011: return RVInstr::SLTIU;
+            case 0b100: return RVInstr::XORI;
+            case 0b110: return RVInstr::ORI;
+            case 0b111: return RVInstr::ANDI;
+            case 0b001: return RVInstr::SLLI;
+            case 0b101: {
+                switch (instrValue >> 26) {
+                case 0b000000: return RVInstr::SRLI;
+                case 0b010000: return RVInstr::SRAI;
                 }
-                default: break;
+            }
+            default: break;
+            }
+            break;
+        }
+
+        case RVISA::Opcode::OPIMM32: {
+            // I-Type (32-bit, in 64-bit ISA)
+            const auto fields = RVInstrParser::getParser()->decodeI32Instr(instrValue);
+            switch(fields[2]) {
+            case 0b000: return RVInstr::ADDIW;
+            case 0b001: return RVInstr::SLLIW;
+            case 0b101: {
+                switch (instrValue >> 26) {
+                case 0b000000: return RVInstr::SRLIW;
+                case 0b010000: return RVInstr::SRAIW;
                 }
-                break;
             }
+            default: break;
+            }
+            break;
+        }
 
-            case RVISA::Opcode::OP: {
-                // R-Type
-                const auto fields = RVInstrParser::getParser()->decodeR32Instr(instrValue);
-                if (fields[0] == 0b0000001) {
-                    if(m_isa && m_isa->extensionEnabled("M")) {
-                        // RV32M Standard extension
-                        switch (fields[3]) {
-                            case 0b000: return RVInstr::MUL;
-                            case 0b001: return RVInstr::MULH;
-                            case 0b010: return RVInstr::MULHSU;
-                            case 0b011: return RVInstr::MULHU;
-                            case 0b100: return RVInstr::DIV;
-                            case 0b101: return RVInstr::DIVU;
-                            case 0b110: return RVInstr::REM;
-                            case 0b111: return RVInstr::REMU;
-                            default: break;
-                        }
-                    }
-                } else {
+        case RVISA::Opcode::OP: {
+            // R-Type
+            const auto fields = RVInstrParser::getParser()->decodeR32Instr(instrValue);
+            if (fields[0] == 0b0000001) {
+                if(m_mExtEnabled) {
+                    // RV32M Standard extension
                     switch (fields[3]) {
-                        case 0b000: {
-                            switch (fields[0]) {
-                                case 0b0000000: return RVInstr::ADD;
-                                case 0b0100000: return RVInstr::SUB;
-                                default: return RVInstr::NOP;
-                            }
-                        }
-                        case 0b001: return RVInstr::SLL;
-                        case 0b010: return RVInstr::SLT;
-                        case 0b011: return RVInstr::SLTU;
-                        case 0b100: return RVInstr::XOR;
-                        case 0b101: {
-                            switch (fields[0]) {
-                                case 0b0000000: return RVInstr::SRL;
-                                case 0b0100000: return RVInstr::SRA;
-                                default: return RVInstr::NOP;
-                            }
-                        }
-                        case 0b110: return RVInstr::OR;
-                        case 0b111: return RVInstr::AND;
+                        case 0b000: return RVInstr::MUL;
+                        case 0b001: return RVInstr::MULH;
+                        case 0b010: return RVInstr::MULHSU;
+                        case 0b011: return RVInstr::MULHU;
+                        case 0b100: return RVInstr::DIV;
+                        case 0b101: return RVInstr::DIVU;
+                        case 0b110: return RVInstr::REM;
+                        case 0b111: return RVInstr::REMU;
                         default: break;
                     }
-                    break;
                 }
-                break;
-            }
-
-            case RVISA::Opcode::OP32: {
-                // R-Type (32-bit, in 64-bit ISA)
-                const auto fields = RVInstrParser::getParser()->decodeR32Instr(instrValue);
-                if (fields[0] == 0b0000001) {
-                    if(m_isa && m_isa->extensionEnabled("M")) {
-                        // RV64M Standard extension
-                        switch (fields[3]) {
-                            case 0b000: return RVInstr::MULW;
-                            case 0b100: return RVInstr::DIVW;
-                            case 0b101: return RVInstr::DIVUW;
-                            case 0b110: return RVInstr::REMW;
-                            case 0b111: return RVInstr::REMUW;
-                            default: break;
+            } else {
+                switch (fields[3]) {
+                    case 0b000: {
+                        switch (fields[0]) {
+                            case 0b0000000: return RVInstr::ADD;
+                            case 0b0100000: return RVInstr::SUB;
+                            default: return RVInstr::NOP;
                         }
                     }
-                } else {
-                    switch (fields[3]) {
-                        case 0b000: {
-                            switch (fields[0]) {
-                                case 0b0000000: return RVInstr::ADDW;
-                                case 0b0100000: return RVInstr::SUBW;
-                                default: return RVInstr::NOP;
-                            }
-                        }
-                        case 0b001: return RVInstr::SLLW;
-                        case 0b101: {
-                            switch (fields[0]) {
-                                case 0b0000000: return RVInstr::SRLW;
-                                case 0b0100000: return RVInstr::SRAW;
-                                default: return RVInstr::NOP;
-                            }
+                    case 0b001: return RVInstr::SLL;
+                    case 0b010: return RVInstr::SLT;
+                    case 0b011: return RVInstr::SLTU;
+                    case 0b100: return RVInstr::XOR;
+                    case 0b101: {
+                        switch (fields[0]) {
+                            case 0b0000000: return RVInstr::SRL;
+                            case 0b0100000: return RVInstr::SRA;
+                            default: return RVInstr::NOP;
                         }
-                        default: break;
                     }
-                    break;
-                }
-                break;
-            }
-
-            case RVISA::Opcode::LOAD: {
-                // Load instruction
-                const auto fields = RVInstrParser::getParser()->decodeI32Instr(instrValue);
-                switch (fields[2]) {
-                    case 0b000: return RVInstr::LB;
-                    case 0b001: return RVInstr::LH;
-                    case 0b010: return RVInstr::LW;
-                    case 0b100: return RVInstr::LBU;
-                    case 0b101: return RVInstr::LHU;
-                    case 0b110: return RVInstr::LWU;
-                    case 0b011: return RVInstr::LD;
+                    case 0b110: return RVInstr::OR;
+                    case 0b111: return RVInstr::AND;
                     default: break;
                 }
                 break;
             }
+            break;
+        }
 
-            case RVISA::Opcode::STORE: {
-                // Store instructions
-                const auto fields = RVInstrParser::getParser()->decodeS32Instr(instrValue);
+        case RVISA::Opcode::OP32: {
+            // R-Type (32-bit, in 64-bit ISA)
+            const auto fields = RVInstrParser::getParser()->decodeR32Instr(instrValue);
+            if (fields[0] == 0b0000001) {
+                if(m_mExtEnabled) {
+                    // RV64M Standard extension
+                    switch (fields[3]) {
+                        case 0b000: return RVInstr::MULW;
+                        case 0b100: return RVInstr::DIVW;
+                        case 0b101: return RVInstr::DIVUW;
+                        case 0b110: return RVInstr::REMW;
+                        case 0b111: return RVInstr::REMUW;
+                        default: break;
+                    }
+                }
+            } else {
                 switch (fields[3]) {
-                    case 0b000: return RVInstr::SB;
-                    case 0b001: return RVInstr::SH;
-                    case 0b010: return RVInstr::SW;
-                    case 0b011: return RVInstr::SD;
+                    case 0b000: {
+                        switch (fields[0]) {
+                            case 0b0000000: return RVInstr::ADDW;
+                            case 0b0100000: return RVInstr::SUBW;
+                            default: return RVInstr::NOP;
+                        }
+                    }
+                    case 0b001: return RVInstr::SLLW;
+                    case 0b101: {
+                        switch (fields[0]) {
+                            case 0b0000000: return RVInstr::SRLW;
+                            case 0b0100000: return RVInstr::SRAW;
+                            default: return RVInstr::NOP;
+                        }
+                    }
                     default: break;
                 }
                 break;
             }
+            break;
+        }
 
-            case RVISA::Opcode::BRANCH: {
-                // Branch instruction
-                const auto fields = RVInstrParser::getParser()->decodeB32Instr(instrValue);
-                switch (fields[4]) {
-                    case 0b000: return RVInstr::BEQ;
-                    case 0b001: return RVInstr::BNE;
-                    case 0b100: return RVInstr::BLT;
-                    case 0b101: return RVInstr::BGE;
-                    case 0b110: return RVInstr::BLTU;
-                    case 0b111: return RVInstr::BGEU;
-                    default: break;
-                }
-                break;
+        case RVISA::Opcode::LOAD: {
+            // Load instruction
+            const auto fields = RVInstrParser::getParser()->decodeI32Instr(instrValue);
+            switch (fields[2]) {
+                case 0b000: return RVInstr::LB;
+                case 0b001: return RVInstr::LH;
+                case 0b010: return RVInstr::LW;
+                case 0b100: return RVInstr::LBU;
+                case 0b101: return RVInstr::LHU;
+                case 0b110: return RVInstr::LWU;
+                case 0b011: return RVInstr::LD;
+                default: break;
             }
+            break;
+        }
 
-
-            default:
-                break;
+        case RVISA::Opcode::STORE: {
+            // Store instructions
+            const auto fields = RVInstrParser::getParser()->decodeS32Instr(instrValue);
+            switch (fields[3]) {
+                case 0b000: return RVInstr::SB;
+                case 0b001: return RVInstr::SH;
+                case 0b010: return RVInstr::SW;
+                case 0b011: return RVInstr::SD;
+                default: break;
             }
+            break;
+        }
 
-            // Fallthrough - unknown instruction.
-            return RVInstr::NOP;
-        };
+        case RVISA::Opcode::BRANCH: {
+            // Branch instruction
+            const auto fields = RVInstrParser::getParser()->decodeB32Instr(instrValue);
+            switch (fields[4]) {
+                case 0b000: return RVInstr::BEQ;
+                case 0b001: return RVInstr::BNE;
+                case 0b100: return RVInstr::BLT;
+                case 0b101: return RVInstr::BGE;
+                case 0b110: return RVInstr::BLTU;
+                case 0b111: return RVInstr::BGEU;
+                default: break;
+            }
+            break;
+        }
 
-        wr_reg_idx << [=] {
-            return (instr.uValue() >> 7) & 0b11111;
-        };
 
-        r1_reg_idx << [=] {
-            return (instr.uValue() >> 15) & 0b11111;
-        };
-
-        r2_reg_idx << [=] {
-            return (instr.uValue() >> 20) & 0b11111;
-        };
+        default:
+            break;
+        }
 
+        // Fallthrough - unknown instruction.
+        return RVInstr::NOP;
         // clang-format on
     }
 
-    INPUTPORT(instr, c_RVInstrWidth);
-    OUTPUTPORT_ENUM(opcode, RVInstr);
-    OUTPUTPORT(wr_reg_idx, c_RVRegsBits);
-    OUTPUTPORT(r1_reg_idx, c_RVRegsBits);
-    OUTPUTPORT(r2_reg_idx, c_RVRegsBits);
-
-private:
     void unknownInstruction() {}
     std::shared_ptr<ISAInfoBase> m_isa;
+    bool m_mExtEnabled = false;
+    std::vector<DecodeTableEntry> m_decodeTable;
 };
 
 }  // namespace core
@@ -0,0 +1,574 @@
+#pragma once
+
+#include <array>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "../../interface/ripesprocessor.h"
+#include "../riscv.h"
+
+namespace Ripes {
+
+/**
+ * @brief The RVISS class
+ * Functional instruction-set simulator for RV32IM/RV64IM. Contrary to the VSRTL-based processor models, the ISS does
+ * not model any datapath; each clock cycle fetches, decodes and executes a single instruction in a tight switch-based
+ * dispatch loop. This makes the ISS suitable for quickly executing long-running programs.
+ *
+ * Decoded instructions are stored in a direct-mapped decode cache tagged by the PC and the word of the instruction. The
+ * instruction word is fetched on every lookup, such that any write to memory (self-modifying code, the memory editor,
+ * system calls or restoring a checkpoint) is observed without having to invalidate the cache.
+ *
+ * Like the single-cycle processor, the ISS has a single stage; the stage contains the instruction which will be
+ * executed in the next clock cycle, and dataMemAccess()/instrMemAccess() reflect the memory accesses which this
+ * instruction performs.
+ */
+template <typename XLEN_T>
+class RVISS : public RipesProcessor {
+    static_assert(std::is_same<uint32_t, XLEN_T>::value || std::is_same<uint64_t, XLEN_T>::value,
+                  "Only supports 32- and 64-bit variants");
+    static constexpr unsigned XLEN = sizeof(XLEN_T) * CHAR_BIT;
+    using SXLEN_T = std::make_signed_t<XLEN_T>;
+
+    static constexpr unsigned s_decodeCacheBits = 14;
+    static constexpr AInt s_invalidPC = static_cast<AInt>(-1);
+
+    struct DecodedInstr {
+        AInt pc = s_invalidPC;
+        uint32_t word = 0;
+        unsigned op = RVInstr::NOP;
+        unsigned rd = 0;
+        unsigned rs1 = 0;
+        unsigned rs2 = 0;
+        XLEN_T imm = 0;
+    };
+
+public:
+    RVISS(const QStringList& extensions) {
+        m_features = 0;
+        m_enabledISA = std::make_shared<ISAInfo<XLenToRVISA<XLEN>()>>(extensions);
+        m_mExtEnabled = m_enabledISA->extensionEnabled("M");
+        m_decodeCache.resize(1 << s_decodeCacheBits);
+        m_memory = std::make_unique<vsrtl::core::AddressSpaceMM>();
+    }
+
+    // Ripes interface compliance
+    unsigned int stageCount() const override { return 1; }
+    unsigned int getPcForStage(unsigned int) const override { return m_pc; }
+    AInt nextFetchedAddress() const override { return nextPC(decoded(m_pc)); }
+    QString stageName(unsigned int) const override { return "•"; }
+    StageInfo stageInfo(unsigned int) const override {
+        return StageInfo({m_pc, isExecutableAddress(m_pc), StageInfo::State::None});
+    }
+    void setProgramCounter(AInt address) override { m_pc = address; }
+    void setPCInitialValue(AInt address) override { m_pcInitialValue = address; }
+    vsrtl::core::AddressSpaceMM& getMemory() override { return *m_memory; }
+    VInt getRegister(RegisterFileType, unsigned i) const override { return m_regs.at(i); }
+    void setRegister(RegisterFileType, unsigned i, VInt v) override {
+        if (i != 0) {
+            m_regs.at(i) = v;
+        }
+    }
+    void finalize(FinalizeReason fr) override {
+        if (fr == FinalizeReason::exitSyscall) {
+            // The exit system call is handled within the clock cycle which executes the ecall; no instructions remain
+            // to be cleared.
+            m_finished = true;
+        }
+    }
+    bool finished() const override { return m_finished || !stageInfo(0).stage_valid; }
+    const std::vector<unsigned> breakpointTriggeringStages() const override { return {0}; }
+
+    MemoryAccess dataMemAccess() const override {
+        MemoryAccess access;
+        const DecodedInstr& instr = decoded(m_pc);
+        access.address = static_cast<XLEN_T>(m_regs[instr.rs1] + instr.imm);
+        access.bytes = accessBytes(instr.op);
+        access.type = isLoad(instr.op)    ? MemoryAccess::Read
+                      : isStore(instr.op) ? MemoryAccess::Write
+                                          : MemoryAccess::None;
+        return access;
+    }
+    MemoryAccess instrMemAccess() const override {
+        MemoryAccess access;
+        access.type = MemoryAccess::Read;
+        access.address = m_pc;
+        access.bytes = c_RVInstrWidth / CHAR_BIT;
+        return access;
+    }
+
+    void resetProcessor() override {
+        m_memory->reset();
+        m_regs.fill(0);
+        m_pc = m_pcInitialValue;
+        m_cycleCount = 0;
+        m_instructionsRetired = 0;
+        m_finished = false;
+        if (m_emitsSignals) {
+            processorWasReset.Emit();
+        }
+    }
+
+    void clockProcessor() override {
+        execute(decoded(m_pc));
+        m_cycleCount++;
+        m_instructionsRetired++;
+        if (m_emitsSignals) {
+            processorWasClocked.Emit();
+        }
+    }
+
+    long long getInstructionsRetired() const override { return m_instructionsRetired; }
+    long long getCycleCount() const override { return m_cycleCount; }
+    void restoreCounters(long long cycleCount, long long instructionsRetired) override {
+        m_cycleCount = cycleCount;
+        m_instructionsRetired = instructionsRetired;
+    }
+
+    static const ISAInfoBase* supportsISA() {
+        static auto s_isa = ISAInfo<XLenToRVISA<XLEN>()>(QStringList{"M"});
+        return &s_isa;
+    }
+    const ISAInfoBase* implementsISA() const override { return m_enabledISA.get(); }
+    const std::set<RegisterFileType> registerFiles() const override {
+        std::set<RegisterFileType> rfs;
+        rfs.insert(RegisterFileType::GPR);
+        return rfs;
+    }
+
+private:
+    // clang-format off
+    static bool isLoad(unsigned op) {
+        switch (op) {
+            case RVInstr::LB: case RVInstr::LH: case RVInstr::LW: case RVInstr::LBU:
+            case RVInstr::LHU: case RVInstr::LWU: case RVInstr::LD:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static bool isStore(unsigned op) {
+        switch (op) {
+            case RVInstr::SB: case RVInstr::SH: case RVInstr::SW: case RVInstr::SD:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static unsigned accessBytes(unsigned op) {
+        switch (op) {
+            case RVInstr::LB: case RVInstr::LBU: case RVInstr::SB: return 1;
+            case RVInstr::LH: case RVInstr::LHU: case RVInstr::SH: return 2;
+            case RVInstr::LW: case RVInstr::LWU: case RVInstr::SW: return 4;
+            case RVInstr::LD: case RVInstr::SD: return 8;
+            default: return 0;
+        }
+    }
+    // clang-format on
+
+    static XLEN_T sext32(uint64_t v) { return static_cast<XLEN_T>(static_cast<int64_t>(static_cast<int32_t>(v))); }
+
+    /**
+     * @brief mulhu
+     * Upper XLEN bits of the unsigned 2*XLEN-bit product of @p a and @p b.
+     */
+    static XLEN_T mulhu(XLEN_T a, XLEN_T b) {
+        if constexpr (XLEN == 32) {
+            return static_cast<XLEN_T>((static_cast<uint64_t>(a) * static_cast<uint64_t>(b)) >> 32);
+        } else {
+            const uint64_t aLo = a & 0xFFFFFFFF, aHi = a >> 32;
+            const uint64_t bLo = b & 0xFFFFFFFF, bHi = b >> 32;
+            const uint64_t p0 = aLo * bLo, p1 = aLo * bHi, p2 = aHi * bLo, p3 = aHi * bHi;
+            const uint64_t mid = (p0 >> 32) + (p1 & 0xFFFFFFFF) + (p2 & 0xFFFFFFFF);
+            return p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+        }
+    }
+    static XLEN_T mulh(XLEN_T a, XLEN_T b) {
+        XLEN_T res = mulhu(a, b);
+        res -= static_cast<SXLEN_T>(a) < 0 ? b : 0;
+        res -= static_cast<SXLEN_T>(b) < 0 ? a : 0;
+        return res;
+    }
+    static XLEN_T mulhsu(XLEN_T a, XLEN_T b) { return mulhu(a, b) - (static_cast<SXLEN_T>(a) < 0 ? b : 0); }
+
+    template <typename T>
+    static T div(T a, T b) {
+        using ST = std::make_signed_t<T>;
+        if (b == 0) {
+            return static_cast<T>(-1);
+        } else if (static_cast<ST>(a) == std::numeric_limits<ST>::min() && static_cast<ST>(b) == -1) {
+            return a;
+        }
+        return static_cast<T>(static_cast<ST>(a) / static_cast<ST>(b));
+    }
+    template <typename T>
+    static T rem(T a, T b) {
+        using ST = std::make_signed_t<T>;
+        if (b == 0) {
+            return a;
+        } else if (static_cast<ST>(a) == std::numeric_limits<ST>::min() && static_cast<ST>(b) == -1) {
+            return 0;
+        }
+        return static_cast<T>(static_cast<ST>(a) % static_cast<ST>(b));
+    }
+    template <typename T>
+    static T divu(T a, T b) {
+        return b == 0 ? static_cast<T>(-1) : a / b;
+    }
+    template <typename T>
+    static T remu(T a, T b) {
+        return b == 0 ? a : a % b;
+    }
+
+    /**
+     * @brief decode
+     * Decodes the instruction word @p instr. Unknown instructions, or instructions from extensions which are not
+     * enabled, decode to a NOP.
+     */
+    DecodedInstr decode(uint32_t instr) const {
+        DecodedInstr d;
+        d.rd = (instr >> 7) & 0b11111;
+        d.rs1 = (instr >> 15) & 0b11111;
+        d.rs2 = (instr >> 20) & 0b11111;
+        const unsigned funct3 = (instr >> 12) & 0b111;
+        const unsigned funct7 = instr >> 25;
+        const unsigned funct6 = instr >> 26;
+
+        // Sign-extended immediates for each instruction format
+        const int32_t immI = static_cast<int32_t>(instr) >> 20;
+        const int32_t immS = (static_cast<int32_t>(instr & 0xFE000000) >> 20) | ((instr >> 7) & 0x1F);
+        const int32_t immB = (static_cast<int32_t>(instr & 0x80000000) >> 19) | ((instr & 0x80) << 4) |
+                             ((instr >> 20) & 0x7E0) | ((instr >> 7) & 0x1E);
+        const int32_t immU = static_cast<int32_t>(instr & 0xFFFFF000);
+        const int32_t immJ = (static_cast<int32_t>(instr & 0x80000000) >> 11) | (instr & 0xFF000) |
+                             ((instr >> 9) & 0x800) | ((instr >> 20) & 0x7FE);
+        auto setImm = [&](int32_t imm) { d.imm = static_cast<XLEN_T>(static_cast<int64_t>(imm)); };
+        auto setOp = [&](unsigned op) { d.op = op; };
+
+        // clang-format off
+        switch (instr & 0b1111111) {
+        case RVISA::Opcode::LUI: setOp(RVInstr::LUI); setImm(immU); break;
+        case RVISA::Opcode::AUIPC: setOp(RVInstr::AUIPC); setImm(immU); break;
+        case RVISA::Opcode::JAL: setOp(RVInstr::JAL); setImm(immJ); break;
+        case RVISA::Opcode::JALR: setOp(RVInstr::JALR); setImm(immI); break;
+        case RVISA::Opcode::ECALL: if (instr == 0b1110011) setOp(RVInstr::ECALL); break;
+        case RVISA::Opcode::BRANCH: {
+            setImm(immB);
+            switch (funct3) {
+                case 0b000: setOp(RVInstr::BEQ); break;
+                case 0b001: setOp(RVInstr::BNE); break;
+                case 0b100: setOp(RVInstr::BLT); break;
+                case 0b101: setOp(RVInstr::BGE); break;
+                case 0b110: setOp(RVInstr::BLTU); break;
+                case 0b111: setOp(RVInstr::BGEU); break;
+                default: break;
+            }
+            break;
+        }
+        case RVISA::Opcode::LOAD: {
+            setImm(immI);
+            switch (funct3) {
+                case 0b000: setOp(RVInstr::LB); break;
+                case 0b001: setOp(RVInstr::LH); break;
+                case 0b010: setOp(RVInstr::LW); break;
+                case 0b100: setOp(RVInstr::LBU); break;
+                case 0b101: setOp(RVInstr::LHU); break;
+                case 0b110: if (XLEN == 64) setOp(RVInstr::LWU); break;
+                case 0b011: if (XLEN == 64) setOp(RVInstr::LD); break;
+                default: break;
+            }
+            break;
+        }
+        case RVISA::Opcode::STORE: {
+            setImm(immS);
+            switch (funct3) {
+                case 0b000: setOp(RVInstr::SB); break;
+                case 0b001: setOp(RVInstr::SH); break;
+                case 0b010: setOp(RVInstr::SW); break;
+                case 0b011: if (XLEN == 64) setOp(RVInstr::SD); break;
+                default: break;
+            }
+            break;
+        }
+        case RVISA::Opcode::OPIMM: {
+            setImm(immI);
+            switch (funct3) {
+                case 0b000: setOp(RVInstr::ADDI); break;
+                case 0b010: setOp(RVInstr::SLTI); break;
+                case 0b011: setOp(RVInstr::SLTIU); break;
+                case 0b100: setOp(RVInstr::XORI); break;
+                case 0b110: setOp(RVInstr::ORI); break;
+                case 0b111: setOp(RVInstr::ANDI); break;
+                case 0b001: setOp(RVInstr::SLLI); break;
+                case 0b101: {
+                    switch (funct6) {
+                        case 0b000000: setOp(RVInstr::SRLI); break;
+                        case 0b010000: setOp(RVInstr::SRAI); break;
+                        default: break;
+                    }
+                    break;
+                }
+                default: break;
+            }
+            break;
+        }
+        case RVISA::Opcode::OP: {
+            if (funct7 == 0b0000001) {
+                if (!m_mExtEnabled) break;
+                switch (funct3) {
+                    case 0b000: setOp(RVInstr::MUL); break;
+                    case 0b001: setOp(RVInstr::MULH); break;
+                    case 0b010: setOp(RVInstr::MULHSU); break;
+                    case 0b011: setOp(RVInstr::MULHU); break;
+                    case 0b100: setOp(RVInstr::DIV); break;
+                    case 0b101: setOp(RVInstr::DIVU); break;
+                    case 0b110: setOp(RVInstr::REM); break;
+                    case 0b111: setOp(RVInstr::REMU); break;
+                    default: break;
+                }
+            } else if (funct7 == 0b0000000) {
+                switch (funct3) {
+                    case 0b000: setOp(RVInstr::ADD); break;
+                    case 0b001: setOp(RVInstr::SLL); break;
+                    case 0b010: setOp(RVInstr::SLT); break;
+                    case 0b011: setOp(RVInstr::SLTU); break;
+                    case 0b100: setOp(RVInstr::XOR); break;
+                    case 0b101: setOp(RVInstr::SRL); break;
+                    case 0b110: setOp(RVInstr::OR); break;
+                    case 0b111: setOp(RVInstr::AND); break;
+                    default: break;
+                }
+            } else if (funct7 == 0b0100000) {
+                switch (funct3) {
+                    case 0b000: setOp(RVInstr::SUB); break;
+                    case 0b101: setOp(RVInstr::SRA); break;
+                    default: break;
+                }
+            }
+            break;
+        }
+        case RVISA::Opcode::OPIMM32: {
+            if (XLEN != 64) break;
+            setImm(immI);
+            switch (funct3) {
+                case 0b000: setOp(RVInstr::ADDIW); break;
+                case 0b001: setOp(RVInstr::SLLIW); break;
+                case 0b101: {
+                    switch (funct7) {
+                        case 0b0000000: setOp(RVInstr::SRLIW); break;
+                        case 0b0100000: setOp(RVInstr::SRAIW); break;
+                        default: break;
+                    }
+                    break;
+                }
+                default: break;
+            }
+            break;
+        }
+        case RVISA::Opcode::OP32: {
+            if (XLEN != 64) break;
+            if (funct7 == 0b0000001) {
+                if (!m_mExtEnabled) break;
+                switch (funct3) {
+                    case 0b000: setOp(RVInstr::MULW); break;
+                    case 0b100: setOp(RVInstr::DIVW); break;
+                    case 0b101: setOp(RVInstr::DIVUW); break;
+                    case 0b110: setOp(RVInstr::REMW); break;
+                    case 0b111: setOp(RVInstr::REMUW); break;
+                    default: break;
+                }
+            } else if (funct7 == 0b0000000) {
+                switch (funct3) {
+                    case 0b000: setOp(RVInstr::ADDW); break;
+                    case 0b001: setOp(RVInstr::SLLW); break;
+                    case 0b101: setOp(RVInstr::SRLW); break;
+                    default: break;
+                }
+            } else if (funct7 == 0b0100000) {
+                switch (funct3) {
+                    case 0b000: setOp(RVInstr::SUBW); break;
+                    case 0b101: setOp(RVInstr::SRAW); break;
+                    default: break;
+                }
+            }
+            break;
+        }
+        default:
+            break;
+        }
+        // clang-format on
+        return d;
+    }
+
+    /**
+     * @brief decoded
+     * @returns the decoded instruction at @p pc, decoding and caching the instruction if it is not present in the
+     * decode cache.
+     */
+    const DecodedInstr& decoded(AInt pc) const {
+        DecodedInstr& entry = m_decodeCache[(pc >> 2) & ((1 << s_decodeCacheBits) - 1)];
+        const auto word = static_cast<uint32_t>(m_memory->readMemConst(pc, c_RVInstrWidth / CHAR_BIT));
+        if (entry.pc != pc || entry.word != word) {
+            entry = decode(word);
+            entry.pc = pc;
+            entry.word = word;
+        }
+        return entry;
+    }
+
+    AInt nextPC(const DecodedInstr& i) const {
+        const XLEN_T r1 = m_regs[i.rs1];
+        const XLEN_T r2 = m_regs[i.rs2];
+        bool taken = false;
+        switch (i.op) {
+            case RVInstr::JAL:
+                return static_cast<XLEN_T>(m_pc + i.imm);
+            case RVInstr::JALR:
+                return static_cast<XLEN_T>(r1 + i.imm) & ~XLEN_T(1);
+            case RVInstr::BEQ:
+                taken = r1 == r2;
+                break;
+            case RVInstr::BNE:
+                taken = r1 != r2;
+                break;
+            case RVInstr::BLT:
+                taken = static_cast<SXLEN_T>(r1) < static_cast<SXLEN_T>(r2);
+                break;
+            case RVInstr::BGE:
+                taken = static_cast<SXLEN_T>(r1) >= static_cast<SXLEN_T>(r2);
+                break;
+            case RVInstr::BLTU:
+                taken = r1 < r2;
+                break;
+            case RVInstr::BGEU:
+                taken = r1 >= r2;
+                break;
+            default:
+                break;
+        }
+        return static_cast<XLEN_T>(taken ? m_pc + i.imm : m_pc + 4);
+    }
+
+    void store(AInt address, XLEN_T value, unsigned bytes) {
+        m_memory->writeMem(address, value, bytes);
+    }
+
+    void execute(const DecodedInstr& i) {
+        const XLEN_T r1 = m_regs[i.rs1];
+        const XLEN_T r2 = m_regs[i.rs2];
+        const XLEN_T pc = static_cast<XLEN_T>(m_pc);
+        const unsigned shamtMask = XLEN - 1;
+        XLEN_T newPC = pc + 4;
+        XLEN_T res = 0;
+        bool writeRes = true;
+
+        // clang-format off
+        switch (i.op) {
+        case RVInstr::LUI: res = i.imm; break;
+        case RVInstr::AUIPC: res = pc + i.imm; break;
+        case RVInstr::JAL: res = pc + 4; newPC = pc + i.imm; break;
+        case RVInstr::JALR: res = pc + 4; newPC = (r1 + i.imm) & ~XLEN_T(1); break;
+
+        case RVInstr::BEQ: writeRes = false; if (r1 == r2) newPC = pc + i.imm; break;
+        case RVInstr::BNE: writeRes = false; if (r1 != r2) newPC = pc + i.imm; break;
+        case RVInstr::BLT: writeRes = false; if (static_cast<SXLEN_T>(r1) < static_cast<SXLEN_T>(r2)) newPC = pc + i.imm; break;
+        case RVInstr::BGE: writeRes = false; if (static_cast<SXLEN_T>(r1) >= static_cast<SXLEN_T>(r2)) newPC = pc + i.imm; break;
+        case RVInstr::BLTU: writeRes = false; if (r1 < r2) newPC = pc + i.imm; break;
+        case RVInstr::BGEU: writeRes = false; if (r1 >= r2) newPC = pc + i.imm; break;
+
+        case RVInstr::LB: res = static_cast<XLEN_T>(static_cast<int8_t>(m_memory->readMem(r1 + i.imm, 1))); break;
+        case RVInstr::LH: res = static_cast<XLEN_T>(static_cast<int16_t>(m_memory->readMem(r1 + i.imm, 2))); break;
+        case RVInstr::LW: res = sext32(m_memory->readMem(r1 + i.imm, 4)); break;
+        case RVInstr::LBU: res = static_cast<XLEN_T>(m_memory->readMem(r1 + i.imm, 1) & 0xFF); break;
+        case RVInstr::LHU: res = static_cast<XLEN_T>(m_memory->readMem(r1 + i.imm, 2) & 0xFFFF); break;
+        case RVInstr::LWU: res = static_cast<XLEN_T>(m_memory->readMem(r1 + i.imm, 4) & 0xFFFFFFFF); break;
+        case RVInstr::LD: res = static_cast<XLEN_T>(m_memory->readMem(r1 + i.imm, 8)); break;
+
+        case RVInstr::SB: writeRes = false; store(r1 + i.imm, r2, 1); break;
+        case RVInstr::SH: writeRes = false; store(r1 + i.imm, r2, 2); break;
+        case RVInstr::SW: writeRes = false; store(r1 + i.imm, r2, 4); break;
+        case RVInstr::SD: writeRes = false; store(r1 + i.imm, r2, 8); break;
+
+        case RVInstr::ADDI: res = r1 + i.imm; break;
+        case RVInstr::SLTI: res = static_cast<SXLEN_T>(r1) < static_cast<SXLEN_T>(i.imm); break;
+        case RVInstr::SLTIU: res = r1 < i.imm; break;
+        case RVInstr::XORI: res = r1 ^ i.imm; break;
+        case RVInstr::ORI: res = r1 | i.imm; break;
+        case RVInstr::ANDI: res = r1 & i.imm; break;
+        case RVInstr::SLLI: res = r1 << (i.imm & shamtMask); break;
+        case RVInstr::SRLI: res = r1 >> (i.imm & shamtMask); break;
+        case RVInstr::SRAI: res = static_cast<XLEN_T>(static_cast<SXLEN_T>(r1) >> (i.imm & shamtMask)); break;
+
+        case RVInstr::ADD: res = r1 + r2; break;
+        case RVInstr::SUB: res = r1 - r2; break;
+        case RVInstr::SLL: res = r1 << (r2 & shamtMask); break;
+        case RVInstr::SLT: res = static_cast<SXLEN_T>(r1) < static_cast<SXLEN_T>(r2); break;
+        case RVInstr::SLTU: res = r1 < r2; break;
+        case RVInstr::XOR: res = r1 ^ r2; break;
+        case RVInstr::SRL: res = r1 >> (r2 & shamtMask); break;
+        case RVInstr::SRA: res = static_cast<XLEN_T>(static_cast<SXLEN_T>(r1) >> (r2 & shamtMask)); break;
+        case RVInstr::OR: res = r1 | r2; break;
+        case RVInstr::AND: res = r1 & r2; break;
+
+        case RVInstr::MUL: res = r1 * r2; break;
+        case RVInstr::MULH: res = mulh(r1, r2); break;
+        case RVInstr::MULHSU: res = mulhsu(r1, r2); break;
+        case RVInstr::MULHU: res = mulhu(r1, r2); break;
+        case RVInstr::DIV: res = div(r1, r2); break;
+        case RVInstr::DIVU: res = divu(r1, r2); break;
+        case RVInstr::REM: res = rem(r1, r2); break;
+        case RVInstr::REMU: res = remu(r1, r2); break;
+
+        case RVInstr::ADDIW: res = sext32(r1 + i.imm); break;
+        case RVInstr::SLLIW: res = sext32(static_cast<uint32_t>(r1) << (i.imm & 0x1F)); break;
+        case RVInstr::SRLIW: res = sext32(static_cast<uint32_t>(r1) >> (i.imm & 0x1F)); break;
+        case RVInstr::SRAIW: res = sext32(static_cast<int32_t>(r1) >> (i.imm & 0x1F)); break;
+        case RVInstr::ADDW: res = sext32(r1 + r2); break;
+        case RVInstr::SUBW: res = sext32(r1 - r2); break;
+        case RVInstr::SLLW: res = sext32(static_cast<uint32_t>(r1) << (r2 & 0x1F)); break;
+        case RVInstr::SRLW: res = sext32(static_cast<uint32_t>(r1) >> (r2 & 0x1F)); break;
+        case RVInstr::SRAW: res = sext32(static_cast<int32_t>(r1) >> (r2 & 0x1F)); break;
+
+        case RVInstr::MULW: res = sext32(static_cast<uint32_t>(r1) * static_cast<uint32_t>(r2)); break;
+        case RVInstr::DIVW: res = sext32(div<uint32_t>(r1, r2)); break;
+        case RVInstr::DIVUW: res = sext32(divu<uint32_t>(r1, r2)); break;
+        case RVInstr::REMW: res = sext32(rem<uint32_t>(r1, r2)); break;
+        case RVInstr::REMUW: res = sext32(remu<uint32_t>(r1, r2)); break;
+
+        case RVInstr::ECALL:
+            writeRes = false;
+            if (trapHandler) {
+                trapHandler();
+            }
+            break;
+
+        default:
+            // NOP or unknown instruction
+            writeRes = false;
+            break;
+        }
+        // clang-format on
+
+        if (writeRes && i.rd != 0) {
+            m_regs[i.rd] = res;
+        }
+        m_pc = newPC;
+    }
+
+    std::unique_ptr<vsrtl::core::AddressSpaceMM> m_memory;
+    std::array<XLEN_T, c_RVRegs> m_regs{};
+    AInt m_pc = 0;
+    AInt m_pcInitialValue = 0;
+    long long m_cycleCount = 0;
+    long long m_instructionsRetired = 0;
+    bool m_finished = false;
+    bool m_mExtEnabled = false;
+    mutable std::vector<DecodedInstr> m_decodeCache;
+    std::shared_ptr<ISAInfoBase> m_enabledISA;
+};
+
+}  // namespace Ripes
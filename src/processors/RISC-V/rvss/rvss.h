@@ -175,6 +175,7 @@ public:
     }
     bool finished() const override { return m_finished || !stageInfo(0).stage_valid; }
     const std::vector<unsigned> breakpointTriggeringStages() const override { return {0}; }
+    std::optional<unsigned> ecallStage() const override { return 0; }
 
     MemoryAccess dataMemAccess() const override { return memToAccessInfo(data_mem); }
     MemoryAccess instrMemAccess() const override {
@@ -188,6 +189,9 @@ public:
     }
 
     void clock() override {
+        if (clockMemoryStall()) {
+            return;
+        }
         // Single cycle processor; 1 instruction retired per cycle!
         m_instructionsRetired++;
 
@@ -201,6 +205,9 @@ public:
     }
 
     void reverse() override {
+        if (reverseMemoryStall()) {
+            return;
+        }
         m_instructionsRetired--;
         Design::reverse();
         // Ensure that reverses performed when we expected to finish in the following cycle, clears this expectation.
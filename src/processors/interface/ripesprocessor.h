@@ -3,6 +3,7 @@
 #include <QString>
 
 #include <map>
+#include <optional>
 #include "Signals/Signal.h"
 #include "VSRTL/core/vsrtl_design.h"
 
@@ -66,7 +67,12 @@ public:
      * @brief The Features struct
      * The set of optional features implemented by this processor
      */
-    enum Features { isReversible = 0b1, hasICacheInterface = 0b10, hasDCacheInterface = 0b100 };
+    enum Features {
+        isReversible = 0b1,
+        hasICacheInterface = 0b10,
+        hasDCacheInterface = 0b100,
+        hasMemoryTiming = 0b1000
+    };
 
     unsigned features() const { return m_features; }
 
@@ -129,6 +135,26 @@ public:
      */
     virtual const std::vector<unsigned> breakpointTriggeringStages() const = 0;
 
+    /**
+     * @brief retiringStages
+     * @returns the stage indices from which the valid instructions are retired when the processor is clocked.
+     */
+    virtual const std::vector<unsigned> retiringStages() const { return {stageCount() - 1}; }
+
+    /**
+     * @brief dataMemoryStage
+     * @returns the index of the stage which performs the data memory access reported by dataMemAccess().
+     */
+    virtual unsigned dataMemoryStage() const { return stageCount() - 1; }
+
+    /**
+     * @brief ecallStage
+     * @returns the index of the stage in which system calls are executed as the processor propagates after being
+     * clocked. A system call instruction in this or a later stage has (unless stalled) been executed, but not yet
+     * retired. Processors which execute system calls whilst being clocked return no stage.
+     */
+    virtual std::optional<unsigned> ecallStage() const { return {}; }
+
     /**
      * @brief getMemory
      * @return reference to the address space utilized by the implementing processor
@@ -213,6 +239,13 @@ public:
      */
     virtual long long getCycleCount() const = 0;
 
+    /**
+     * @brief restoreCounters
+     * Sets the cycle- and retired instruction counters of the processor. Used when restoring a checkpoint onto a
+     * processor which has just been reset.
+     */
+    virtual void restoreCounters(long long cycleCount, long long instructionsRetired) = 0;
+
     /** ======================= Signals and callbacks ======================= */
     /**
      * @brief clocked, reversed & reset signals
@@ -252,6 +285,30 @@ public:
      */
     virtual void setMaxReverseCycles(unsigned cycles) { Q_UNUSED(cycles); }
 
+    /** ====================== FEATURE: Memory timing ======================= */
+    // Enabled by setting m_features.hasMemoryTiming = true
+
+    /**
+     * @brief stallForMemory
+     * Called by the cache simulator when the memory accesses of the current cycle take @p cycles cycles longer than a
+     * single cycle to complete. The memory system is blocking; the processor shall not advance during the following
+     * @p cycles clock cycles, which are still counted.
+     */
+    virtual void stallForMemory(unsigned cycles) { Q_UNUSED(cycles); }
+
+    /**
+     * @brief isStalledForMemory
+     * @returns true if the processor did not advance in the latest clock cycle, due to waiting for memory. The accesses
+     * reported by dataMemAccess()/instrMemAccess() have then already been serviced.
+     */
+    virtual bool isStalledForMemory() const { return false; }
+
+    /**
+     * @brief memoryStallCycles
+     * @returns the number of following clock cycles in which the processor will be stalled waiting for memory.
+     */
+    virtual unsigned memoryStallCycles() const { return 0; }
+
     /** ======================================================================*/
 
 protected:
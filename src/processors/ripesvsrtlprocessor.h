@@ -4,6 +4,9 @@
  * Interface for all VSRTL-based Ripes processors
  */
 
+#include <algorithm>
+#include <deque>
+
 #include "RISC-V/riscv.h"
 #include "VSRTL/core/vsrtl_design.h"
 #include "interface/ripesprocessor.h"
@@ -14,7 +17,8 @@ class RipesVSRTLProcessor : public RipesProcessor, public vsrtl::core::Design {
 public:
     RipesVSRTLProcessor(std::string name) : Design(name) {
         // VSRTL provides reversible simulation
-        m_features = {Features::isReversible | Features::hasDCacheInterface | Features::hasICacheInterface};
+        m_features = {Features::isReversible | Features::hasDCacheInterface | Features::hasICacheInterface |
+                      Features::hasMemoryTiming};
 
         // Shim signal emissions from VSRTL to RipesProcessor
         designWasClocked.Connect(&processorWasClocked, &Gallant::Signal0<>::Emit);
@@ -24,6 +28,10 @@ public:
 
     virtual void resetProcessor() override {
         m_instructionsRetired = 0;
+        m_memoryStallCycles = 0;
+        m_stalledForMemory = false;
+        m_memoryStallHistory.clear();
+        m_memoryStallHistoryClocks = 0;
         reset();
     }
 
@@ -32,8 +40,16 @@ public:
 
     long long getInstructionsRetired() const override { return m_instructionsRetired; }
     long long getCycleCount() const override { return m_cycleCount; }
+    void restoreCounters(long long cycleCount, long long instructionsRetired) override {
+        m_cycleCount = cycleCount;
+        m_instructionsRetired = instructionsRetired;
+    }
     void setMaxReverseCycles(unsigned cycles) override { setReverseStackSize(cycles); }
 
+    void stallForMemory(unsigned cycles) override { m_memoryStallCycles = std::max(m_memoryStallCycles, cycles); }
+    bool isStalledForMemory() const override { return m_stalledForMemory; }
+    unsigned memoryStallCycles() const override { return m_memoryStallCycles; }
+
     void postConstruct() override {
         /**
          * VSRTL designs must call verifyAndInitialize after being constructed.
@@ -42,6 +58,55 @@ public:
     }
 
 protected:
+    /**
+     * @brief clockMemoryStall
+     * Must be called by the processor at the start of clock(). If the processor is stalled waiting for memory, the
+     * entire pipeline is held; the cycle is counted without clocking the design, and true is returned.
+     */
+    bool clockMemoryStall() {
+        const bool stall = m_memoryStallCycles != 0;
+        m_memoryStallHistory.push_front({m_memoryStallCycles, m_stalledForMemory, stall});
+        if (!stall) {
+            // The history must cover all clock cycles of the design which may be reversed, alongside the stalled cycles
+            // in between these.
+            m_memoryStallHistoryClocks++;
+            while (m_memoryStallHistoryClocks > vsrtl::core::ClockedComponent::reverseStackSize()) {
+                m_memoryStallHistoryClocks -= m_memoryStallHistory.back().stalled ? 0 : 1;
+                m_memoryStallHistory.pop_back();
+            }
+        }
+
+        m_stalledForMemory = stall;
+        if (stall) {
+            m_memoryStallCycles--;
+            m_cycleCount++;
+            designWasClocked.Emit();
+        }
+        return stall;
+    }
+
+    /**
+     * @brief reverseMemoryStall
+     * Must be called by the processor at the start of reverse(). Returns true if the reversed cycle was a cycle stalled
+     * waiting for memory, in which case the design shall not be reversed.
+     */
+    bool reverseMemoryStall() {
+        if (m_memoryStallHistory.empty()) {
+            return false;
+        }
+        const auto entry = m_memoryStallHistory.front();
+        m_memoryStallHistory.pop_front();
+        m_memoryStallCycles = entry.stallCycles;
+        m_stalledForMemory = entry.stalledForMemory;
+        if (entry.stalled) {
+            m_cycleCount--;
+            designWasReversed.Emit();
+        } else {
+            m_memoryStallHistoryClocks--;
+        }
+        return entry.stalled;
+    }
+
     MemoryAccess memToAccessInfo(const vsrtl::core::BaseMemory<true>* memory) const {
         MemoryAccess access;
         switch (memory->opSig()) {
@@ -102,6 +167,19 @@ protected:
     // m_instructionsRetired should be modified by the processor when it retires (or "un-retires", while reversing)
     // an instruction
     long long m_instructionsRetired = 0;
+
+private:
+    struct MemoryStallEntry {
+        // State prior to the cycle
+        unsigned stallCycles;
+        bool stalledForMemory;
+        // Whether the cycle itself was stalled
+        bool stalled;
+    };
+    unsigned m_memoryStallCycles = 0;
+    bool m_stalledForMemory = false;
+    std::deque<MemoryStallEntry> m_memoryStallHistory;
+    unsigned m_memoryStallHistoryClocks = 0;
 };
 
 }  // namespace Ripes
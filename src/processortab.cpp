@@ -15,6 +15,7 @@
 #include "processorhandler.h"
 #include "processorregistry.h"
 #include "processorselectiondialog.h"
+#include "profilerwidget.h"
 #include "registercontainerwidget.h"
 #include "registermodel.h"
 #include "ripessettings.h"
@@ -96,7 +97,7 @@ ProcessorTab::ProcessorTab(QToolBar* controlToolbar, QToolBar* additionalToolbar
     connect(ProcessorHandler::get(), &ProcessorHandler::procStateChangedNonRun, this,
             &ProcessorTab::updateInstructionLabels);
     connect(ProcessorHandler::get(), &ProcessorHandler::procStateChangedNonRun, this,
-            [=] { m_reverseAction->setEnabled(m_vsrtlWidget->isReversible()); });
+            [=] { m_reverseAction->setEnabled(ProcessorHandler::canReverse()); });
 
     setupSimulatorActions(controlToolbar);
 
@@ -114,7 +115,7 @@ ProcessorTab::ProcessorTab(QToolBar* controlToolbar, QToolBar* additionalToolbar
 
     // Connect changes in VSRTL reversible stack size to checking whether the simulator is reversible
     connect(RipesSettings::getObserver(RIPES_SETTING_REWINDSTACKSIZE), &SettingObserver::modified,
-            [=](const auto&) { m_reverseAction->setEnabled(m_vsrtlWidget->isReversible()); });
+            [=](const auto&) { m_reverseAction->setEnabled(ProcessorHandler::canReverse()); });
 
     // Connect the global reset request signal to reset()
     connect(ProcessorHandler::get(), &ProcessorHandler::processorReset, this, &ProcessorTab::reset);
@@ -142,7 +143,7 @@ ProcessorTab::ProcessorTab(QToolBar* controlToolbar, QToolBar* additionalToolbar
 }
 
 void ProcessorTab::printToLog(const QString& text) {
-    m_ui->console->putData(text.toUtf8());
+    m_ui->console->print(text);
 }
 
 void ProcessorTab::loadLayout(const Layout& layout) {
@@ -259,6 +260,25 @@ void ProcessorTab::setupSimulatorActions(QToolBar* controlToolbar) {
     connect(m_pipelineDiagramAction, &QAction::triggered, this, &ProcessorTab::showPipelineDiagram);
     m_toolbar->addAction(m_pipelineDiagramAction);
 
+    const QIcon profileIcon = QIcon(":/icons/graph.svg");
+    m_profileAction = new QAction(profileIcon, "Profile execution", this);
+    m_profileAction->setCheckable(true);
+    m_profileAction->setToolTip(
+        "Profile execution.\nRecords the executions, cycles, stalls and cache misses of each instruction, also while "
+        "running.\nThe profile is cleared when the processor is reset.");
+    m_profileAction->setChecked(RipesSettings::value(RIPES_SETTING_PROFILER_ENABLED).toBool());
+    connect(m_profileAction, &QAction::toggled, this, [=](bool checked) {
+        RipesSettings::setValue(RIPES_SETTING_PROFILER_ENABLED, QVariant::fromValue(checked));
+        m_profileReportAction->setEnabled(checked);
+    });
+    m_toolbar->addAction(m_profileAction);
+
+    const QIcon profileReportIcon = QIcon(":/icons/analytics.svg");
+    m_profileReportAction = new QAction(profileReportIcon, "Show execution profile", this);
+    m_profileReportAction->setEnabled(m_profileAction->isChecked());
+    connect(m_profileReportAction, &QAction::triggered, this, &ProcessorTab::showProfile);
+    m_toolbar->addAction(m_profileReportAction);
+
     m_darkmodeAction = new QAction("Processor darkmode", this);
     m_darkmodeAction->setCheckable(true);
     connect(m_darkmodeAction, &QAction::toggled, m_vsrtlWidget, [=](bool checked) {
@@ -306,7 +326,7 @@ void ProcessorTab::updateStatistics() {
 void ProcessorTab::pause() {
     m_autoClockAction->setChecked(false);
     m_runAction->setChecked(false);
-    m_reverseAction->setEnabled(m_vsrtlWidget->isReversible());
+    m_reverseAction->setEnabled(ProcessorHandler::canReverse());
 }
 
 void ProcessorTab::fitToScreen() {
@@ -420,9 +440,11 @@ void ProcessorTab::enableSimulatorControls() {
     m_clockAction->setEnabled(true);
     m_autoClockAction->setEnabled(true);
     m_runAction->setEnabled(true);
-    m_reverseAction->setEnabled(m_vsrtlWidget->isReversible());
+    m_reverseAction->setEnabled(ProcessorHandler::canReverse());
     m_resetAction->setEnabled(true);
     m_pipelineDiagramAction->setEnabled(true);
+    m_profileAction->setEnabled(true);
+    m_profileReportAction->setEnabled(m_profileAction->isChecked());
 }
 
 void ProcessorTab::updateInstructionLabels() {
@@ -502,6 +524,8 @@ void ProcessorTab::run(bool state) {
     m_resetAction->setEnabled(!state);
     m_displayValuesAction->setEnabled(!state);
     m_pipelineDiagramAction->setEnabled(!state);
+    m_profileAction->setEnabled(!state);
+    m_profileReportAction->setEnabled(!state && m_profileAction->isChecked());
 
     // Disable widgets which are not updated when running the processor
     m_vsrtlWidget->setEnabled(!state);
@@ -510,7 +534,7 @@ void ProcessorTab::run(bool state) {
 }
 
 void ProcessorTab::reverse() {
-    m_vsrtlWidget->reverse();
+    ProcessorHandler::reverse();
     enableSimulatorControls();
 }
 
@@ -518,4 +542,9 @@ void ProcessorTab::showPipelineDiagram() {
     auto w = PipelineDiagramWidget(m_stageModel);
     w.exec();
 }
+
+void ProcessorTab::showProfile() {
+    auto w = ProfilerWidget(this);
+    w.exec();
+}
 }  // namespace Ripes
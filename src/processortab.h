@@ -54,6 +54,7 @@ private slots:
     void run(bool state);
     void setInstructionViewCenterAddr(AInt address);
     void showPipelineDiagram();
+    void showProfile();
 
 private:
     void setupSimulatorActions(QToolBar* controlToolbar);
@@ -80,6 +81,8 @@ private:
     QAction* m_runAction = nullptr;
     QAction* m_displayValuesAction = nullptr;
     QAction* m_pipelineDiagramAction = nullptr;
+    QAction* m_profileAction = nullptr;
+    QAction* m_profileReportAction = nullptr;
     QAction* m_reverseAction = nullptr;
     QAction* m_resetAction = nullptr;
     QAction* m_darkmodeAction = nullptr;
@@ -0,0 +1,154 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <map>
+
+#include "processorhandler.h"
+#include "ripessettings.h"
+
+namespace Ripes {
+
+Profiler::Profiler() {
+    connect(ProcessorHandler::get(), &ProcessorHandler::processorReset, this, &Profiler::processorReset);
+    // Reversing or restoring the processor moves it to an earlier cycle. The profile is kept, but the retiring
+    // instructions must be resampled.
+    connect(ProcessorHandler::get(), &ProcessorHandler::processorReversed, this, &Profiler::sampleStages);
+    connect(ProcessorHandler::get(), &ProcessorHandler::snapshotRestored, this, &Profiler::sampleStages);
+
+    connect(RipesSettings::getObserver(RIPES_SETTING_PROFILER_ENABLED), &SettingObserver::modified, this,
+            [=](const QVariant& enabled) { setEnabled(enabled.toBool()); });
+    setEnabled(RipesSettings::value(RIPES_SETTING_PROFILER_ENABLED).toBool());
+    processorReset();
+}
+
+void Profiler::setEnabled(bool enabled) {
+    if (m_enabled == enabled) {
+        return;
+    }
+    m_enabled = enabled;
+
+    if (m_enabled) {
+        // The profile must be updated on each cycle, in lockstep with the processor itself; see L1CacheShim.
+        m_clockConnection = connect(ProcessorHandler::get(), &ProcessorHandler::processorClocked, this,
+                                    &Profiler::processorClocked, Qt::DirectConnection);
+    } else {
+        disconnect(m_clockConnection);
+    }
+    processorReset();
+}
+
+void Profiler::processorReset() {
+    m_counters.clear();
+    m_total = ProfileCounters();
+    m_maxCycles = 0;
+    if (m_enabled) {
+        m_textStart = ProcessorHandler::getTextStart();
+        m_counters.resize((ProcessorHandler::getCurrentProgramSize() + s_granularity - 1) / s_granularity);
+    }
+
+    m_retiringStages = ProcessorHandler::getProcessor()->retiringStages();
+    sampleStages();
+    emit profileChanged();
+}
+
+void Profiler::sampleStages() {
+    const auto* proc = ProcessorHandler::getProcessor();
+    m_retiringPCs.clear();
+    for (const unsigned stage : m_retiringStages) {
+        const auto info = proc->stageInfo(stage);
+        if (info.stage_valid) {
+            m_retiringPCs.push_back(info.pc);
+        }
+    }
+    m_instructionsRetired = proc->getInstructionsRetired();
+}
+
+void Profiler::processorClocked() {
+    if (ProcessorHandler::isRewinding()) {
+        // The cycles re-executed when rewinding were profiled as they were first executed.
+        sampleStages();
+        return;
+    }
+
+    const auto* proc = ProcessorHandler::getProcessor();
+    const long long retired = proc->getInstructionsRetired() - m_instructionsRetired;
+
+    if (retired > 0) {
+        // The retired instructions are those which were present in the retiring stages before the processor was
+        // clocked. The cycle is attributed to the first of them.
+        for (long long i = 0; i < retired && i < static_cast<long long>(m_retiringPCs.size()); i++) {
+            if (auto* counters = countersAt(m_retiringPCs[i])) {
+                counters->executions++;
+                m_total.executions++;
+                if (i == 0) {
+                    counters->cycles++;
+                    m_total.cycles++;
+                    m_maxCycles = std::max(m_maxCycles, counters->cycles);
+                }
+            }
+        }
+    } else {
+        // No instruction retired; the cycle is a stall of the oldest instruction in the pipeline, which is the next
+        // instruction to retire.
+        for (unsigned stage = proc->stageCount(); stage-- > 0;) {
+            const auto info = proc->stageInfo(stage);
+            if (!info.stage_valid) {
+                continue;
+            }
+            if (auto* counters = countersAt(info.pc)) {
+                counters->cycles++;
+                counters->stalls++;
+                m_total.cycles++;
+                m_total.stalls++;
+                m_maxCycles = std::max(m_maxCycles, counters->cycles);
+            }
+            break;
+        }
+    }
+
+    sampleStages();
+}
+
+void Profiler::recordCacheMiss(AInt pc) {
+    if (ProcessorHandler::isRewinding()) {
+        return;
+    }
+    if (auto* counters = countersAt(pc)) {
+        counters->cacheMisses++;
+        m_total.cacheMisses++;
+    }
+}
+
+ProfileCounters* Profiler::countersAt(AInt pc) {
+    if (pc < m_textStart) {
+        return nullptr;
+    }
+    const AInt index = (pc - m_textStart) / s_granularity;
+    return index < m_counters.size() ? &m_counters[index] : nullptr;
+}
+
+ProfileCounters Profiler::counters(AInt pc) const {
+    if (pc < m_textStart) {
+        return ProfileCounters();
+    }
+    const AInt index = (pc - m_textStart) / s_granularity;
+    return index < m_counters.size() ? m_counters[index] : ProfileCounters();
+}
+
+std::vector<FunctionProfile> Profiler::byFunction(const SymbolIndex& symbols) const {
+    // Addresses not contained in any symbol are aggregated under the nullptr key.
+    std::map<const SymbolInfo*, ProfileCounters> aggregated;
+    forEach([&](AInt pc, const ProfileCounters& counters) { aggregated[symbols.containing(pc)] += counters; });
+
+    std::vector<FunctionProfile> profiles;
+    profiles.reserve(aggregated.size());
+    for (const auto& it : aggregated) {
+        profiles.push_back({it.first ? *it.first : SymbolInfo(), it.second});
+    }
+    std::sort(profiles.begin(), profiles.end(), [](const FunctionProfile& lhs, const FunctionProfile& rhs) {
+        return lhs.counters.cycles > rhs.counters.cycles;
+    });
+    return profiles;
+}
+
+}  // namespace Ripes
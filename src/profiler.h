@@ -0,0 +1,133 @@
+#pragma once
+
+#include <QMetaObject>
+#include <QObject>
+#include <QString>
+
+#include <cstdint>
+#include <vector>
+
+#include "assembler/program.h"
+#include "ripes_types.h"
+
+namespace Ripes {
+
+struct ProfileCounters {
+    // Number of times the instruction was retired
+    uint64_t executions = 0;
+    // Clock cycles attributed to the instruction; the cycles in which it retired, or in which it was the oldest
+    // instruction in the pipeline while no instruction retired.
+    uint64_t cycles = 0;
+    // The subset of cycles in which no instruction retired
+    uint64_t stalls = 0;
+    // L1 instruction cache misses of fetching the instruction, and L1 data cache misses of its memory accesses
+    uint64_t cacheMisses = 0;
+
+    bool empty() const { return executions == 0 && cycles == 0 && cacheMisses == 0; }
+    ProfileCounters& operator+=(const ProfileCounters& rhs) {
+        executions += rhs.executions;
+        cycles += rhs.cycles;
+        stalls += rhs.stalls;
+        cacheMisses += rhs.cacheMisses;
+        return *this;
+    }
+};
+
+struct FunctionProfile {
+    // The symbol containing the profiled addresses. Unset (empty name) for addresses which no symbol contains.
+    SymbolInfo symbol;
+    ProfileCounters counters;
+};
+
+/**
+ * @brief The Profiler class
+ * Accumulates per-PC execution statistics of the current processor while it is clocked, including during runs. Every
+ * clock cycle is attributed to exactly one instruction, such that the cycles of all instructions sum up to the cycle
+ * count of the processor (excluding cycles in which the pipeline held no valid instruction).
+ * Profiling is opt-in (RIPES_SETTING_PROFILER_ENABLED), and the profile restarts whenever the processor is reset.
+ * Reversing the processor is not supported; reversed cycles remain in the profile. Cycles which are re-executed when
+ * rewinding are not profiled again.
+ */
+class Profiler : public QObject {
+    Q_OBJECT
+public:
+    static Profiler& get() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    bool isEnabled() const { return m_enabled; }
+
+    /**
+     * @brief recordCacheMiss
+     * Attributes an L1 cache miss to the instruction at @p pc. Called from the simulator thread, in lockstep with the
+     * processor.
+     */
+    void recordCacheMiss(AInt pc);
+
+    /**
+     * @brief counters
+     * @returns the counters of the instruction at @p pc. Empty if @p pc is outside of the text section.
+     */
+    ProfileCounters counters(AInt pc) const;
+    const ProfileCounters& total() const { return m_total; }
+    uint64_t maxCycles() const { return m_maxCycles; }
+
+    /**
+     * @brief forEach
+     * Calls @p f with the address and counters of each profiled instruction, in address order.
+     */
+    template <typename F>
+    void forEach(F&& f) const {
+        for (size_t i = 0; i < m_counters.size(); i++) {
+            if (!m_counters[i].empty()) {
+                f(m_textStart + i * s_granularity, m_counters[i]);
+            }
+        }
+    }
+
+    /**
+     * @brief byFunction
+     * @returns the profile aggregated by the innermost symbol of @p symbols containing each profiled instruction.
+     */
+    std::vector<FunctionProfile> byFunction(const SymbolIndex& symbols) const;
+
+signals:
+    /**
+     * @brief profileChanged
+     * Emitted when the profile was cleared, or profiling was enabled or disabled. Not emitted while the profile
+     * accumulates.
+     */
+    void profileChanged();
+
+private:
+    Profiler();
+
+    void setEnabled(bool enabled);
+    void processorReset();
+    void processorClocked();
+    /**
+     * @brief sampleStages
+     * Records the instructions in the retiring stages of the processor, which retire once it is next clocked, and
+     * resynchronizes the retired instruction count.
+     */
+    void sampleStages();
+    ProfileCounters* countersAt(AInt pc);
+
+    // Instructions are at least 2-byte aligned (RISC-V compressed instructions).
+    static constexpr AInt s_granularity = 2;
+
+    bool m_enabled = false;
+    QMetaObject::Connection m_clockConnection;
+
+    AInt m_textStart = 0;
+    std::vector<ProfileCounters> m_counters;
+    ProfileCounters m_total;
+    uint64_t m_maxCycles = 0;
+
+    std::vector<unsigned> m_retiringStages;
+    std::vector<AInt> m_retiringPCs;
+    long long m_instructionsRetired = 0;
+};
+
+}  // namespace Ripes
@@ -0,0 +1,97 @@
+#include "profilerwidget.h"
+#include "ui_profilerwidget.h"
+
+#include <QHeaderView>
+
+#include "processorhandler.h"
+#include "profiler.h"
+#include "radix.h"
+
+namespace Ripes {
+
+namespace {
+const QStringList s_counterHeaders = {"Executions", "Cycles", "% Cycles", "Stalls", "Cache misses"};
+}
+
+ProfilerWidget::ProfilerWidget(QWidget* parent) : QDialog(parent), m_ui(new Ui::ProfilerWidget) {
+    m_ui->setupUi(this);
+
+    const auto& profiler = Profiler::get();
+    const auto& total = profiler.total();
+    m_ui->summary->setText(QString("%1 cycles, %2 instructions retired, %3 stall cycles, %4 cache misses")
+                               .arg(total.cycles)
+                               .arg(total.executions)
+                               .arg(total.stalls)
+                               .arg(total.cacheMisses));
+
+    setupTable(m_ui->functionTable, QStringList{"Function", "Address"} + s_counterHeaders);
+    setupTable(m_ui->instructionTable, QStringList{"Address", "Function", "Instruction"} + s_counterHeaders);
+
+    const unsigned addrBytes = ProcessorHandler::currentISA()->bytes();
+    SymbolIndex symbols;
+    if (auto program = ProcessorHandler::getProgram()) {
+        symbols = program->symbolIndex;
+    }
+
+    for (const auto& function : profiler.byFunction(symbols)) {
+        const bool known = !function.symbol.name.isEmpty();
+        addRow(m_ui->functionTable,
+               {known ? function.symbol.name : "<unknown>",
+                known ? encodeRadixValue(function.symbol.address, Radix::Hex, addrBytes) : QString()},
+               function.counters);
+    }
+    profiler.forEach([&](AInt pc, const ProfileCounters& counters) {
+        const auto* symbol = symbols.containing(pc);
+        addRow(m_ui->instructionTable,
+               {encodeRadixValue(pc, Radix::Hex, addrBytes), symbol ? symbol->name : QString(),
+                ProcessorHandler::disassembleInstr(pc)},
+               counters);
+    });
+
+    // Hottest entries first
+    for (auto* table : {m_ui->functionTable, m_ui->instructionTable}) {
+        table->setSortingEnabled(true);
+        const int cyclesColumn = table->columnCount() - s_counterHeaders.size() + s_counterHeaders.indexOf("Cycles");
+        table->sortByColumn(cyclesColumn, Qt::DescendingOrder);
+    }
+}
+
+void ProfilerWidget::setupTable(QTableWidget* table, const QStringList& headers) {
+    table->setColumnCount(headers.size());
+    table->setHorizontalHeaderLabels(headers);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->verticalHeader()->hide();
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    // Rows are added with sorting disabled, to avoid re-sorting the table for each inserted row.
+    table->setSortingEnabled(false);
+}
+
+void ProfilerWidget::addRow(QTableWidget* table, const QStringList& labels, const ProfileCounters& counters) {
+    const auto totalCycles = Profiler::get().total().cycles;
+    const double cyclesShare = totalCycles != 0 ? 100.0 * counters.cycles / totalCycles : 0.0;
+    const QList<QVariant> values = {static_cast<qulonglong>(counters.executions),
+                                    static_cast<qulonglong>(counters.cycles),
+                                    QString::number(cyclesShare, 'f', 1).toDouble(),
+                                    static_cast<qulonglong>(counters.stalls),
+                                    static_cast<qulonglong>(counters.cacheMisses)};
+
+    const int row = table->rowCount();
+    table->setRowCount(row + 1);
+    int column = 0;
+    for (const auto& label : labels) {
+        table->setItem(row, column++, new QTableWidgetItem(label));
+    }
+    // Counters are stored as numbers rather than strings, such that the columns sort numerically.
+    for (const auto& value : values) {
+        auto* item = new QTableWidgetItem();
+        item->setData(Qt::DisplayRole, value);
+        item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        table->setItem(row, column++, item);
+    }
+}
+
+ProfilerWidget::~ProfilerWidget() {
+    delete m_ui;
+}
+}  // namespace Ripes
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QDialog>
+
+QT_FORWARD_DECLARE_CLASS(QTableWidget)
+
+namespace Ripes {
+
+namespace Ui {
+class ProfilerWidget;
+}
+
+struct ProfileCounters;
+
+/**
+ * @brief The ProfilerWidget class
+ * Hot-spot report of the current execution profile, listing the profiled functions and instructions in sortable
+ * tables.
+ */
+class ProfilerWidget : public QDialog {
+    Q_OBJECT
+
+public:
+    ProfilerWidget(QWidget* parent = nullptr);
+    ~ProfilerWidget() override;
+
+private:
+    void setupTable(QTableWidget* table, const QStringList& headers);
+    void addRow(QTableWidget* table, const QStringList& labels, const ProfileCounters& counters);
+
+    Ui::ProfilerWidget* m_ui = nullptr;
+};
+}  // namespace Ripes
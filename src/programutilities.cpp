@@ -0,0 +1,246 @@
+#include "programutilities.h"
+
+#include <QtEndian>
+
+#include <climits>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "elfio/elfio.hpp"
+
+namespace Ripes {
+
+bool loadFlatBinaryFile(Program& program, QFile& file, AInt entryPoint, AInt loadAt) {
+    ProgramSection section;
+    section.name = TEXT_SECTION_NAME;
+    section.address = loadAt;
+    section.data = file.readAll();
+
+    program.sections[TEXT_SECTION_NAME] = section;
+    program.entryPoint = entryPoint;
+    return true;
+}
+
+namespace {
+
+// Reads a little-endian field of ELF structure T, located at base.
+#define ELF_FIELD(T, base, field) qFromLittleEndian<decltype(T::field)>((base) + offsetof(T, field))
+
+template <typename Ehdr, typename Phdr, typename Shdr, typename Sym>
+bool loadElfImage(Program& program, const char* image, quint64 imageSize) {
+    using namespace ELFIO;
+
+    const auto inImage = [=](quint64 offset, quint64 size) {
+        return offset <= imageSize && size <= imageSize - offset && size <= static_cast<quint64>(INT_MAX);
+    };
+    if (imageSize < sizeof(Ehdr)) {
+        return false;
+    }
+
+    const quint64 phoff = ELF_FIELD(Ehdr, image, e_phoff);
+    const unsigned phnum = ELF_FIELD(Ehdr, image, e_phnum);
+    const unsigned phentsize = ELF_FIELD(Ehdr, image, e_phentsize);
+    const quint64 shoff = ELF_FIELD(Ehdr, image, e_shoff);
+    const unsigned shnum = ELF_FIELD(Ehdr, image, e_shnum);
+    const unsigned shentsize = ELF_FIELD(Ehdr, image, e_shentsize);
+    const unsigned shstrndx = ELF_FIELD(Ehdr, image, e_shstrndx);
+    if (phnum != 0 && (phentsize < sizeof(Phdr) || !inImage(phoff, quint64(phnum) * phentsize))) {
+        return false;
+    }
+    if (shnum != 0 && (shentsize < sizeof(Shdr) || !inImage(shoff, quint64(shnum) * shentsize))) {
+        return false;
+    }
+
+    // Memory is initialized from the loadable segments. The part of a segment beyond its contents in the file (e.g.
+    // .bss) is zero-filled. The file range of each segment is kept, such that the sections within it can refer to the
+    // segment data rather than copying it again.
+    struct SegmentRange {
+        quint64 offset;
+        quint64 size;
+        const char* data;
+    };
+    std::vector<SegmentRange> segmentRanges;
+    for (unsigned i = 0; i < phnum; i++) {
+        const char* ph = image + phoff + quint64(i) * phentsize;
+        if (ELF_FIELD(Phdr, ph, p_type) != PT_LOAD) {
+            continue;
+        }
+        const quint64 offset = ELF_FIELD(Phdr, ph, p_offset);
+        const quint64 fileSize = ELF_FIELD(Phdr, ph, p_filesz);
+        const quint64 memSize = ELF_FIELD(Phdr, ph, p_memsz);
+        if (!inImage(offset, fileSize) || memSize < fileSize) {
+            return false;
+        }
+        ProgramSection segment;
+        segment.address = ELF_FIELD(Phdr, ph, p_vaddr);
+        segment.data = QByteArray(image + offset, static_cast<int>(fileSize));
+        segment.zeroFillSize = memSize - fileSize;
+        program.segments.push_back(segment);
+        segmentRanges.push_back({offset, fileSize, segment.data.constData()});
+    }
+    const auto segmentData = [&](quint64 offset, quint64 size) -> const char* {
+        for (const auto& range : segmentRanges) {
+            if (range.offset <= offset && size <= range.size && offset - range.offset <= range.size - size) {
+                return range.data + (offset - range.offset);
+            }
+        }
+        return nullptr;
+    };
+
+    const auto sectionHeader = [=](unsigned idx) { return image + shoff + quint64(idx) * shentsize; };
+    const auto stringAt = [=](unsigned strtabIdx, quint64 offset) {
+        if (strtabIdx >= shnum) {
+            return QString();
+        }
+        const char* sh = sectionHeader(strtabIdx);
+        const quint64 tableOffset = ELF_FIELD(Shdr, sh, sh_offset);
+        const quint64 tableSize = ELF_FIELD(Shdr, sh, sh_size);
+        if (!inImage(tableOffset, tableSize) || offset >= tableSize) {
+            return QString();
+        }
+        const char* str = image + tableOffset + offset;
+        return QString::fromUtf8(str, static_cast<int>(qstrnlen(str, tableSize - offset)));
+    };
+
+    std::vector<SymbolInfo> symbols;
+    for (unsigned i = 0; i < shnum; i++) {
+        const char* sh = sectionHeader(i);
+        const auto type = ELF_FIELD(Shdr, sh, sh_type);
+        const quint64 offset = ELF_FIELD(Shdr, sh, sh_offset);
+        const quint64 size = ELF_FIELD(Shdr, sh, sh_size);
+        if (type == SHT_NULL) {
+            continue;
+        }
+        if (type != SHT_NOBITS && !inImage(offset, size)) {
+            return false;
+        }
+
+        // Do not load .debug sections
+        const QString name = stringAt(shstrndx, ELF_FIELD(Shdr, sh, sh_name));
+        if (!name.startsWith(".debug")) {
+            ProgramSection section;
+            section.name = name;
+            section.address = ELF_FIELD(Shdr, sh, sh_addr);
+            const char* loaded = ELF_FIELD(Shdr, sh, sh_flags) & SHF_ALLOC ? segmentData(offset, size) : nullptr;
+            if (type == SHT_NOBITS) {
+                section.zeroFillSize = size;
+            } else if (loaded) {
+                // Allocated sections are contained within the loaded segments; refer to the segment data.
+                section.data = QByteArray::fromRawData(loaded, static_cast<int>(size));
+            } else {
+                section.data = QByteArray(image + offset, static_cast<int>(size));
+            }
+            program.sections[section.name] = section;
+        }
+
+        if (type == SHT_SYMTAB) {
+            // Collect function, object and section symbols. Function symbols are additionally used as labels.
+            const quint64 entrySize = ELF_FIELD(Shdr, sh, sh_entsize);
+            const unsigned strtabIdx = ELF_FIELD(Shdr, sh, sh_link);
+            if (entrySize < sizeof(Sym)) {
+                continue;
+            }
+            for (quint64 symOffset = 0; symOffset + entrySize <= size; symOffset += entrySize) {
+                const char* sym = image + offset + symOffset;
+                const unsigned char info = ELF_FIELD(Sym, sym, st_info);
+                SymbolInfo symbol;
+                symbol.address = ELF_FIELD(Sym, sym, st_value);
+                symbol.size = ELF_FIELD(Sym, sym, st_size);
+                switch (info & 0xF) {
+                    case STT_FUNC:
+                        symbol.kind = SymbolInfo::Kind::Function;
+                        symbol.name = stringAt(strtabIdx, ELF_FIELD(Sym, sym, st_name));
+                        program.symbols[symbol.address] = symbol.name;
+                        break;
+                    case STT_OBJECT:
+                        symbol.kind = SymbolInfo::Kind::Object;
+                        symbol.name = stringAt(strtabIdx, ELF_FIELD(Sym, sym, st_name));
+                        break;
+                    case STT_SECTION: {
+                        // Section symbols are unnamed, and span the section which they refer to
+                        const unsigned sectionIdx = ELF_FIELD(Sym, sym, st_shndx);
+                        if (sectionIdx == 0 || sectionIdx >= shnum) {
+                            continue;
+                        }
+                        const char* symSection = sectionHeader(sectionIdx);
+                        if (!(ELF_FIELD(Shdr, symSection, sh_flags) & SHF_ALLOC)) {
+                            continue;
+                        }
+                        symbol.kind = SymbolInfo::Kind::Section;
+                        symbol.name = stringAt(shstrndx, ELF_FIELD(Shdr, symSection, sh_name));
+                        symbol.address = ELF_FIELD(Shdr, symSection, sh_addr);
+                        symbol.size = ELF_FIELD(Shdr, symSection, sh_size);
+                        break;
+                    }
+                    default:
+                        continue;
+                }
+                symbols.push_back(symbol);
+            }
+        }
+    }
+    program.symbolIndex = SymbolIndex(std::move(symbols));
+
+    // Sections refer to the segment data; keep it alive for as long as the program, even if the segments of the
+    // program are later modified.
+    auto segmentStorage = std::make_shared<std::vector<QByteArray>>();
+    for (const auto& segment : program.segments) {
+        segmentStorage->push_back(segment.data);
+    }
+    program.storage = segmentStorage;
+
+    program.entryPoint = ELF_FIELD(Ehdr, image, e_entry);
+    return true;
+}
+
+#undef ELF_FIELD
+
+}  // namespace
+
+bool loadElfFile(Program& program, QFile& file) {
+    using namespace ELFIO;
+
+    // The file is mapped rather than read, such that only the loaded segments and the sections outside of them are
+    // copied out of it; the mapping itself is released once the file has been loaded.
+    QFile mappedFile(file.fileName());
+    if (!mappedFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const qint64 size = mappedFile.size();
+    const char* image = reinterpret_cast<const char*>(mappedFile.map(0, size));
+    QByteArray contents;
+    if (!image) {
+        // Not all files can be mapped, e.g. compressed resources.
+        contents = mappedFile.readAll();
+        image = contents.constData();
+    }
+
+    // Only basic validity checking is performed here - when loading through the GUI, it is expected that Loaddialog
+    // has done all validity checking.
+    if (size < EI_NIDENT || image[EI_MAG0] != ELFMAG0 || image[EI_MAG1] != ELFMAG1 || image[EI_MAG2] != ELFMAG2 ||
+        image[EI_MAG3] != ELFMAG3 || image[EI_DATA] != ELFDATA2LSB) {
+        return false;
+    }
+
+    Program loaded;
+    bool success = false;
+    switch (image[EI_CLASS]) {
+        case ELFCLASS32:
+            success = loadElfImage<Elf32_Ehdr, Elf32_Phdr, Elf32_Shdr, Elf32_Sym>(loaded, image, size);
+            break;
+        case ELFCLASS64:
+            success = loadElfImage<Elf64_Ehdr, Elf64_Phdr, Elf64_Shdr, Elf64_Sym>(loaded, image, size);
+            break;
+        default:
+            break;
+    }
+    if (!success) {
+        return false;
+    }
+
+    program = std::move(loaded);
+    return true;
+}
+
+}  // namespace Ripes
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QFile>
+
+#include "assembler/program.h"
+
+namespace Ripes {
+
+/**
+ * @brief loadElfFile
+ * Loads the loadable segments, all non-debug sections and the function, object and section symbols of the ELF file
+ * @p file into @p program, and sets the program entry point. Function symbols are additionally used as labels.
+ * The file is memory-mapped while loading. The program holds a copy of each loadable segment, which the allocated
+ * sections within it refer to; other sections are copied separately.
+ * @returns false if @p file could not be parsed as an ELF file.
+ */
+bool loadElfFile(Program& program, QFile& file);
+
+/**
+ * @brief loadFlatBinaryFile
+ * Loads the contents of @p file as the .text section of @p program, placed at @p loadAt, with the program entry point
+ * set to @p entryPoint.
+ */
+bool loadFlatBinaryFile(Program& program, QFile& file, AInt entryPoint, AInt loadAt);
+
+}  // namespace Ripes
@@ -9,6 +9,7 @@
 
 #include "colors.h"
 #include "fonts.h"
+#include "profiler.h"
 #include "ripessettings.h"
 
 namespace Ripes {
@@ -29,6 +30,9 @@ ProgramViewer::ProgramViewer(QWidget* parent) : QPlainTextEdit(parent) {
     setTabStopDistance(QFontMetricsF(m_font).width(' ') * 4);
 
     setLineWrapMode(QPlainTextEdit::NoWrap);
+
+    // The profile is not updated while it accumulates, but only when the viewer is otherwise updated.
+    connect(&Profiler::get(), &Profiler::profileChanged, viewport(), qOverload<>(&QWidget::update));
 }
 
 void ProgramViewer::clearBreakpoints() {
@@ -156,9 +160,10 @@ void ProgramViewer::updateHighlightedAddresses() {
 void ProgramViewer::paintEvent(QPaintEvent* event) {
     QPlainTextEdit::paintEvent(event);
 
-    // Draw stage names for highlighted addresses
     QPainter painter(viewport());
+    paintProfileHeat(painter, event->rect());
 
+    // Draw stage names for highlighted addresses
     for (const auto& hb : m_highlightedBlocksText) {
         const QString stageString = hb.second.join('/');
         const auto bbr = blockBoundingGeometry(hb.first);
@@ -172,6 +177,50 @@ void ProgramViewer::paintEvent(QPaintEvent* event) {
     painter.end();
 }
 
+void ProgramViewer::paintProfileHeat(QPainter& painter, const QRect& rect) {
+    const auto& profiler = Profiler::get();
+    if (!profiler.isEnabled() || profiler.maxCycles() == 0) {
+        return;
+    }
+
+    painter.setFont(font());
+    bool ok;
+    for (QTextBlock block = firstVisibleBlock(); block.isValid(); block = block.next()) {
+        const QRectF bbr = blockBoundingGeometry(block).translated(contentOffset());
+        if (bbr.top() > rect.bottom()) {
+            break;
+        }
+        if (!block.isVisible()) {
+            continue;
+        }
+        const AInt address = addressForBlock(block, ok);
+        if (!ok) {
+            continue;
+        }
+        const uint64_t cycles = profiler.counters(address).cycles;
+        if (cycles == 0) {
+            continue;
+        }
+
+        // Lines are shaded relative to the instruction which the most cycles are attributed to.
+        QColor heat = Colors::CaliforniaGold;
+        heat.setAlphaF(0.05 + 0.35 * static_cast<double>(cycles) / profiler.maxCycles());
+        painter.fillRect(QRectF(bbr.left(), bbr.top(), viewport()->width(), bbr.height()), heat);
+
+        // Lines highlighted by a stage already have their right-hand side occupied by the stage names.
+        if (m_highlightedBlocksText.count(block) == 0) {
+            const QString share = QString("%1% (%2 cycles)")
+                                      .arg(100.0 * cycles / profiler.total().cycles, 0, 'f', 1)
+                                      .arg(cycles);
+            const QRect shareRect = painter.fontMetrics().boundingRect(share);
+            painter.drawText(QRectF(viewport()->width() - shareRect.width() - /* right-hand side padding*/ 10,
+                                    bbr.top() + (bbr.height() / 2.0 - shareRect.height() / 2.0), shareRect.width(),
+                                    shareRect.height()),
+                             share);
+        }
+    }
+}
+
 void ProgramViewer::breakpointAreaPaintEvent(QPaintEvent* event) {
     QPainter painter(m_breakpointArea);
 
@@ -2,6 +2,7 @@
 
 #include <QFont>
 #include <QObject>
+#include <QPainter>
 #include <QPlainTextEdit>
 #include <QScrollBar>
 #include <QTimer>
@@ -58,6 +59,13 @@ private:
      */
     void updateCenterAddressFromProcessor();
 
+    /**
+     * @brief paintProfileHeat
+     * Shades the lines within @p rect of the viewport by the share of the profiled cycles which are attributed to the
+     * instruction of the line.
+     */
+    void paintProfileHeat(QPainter& painter, const QRect& rect);
+
     // A timer is needed for only catching one of the multiple wheel events that
     // occur on a regular mouse scroll
     QTimer m_fontTimer;
@@ -11,6 +11,7 @@ namespace Ripes {
 const std::map<QString, QVariant> s_defaultSettings = {
     // User-modifyable settings
     {RIPES_SETTING_REWINDSTACKSIZE, 100},
+    {RIPES_SETTING_SNAPSHOTINTERVAL, 10000},
     {RIPES_SETTING_CCPATH, ""},
     {RIPES_SETTING_CCARGS, "-O0"},
     {RIPES_SETTING_LDARGS, "-static -lm"},  // Ensure statically linked executable + link with math library
@@ -29,6 +30,7 @@ const std::map<QString, QVariant> s_defaultSettings = {
     {RIPES_SETTING_EDITORREGS, true},
 
     {RIPES_SETTING_PIPEDIAGRAM_MAXCYCLES, 100},
+    {RIPES_SETTING_PIPEDIAGRAM_RECORDRUNS, false},
     {RIPES_SETTING_CACHE_MAXCYCLES, 10000},
     {RIPES_SETTING_CACHE_MAXPOINTS, 1000},
     {RIPES_SETTING_CACHE_PRESETS,
@@ -52,6 +54,7 @@ const std::map<QString, QVariant> s_defaultSettings = {
     {RIPES_SETTING_FOLLOW_EXEC, "true"},
     {RIPES_SETTING_SOURCECODE, ""},
     {RIPES_SETTING_DARKMODE, false},
+    {RIPES_SETTING_PROFILER_ENABLED, false},
     {RIPES_SETTING_INPUT_TYPE, static_cast<unsigned>(SourceType::Assembly)},
     {RIPES_SETTING_AUTOCLOCK_INTERVAL, 100},
 
@@ -9,6 +9,7 @@ namespace Ripes {
 // =========== Definitions of the name of all settings within Ripes ============
 // User-modifyable settings
 #define RIPES_SETTING_REWINDSTACKSIZE ("simulator_rewindstacksize")
+#define RIPES_SETTING_SNAPSHOTINTERVAL ("simulator_snapshotinterval")
 #define RIPES_SETTING_CCPATH ("compiler_path")
 #define RIPES_SETTING_CCARGS ("compiler_args")
 #define RIPES_SETTING_LDARGS ("linker_args")
@@ -24,6 +25,7 @@ namespace Ripes {
 #define RIPES_SETTING_ASSEMBLER_BSSSTART ("bss_start")
 
 #define RIPES_SETTING_PIPEDIAGRAM_MAXCYCLES ("pipelinediagram_maxcycles")
+#define RIPES_SETTING_PIPEDIAGRAM_RECORDRUNS ("pipelinediagram_recordruns")
 #define RIPES_SETTING_PERIPHERALS_START ("peripheral_start")
 #define RIPES_SETTING_CACHE_MAXCYCLES ("cacheplot_maxcycles")
 #define RIPES_SETTING_CACHE_MAXPOINTS ("cacheplot_maxpoints")
@@ -44,6 +46,7 @@ namespace Ripes {
 #define RIPES_SETTING_INPUT_TYPE ("input_type")
 #define RIPES_SETTING_SOURCECODE ("sourcecode")
 #define RIPES_SETTING_DARKMODE ("darkmode")
+#define RIPES_SETTING_PROFILER_ENABLED ("profiler_enabled")
 #define RIPES_SETTING_AUTOCLOCK_INTERVAL ("autoclock_interval")
 #define RIPES_SETTING_EDITORREGS ("editor_regs")
 
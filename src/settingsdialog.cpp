@@ -273,6 +273,16 @@ QWidget* SettingsDialog::createSimulatorPage() {
     rewindSpinbox->setRange(0, INT_MAX);
     appendToLayout({rewindLabel, rewindSpinbox}, pageLayout, "Maximum cycles that the simulator is able to undo.");
 
+    // Setting: RIPES_SETTING_SNAPSHOTINTERVAL
+    auto [snapshotLabel, snapshotSpinbox] =
+        createSettingsWidgets<QSpinBox>(RIPES_SETTING_SNAPSHOTINTERVAL, "Snapshot interval (cycles):");
+    snapshotSpinbox->setRange(0, INT_MAX);
+    appendToLayout({snapshotLabel, snapshotSpinbox}, pageLayout,
+                   "Minimum cycles between snapshots of the processor state. Cycles beyond the max. undo cycles are "
+                   "undone by re-executing from the nearest snapshot. The interval is increased automatically when "
+                   "snapshots are slow to take. Pipelined processors are not snapshotted, and can only be undone "
+                   "within the max. undo cycles. 0 disables periodic snapshots.");
+
     appendToLayout(createSettingsWidgets<HexSpinBox>(RIPES_SETTING_PERIPHERALS_START, "I/O start address:"), pageLayout,
                    "Start address in the address space where peripherals will be allocated from, growing upwards");
 
@@ -330,6 +340,12 @@ QWidget* SettingsDialog::createEnvironmentPage() {
     appendToLayout({maxPipeDiagCycLabel, maxPipeDiagCycSb}, pageLayout,
                    "Maximum number of cycles to be recorded in the pipeline diagram.");
 
+    appendToLayout(
+        createSettingsWidgets<QCheckBox>(RIPES_SETTING_PIPEDIAGRAM_RECORDRUNS, "Record pipeline diagram when running:"),
+        pageLayout,
+        "Record the pipeline diagram for every cycle executed while running the processor. The most recent cycles will "
+        "then be available in the pipeline diagram after a run, at the cost of slower execution.");
+
     // Console settings
     auto* consoleGroupBox = new QGroupBox("Console");
     auto* consoleLayout = new QGridLayout();
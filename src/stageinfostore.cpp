@@ -0,0 +1,102 @@
+#include "stageinfostore.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace Ripes {
+
+void StageInfoStore::reset(unsigned stages, size_t capacity, AInt rowBase, unsigned rowBytes) {
+    m_stages = stages;
+    m_capacity = std::max<size_t>(capacity, 1);
+    m_rowBase = rowBase;
+    m_rowBytes = std::max(rowBytes, 1U);
+    m_firstCycle = 0;
+    m_endCycle = 0;
+
+    const size_t entries = m_capacity * m_stages;
+    m_pcs.assign(entries, 0);
+    m_valid.assign(entries, false);
+    m_states.assign(entries, static_cast<uint8_t>(StageInfo::State::None));
+    m_namedStates.assign(entries, 0);
+    m_rows.assign(entries, -1);
+}
+
+void StageInfoStore::record(long long cycle, const RipesProcessor& processor) {
+    if (cycle < m_endCycle) {
+        // Already recorded, or evicted from the store
+        return;
+    }
+    if (empty() || cycle - m_endCycle >= static_cast<long long>(m_capacity)) {
+        // None of the currently stored cycles would remain after filling the gap up to this cycle.
+        m_firstCycle = cycle;
+        m_endCycle = cycle;
+    }
+    while (m_endCycle < cycle) {
+        appendInvalidCycle();
+    }
+
+    if (size() == m_capacity) {
+        m_firstCycle++;
+    }
+    for (unsigned stage = 0; stage < m_stages; stage++) {
+        const StageInfo info = processor.stageInfo(stage);
+        const size_t idx = slot(m_endCycle, stage);
+        m_pcs[idx] = info.pc;
+        m_valid[idx] = info.stage_valid;
+        m_states[idx] = static_cast<uint8_t>(info.state);
+        m_namedStates[idx] = internStateName(info.namedState);
+        m_rows[idx] = info.stage_valid ? addressToRow(info.pc) : -1;
+    }
+    m_endCycle++;
+}
+
+void StageInfoStore::appendInvalidCycle() {
+    if (size() == m_capacity) {
+        m_firstCycle++;
+    }
+    for (unsigned stage = 0; stage < m_stages; stage++) {
+        const size_t idx = slot(m_endCycle, stage);
+        m_pcs[idx] = 0;
+        m_valid[idx] = false;
+        m_states[idx] = static_cast<uint8_t>(StageInfo::State::None);
+        m_namedStates[idx] = 0;
+        m_rows[idx] = -1;
+    }
+    m_endCycle++;
+}
+
+StageInfo StageInfoStore::stageInfo(long long cycle, unsigned stage) const {
+    StageInfo info;
+    info.pc = pc(cycle, stage);
+    info.stage_valid = valid(cycle, stage);
+    info.state = state(cycle, stage);
+    info.namedState = namedState(cycle, stage);
+    return info;
+}
+
+int StageInfoStore::addressToRow(AInt address) const {
+    if (address < m_rowBase || (address - m_rowBase) % m_rowBytes != 0) {
+        return -1;
+    }
+    const AInt row = (address - m_rowBase) / m_rowBytes;
+    return row <= static_cast<AInt>(std::numeric_limits<int32_t>::max()) ? static_cast<int>(row) : -1;
+}
+
+uint16_t StageInfoStore::internStateName(const QString& name) {
+    if (name.isEmpty()) {
+        return 0;
+    }
+    auto it = m_stateNameIndices.find(name);
+    if (it != m_stateNameIndices.end()) {
+        return it.value();
+    }
+    if (m_stateNames.size() > std::numeric_limits<uint16_t>::max()) {
+        return 0;
+    }
+    const auto idx = static_cast<uint16_t>(m_stateNames.size());
+    m_stateNames.push_back(name);
+    m_stateNameIndices.insert(name, idx);
+    return idx;
+}
+
+}  // namespace Ripes
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+
+#include <cstdint>
+#include <vector>
+
+#include "processors/interface/ripesprocessor.h"
+
+namespace Ripes {
+
+/**
+ * @brief The StageInfoStore class
+ * Fixed-capacity ring buffer of the stage information of the most recently recorded cycles. The store is columnar: the
+ * pc, validity and state of each (cycle, stage) pair are kept in separate arrays, and named states are interned, such
+ * that recording a cycle performs no allocations.
+ * The pc of each recorded stage is additionally indexed by the row of the pipeline diagram which it maps to, such that
+ * looking up the stages of a row in a cycle is a comparison of at most stages() row indices.
+ */
+class StageInfoStore {
+public:
+    /**
+     * @brief reset
+     * Clears the store and sizes it for @p capacity cycles of a processor with @p stages stages. Instruction addresses
+     * map to rows of @p rowBytes bytes, starting at @p rowBase.
+     */
+    void reset(unsigned stages, size_t capacity, AInt rowBase, unsigned rowBytes);
+
+    /**
+     * @brief record
+     * Records the stage information of @p processor as @p cycle. Only cycles following the latest recorded cycle are
+     * recorded; any skipped cycles are recorded as having no valid stages.
+     */
+    void record(long long cycle, const RipesProcessor& processor);
+
+    /**
+     * @brief stageInfo
+     * @returns the stage information of @p stage at @p cycle. @p cycle must be contained in the store.
+     */
+    StageInfo stageInfo(long long cycle, unsigned stage) const;
+
+    bool contains(long long cycle) const { return m_firstCycle <= cycle && cycle < m_endCycle; }
+    bool empty() const { return m_firstCycle == m_endCycle; }
+    long long firstCycle() const { return m_firstCycle; }
+    long long endCycle() const { return m_endCycle; }
+    size_t size() const { return m_endCycle - m_firstCycle; }
+    unsigned stages() const { return m_stages; }
+
+    AInt pc(long long cycle, unsigned stage) const { return m_pcs[slot(cycle, stage)]; }
+    bool valid(long long cycle, unsigned stage) const { return m_valid[slot(cycle, stage)]; }
+    StageInfo::State state(long long cycle, unsigned stage) const {
+        return static_cast<StageInfo::State>(m_states[slot(cycle, stage)]);
+    }
+    const QString& namedState(long long cycle, unsigned stage) const {
+        return m_stateNames.at(m_namedStates[slot(cycle, stage)]);
+    }
+
+    /**
+     * @brief row
+     * @returns the row which the pc of @p stage at @p cycle maps to, or -1 if the stage was invalid or its pc maps to
+     * no row.
+     */
+    int row(long long cycle, unsigned stage) const { return m_rows[slot(cycle, stage)]; }
+    AInt rowAddress(int row) const { return m_rowBase + static_cast<AInt>(row) * m_rowBytes; }
+
+private:
+    size_t slot(long long cycle, unsigned stage) const { return (cycle % m_capacity) * m_stages + stage; }
+    uint16_t internStateName(const QString& name);
+    int addressToRow(AInt address) const;
+    void appendInvalidCycle();
+
+    unsigned m_stages = 0;
+    size_t m_capacity = 0;
+    long long m_firstCycle = 0;
+    long long m_endCycle = 0;
+    AInt m_rowBase = 0;
+    unsigned m_rowBytes = 4;
+
+    std::vector<AInt> m_pcs;
+    std::vector<uint8_t> m_valid;
+    std::vector<uint8_t> m_states;
+    std::vector<uint16_t> m_namedStates;
+    std::vector<int32_t> m_rows;
+
+    // Index 0 is reserved for the empty state name.
+    std::vector<QString> m_stateNames = {QString()};
+    QHash<QString, uint16_t> m_stateNameIndices;
+};
+
+}  // namespace Ripes
@@ -8,23 +8,23 @@
 
 namespace Ripes {
 
-SymbolNavigator::SymbolNavigator(const ReverseSymbolMap& symbolmap, QWidget* parent)
+SymbolNavigator::SymbolNavigator(const SymbolIndex& symbols, QWidget* parent)
     : QDialog(parent), m_ui(new Ui::SymbolNavigator) {
     m_ui->setupUi(this);
 
     setWindowTitle("Symbol navigator");
 
-    m_ui->symbolTable->setColumnCount(2);
+    m_ui->symbolTable->setColumnCount(4);
     m_ui->symbolTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     m_ui->symbolTable->setSelectionMode(QAbstractItemView::SingleSelection);
     m_ui->symbolTable->verticalHeader()->hide();
-    m_ui->symbolTable->setHorizontalHeaderLabels({"Address", "Label"});
+    m_ui->symbolTable->setHorizontalHeaderLabels({"Address", "Size", "Type", "Label"});
     m_ui->symbolTable->horizontalHeader()->setStretchLastSection(true);
     m_ui->symbolTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
     m_ui->buttonBox->button(QDialogButtonBox::Ok)->setText("Go to symbol");
 
-    for (const auto& iter : symbolmap) {
-        addSymbol(iter.first, iter.second);
+    for (const auto& symbol : symbols.symbols()) {
+        addSymbol(symbol);
     }
     m_ui->symbolTable->selectRow(0);
 }
@@ -37,23 +37,24 @@ AInt SymbolNavigator::getSelectedSymbolAddress() const {
     return 0;
 }
 
-void SymbolNavigator::addSymbol(const AInt address, const QString& label) {
-    m_ui->symbolTable->setRowCount(m_ui->symbolTable->rowCount() + 1);
-    QTableWidgetItem* addrItem = new QTableWidgetItem();
-    QTableWidgetItem* labelItem = new QTableWidgetItem();
-
-    addrItem->setData(Qt::DisplayRole, encodeRadixValue(address, Radix::Hex, ProcessorHandler::currentISA()->bytes()));
-    labelItem->setData(Qt::DisplayRole, label);
-
-    addrItem->setFlags(addrItem->flags() ^ Qt::ItemIsEditable);
-    labelItem->setFlags(labelItem->flags() ^ Qt::ItemIsEditable);
-
-    addrItem->setData(Qt::UserRole, QVariant::fromValue(address));
-    labelItem->setData(Qt::UserRole, QVariant::fromValue(address));
+void SymbolNavigator::addSymbol(const SymbolInfo& symbol) {
+    static const std::map<SymbolInfo::Kind, QString> s_kindNames = {{SymbolInfo::Kind::Label, "Label"},
+                                                                    {SymbolInfo::Kind::Function, "Function"},
+                                                                    {SymbolInfo::Kind::Object, "Object"},
+                                                                    {SymbolInfo::Kind::Section, "Section"}};
 
+    m_ui->symbolTable->setRowCount(m_ui->symbolTable->rowCount() + 1);
     const int row = m_ui->symbolTable->rowCount() - 1;
-    m_ui->symbolTable->setItem(row, 0, addrItem);
-    m_ui->symbolTable->setItem(row, 1, labelItem);
+    const QStringList columns = {
+        encodeRadixValue(symbol.address, Radix::Hex, ProcessorHandler::currentISA()->bytes()),
+        symbol.size != 0 ? QString::number(symbol.size) : QString(), s_kindNames.at(symbol.kind), symbol.name};
+    for (int column = 0; column < columns.size(); column++) {
+        QTableWidgetItem* item = new QTableWidgetItem();
+        item->setData(Qt::DisplayRole, columns[column]);
+        item->setFlags(item->flags() ^ Qt::ItemIsEditable);
+        item->setData(Qt::UserRole, QVariant::fromValue(symbol.address));
+        m_ui->symbolTable->setItem(row, column, item);
+    }
 }
 
 SymbolNavigator::~SymbolNavigator() {
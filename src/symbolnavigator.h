@@ -14,13 +14,13 @@ class SymbolNavigator : public QDialog {
     Q_OBJECT
 
 public:
-    SymbolNavigator(const ReverseSymbolMap& symbolmap, QWidget* parent = nullptr);
+    SymbolNavigator(const SymbolIndex& symbols, QWidget* parent = nullptr);
     ~SymbolNavigator();
 
     AInt getSelectedSymbolAddress() const;
 
 private:
-    void addSymbol(const AInt address, const QString& label);
+    void addSymbol(const SymbolInfo& symbol);
 
     Ui::SymbolNavigator* m_ui;
 };
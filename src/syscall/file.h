@@ -20,13 +20,7 @@ public:
     void execute() {
         const AInt arg0 = BaseSyscall::getArg(RegisterFileType::GPR, 0);
         const AInt arg1 = BaseSyscall::getArg(RegisterFileType::GPR, 1);
-        QByteArray string;
-        char byte;
-        unsigned int address = arg0;
-        do {
-            byte = static_cast<char>(ProcessorHandler::getMemory().readMemConst(address++, 1) & 0xFF);
-            string.append(byte);
-        } while (byte != '\0');
+        const QByteArray string = ProcessorHandler::readMemCString(arg0);
 
         int ret = SystemIO::openFile(QString::fromUtf8(string), arg1);
 
@@ -76,6 +70,9 @@ public:
               "Read", "Read from a file descriptor into a buffer",
               {{0, "the file descriptor"}, {1, "address of the buffer"}, {2, "maximum number of bytes to read"}},
               {{0, "number of read bytes or -1 if an error occurred"}}) {}
+    bool blocksOnInput() const override {
+        return static_cast<int>(BaseSyscall::getArg(RegisterFileType::GPR, 0)) == SystemIO::STDIN;
+    }
     void execute() {
         const int fd = BaseSyscall::getArg(RegisterFileType::GPR, 0);
         int byteAddress = BaseSyscall::getArg(RegisterFileType::GPR, 1);  // destination of characters read from file
@@ -86,12 +83,9 @@ public:
         BaseSyscall::setRet(RegisterFileType::GPR, 0, retLength);
 
         if (retLength != -1) {
-            // copy bytes from returned buffer into memory
-            const char* dataptr = buffer.constData();  // QString::data contains a possible null termination '\0'
-                                                       // character (present if reading from stdin and not from a file)
-            while (retLength-- > 0) {
-                ProcessorHandler::writeMem(byteAddress++, *dataptr++, sizeof(char));
-            }
+            // copy bytes from returned buffer into memory. The buffer may contain a null termination '\0' character
+            // (present if reading from stdin and not from a file) beyond the returned length.
+            ProcessorHandler::writeMemBlock(byteAddress, buffer.left(retLength));
         }
     }
 };
@@ -112,13 +106,7 @@ public:
             BaseSyscall::setRet(RegisterFileType::GPR, 0, -1);
             return;
         }
-        int index = 0;
-        QString myBuffer;
-
-        do {
-            myBuffer.append(
-                static_cast<char>(ProcessorHandler::getMemory().readMemConst(byteAddress + index++, 1) & 0xFF));
-        } while (index < reqLength);
+        const QString myBuffer = QString::fromLatin1(ProcessorHandler::readMemBlock(byteAddress, reqLength));
 
         const int retValue = SystemIO::writeToFile(BaseSyscall::getArg(RegisterFileType::GPR, 0), myBuffer, reqLength);
         BaseSyscall::setRet(RegisterFileType::GPR, 0, retValue);
@@ -137,7 +125,6 @@ public:
     void execute() {
         const int byteAddress =
             BaseSyscall::getArg(RegisterFileType::GPR, 0);  // destination of characters read from file
-        int index = 0;
         const int bufferSize = BaseSyscall::getArg(RegisterFileType::GPR, 1);
 
         const QString pwd = QDir::currentPath();
@@ -150,9 +137,7 @@ public:
         }
 
         // copy bytes from returned buffer into memory
-        while (index < pwd.length()) {
-            ProcessorHandler::writeMem(byteAddress, pwd.at(index++).toLatin1(), sizeof(char));
-        }
+        ProcessorHandler::writeMemBlock(byteAddress, pwd.toLatin1());
     }
 };
 
@@ -42,14 +42,7 @@ public:
     PrintStrSyscall() : BaseSyscall("PrintString", "Prints a null-terminated string", {{0, "address of the string"}}) {}
     void execute() {
         const VInt arg0 = BaseSyscall::getArg(RegisterFileType::GPR, 0);
-        QByteArray string;
-        char byte;
-        AInt address = arg0;
-        do {
-            byte = static_cast<char>(ProcessorHandler::getMemory().readMemConst(address++) & 0xFF);
-            string.append(byte);
-        } while (byte != '\0');
-        SystemIO::printString(QString::fromUtf8(string));
+        SystemIO::printString(QString::fromUtf8(ProcessorHandler::readMemCString(arg0)));
     }
 };
 
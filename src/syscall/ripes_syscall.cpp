@@ -1,25 +1,36 @@
 #include "ripes_syscall.h"
 
 #include "processorhandler.h"
+#include "systemio.h"
 
 namespace Ripes {
 
 bool SyscallManager::execute(SyscallID id) {
-    if (m_syscalls.count(id) == 0) {
-        postToGUIThread([=] {
-            QMessageBox::warning(
-                nullptr, "Error",
-                "Unknown system call in register '" +
-                    ProcessorHandler::currentISA()->regAlias(ProcessorHandler::currentISA()->syscallReg()) + "': " +
-                    QString::number(id) + "\nRefer to \"Help->System calls\" for a list of support system calls.");
-        });
+    auto* syscall = getSyscall(id);
+    if (!syscall) {
+        const QString message =
+            "Unknown system call in register '" +
+            ProcessorHandler::currentISA()->regAlias(ProcessorHandler::currentISA()->syscallReg()) + "': " +
+            QString::number(id);
+        if (SystemIO::isHeadless()) {
+            SystemIO::reportSyscallError(message);
+        } else {
+            postToGUIThread([=] {
+                QMessageBox::warning(
+                    nullptr, "Error",
+                    message + "\nRefer to \"Help->System calls\" for a list of support system calls.");
+            });
+        }
         return false;
-    } else {
-        const auto& syscall = m_syscalls.at(id);
+    } else if (syscall->blocksOnInput()) {
         SyscallStatusManager::setStatus("Handling system call: " + syscall->name() + " (" + QString::number(id) + ")");
         syscall->execute();
         SyscallStatusManager::clearStatus();
         return true;
+    } else {
+        // Other syscalls complete immediately; a status message would only flood the GUI thread with events.
+        syscall->execute();
+        return true;
     }
 }
 
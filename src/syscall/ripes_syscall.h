@@ -10,6 +10,7 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <vector>
 
 #include "../isa/isainfo.h"
 #include "ripes_types.h"
@@ -40,6 +41,13 @@ public:
 
     virtual void execute() = 0;
 
+    /**
+     * @brief blocksOnInput
+     * @returns true if executing the syscall, given the current argument registers, may block while waiting for user
+     * input.
+     */
+    virtual bool blocksOnInput() const { return false; }
+
     /**
      * @brief getArg
      * ABI specific specialization of returning an argument register value.
@@ -80,10 +88,19 @@ public:
     using SyscallID = int;
     /**
      * @brief execute
-     * Executes the syscall identified by id. Throws out of range exception if syscall @p id is unknown.
+     * Executes the syscall identified by id.
+     * @returns false if syscall @p id is unknown.
      */
     bool execute(SyscallID id);
 
+    /**
+     * @brief getSyscall
+     * @returns the syscall identified by @p id, or nullptr if unknown.
+     */
+    Syscall* getSyscall(SyscallID id) const {
+        return id >= 0 && static_cast<size_t>(id) < m_syscallTable.size() ? m_syscallTable[id] : nullptr;
+    }
+
     const std::map<SyscallID, std::unique_ptr<Syscall>>& getSyscalls() const { return m_syscalls; }
 
 protected:
@@ -101,6 +118,13 @@ protected:
 
     SyscallManager() {}
     std::map<SyscallID, std::unique_ptr<Syscall>> m_syscalls;
+
+    /**
+     * @brief m_syscallTable
+     * Syscalls of m_syscalls indexed by their ID, for constant time lookup when executing a syscall. IDs are small
+     * integers, so the table is kept flat.
+     */
+    std::vector<Syscall*> m_syscallTable;
 };
 
 template <class T>
@@ -111,8 +135,12 @@ public:
     template <class T_Syscall>
     void emplace(SyscallID id) {
         static_assert(std::is_base_of<T, T_Syscall>::value);
-        assert(m_syscalls.count(id) == 0);
-        m_syscalls.emplace(id, std::make_unique<T_Syscall>());
+        assert(m_syscalls.count(id) == 0 && id >= 0);
+        auto* syscall = m_syscalls.emplace(id, std::make_unique<T_Syscall>()).first->second.get();
+        if (static_cast<size_t>(id) >= m_syscallTable.size()) {
+            m_syscallTable.resize(id + 1, nullptr);
+        }
+        m_syscallTable[id] = syscall;
     }
 };
 
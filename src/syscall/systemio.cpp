@@ -11,4 +11,5 @@ QByteArray SystemIO::FileIOData::s_stdinBuffer;
 QMutex SystemIO::FileIOData::s_stdioMutex;
 QWaitCondition SystemIO::FileIOData::s_stdinBufferEmpty;
 bool SystemIO::s_abortSyscall = false;
+bool SystemIO::s_headless = false;
 }  // namespace Ripes
@@ -11,6 +11,7 @@
 #include <QWaitCondition>
 
 #include <sys/stat.h>
+#include <optional>
 #include <stdexcept>
 
 #include "statusmanager.h"
@@ -69,6 +70,9 @@ private:
     // Flag used for aborting waiting for I/O
     static bool s_abortSyscall;
 
+    // Set when simulating without a user to provide input or acknowledge errors, see setHeadless.
+    static bool s_headless;
+
     // Standard I/O Channels
     enum STDIO { STDIN = 0, STDOUT = 1, STDERR = 2, STDIO_END };
 
@@ -334,6 +338,18 @@ public:
                 // Lock the stdio objects and try to read from stdio. If no data is present, wait until so.
                 FileIOData::s_stdioMutex.lock();
                 while (myBuffer.size() == 0) {
+                    // Data which is already present in the stdin buffer (ie. data entered before the read was
+                    // requested, or data which is being read again after rewinding the stream) is consumed directly.
+                    if (!InputStream.atEnd()) {
+                        myBuffer = InputStream.read(lengthRequested).toUtf8();
+                        break;
+                    }
+                    if (s_headless) {
+                        // No further input will arrive; the provided data has been consumed.
+                        FileIOData::s_stdioMutex.unlock();
+                        SystemIOStatusManager::clearStatus();
+                        return 0;
+                    }
                     /** We spin on a wait condition with a timeout. The timeout is required to ensure that we may
                      * observe any abort flags (ie. if execution is stopped while waiting for IO */
                     const bool dataInStdinStrm = FileIOData::s_stdinBufferEmpty.wait(&FileIOData::s_stdioMutex, 100);
@@ -407,10 +423,133 @@ public:
 
     static void printString(const QString& string) { emit get().doPrint(string); }
     static void reset() { FileIOData::resetFiles(); }
+
+    /**
+     * @brief The State struct
+     * The files opened by the simulated program alongside their current positions, and any stdin data which has not
+     * yet been consumed. Used for checkpointing. The stdin data is omitted if @p includeStdin is false in getState.
+     */
+    struct FileState {
+        int fd;
+        std::string name;
+        unsigned flags;
+        qint64 pos;
+        qint64 size;
+
+        template <class Archive>
+        void serialize(Archive& archive) {
+            archive(fd, name, flags, pos, size);
+        }
+    };
+    struct State {
+        std::vector<FileState> files;
+        std::string stdinData;
+
+        template <class Archive>
+        void serialize(Archive& archive) {
+            archive(files, stdinData);
+        }
+    };
+
+    static State getState(bool includeStdin = true) {
+        SystemIO::get();  // Ensure that SystemIO is constructed
+        State state;
+        for (int fd = STDIO_END; fd < SYSCALL_MAXFILES; fd++) {
+            if (FileIOData::fileNames.count(fd) && !FileIOData::fileNames.at(fd).isEmpty()) {
+                state.files.push_back({fd, FileIOData::fileNames.at(fd).toStdString(), FileIOData::fileFlags.at(fd),
+                                       FileIOData::getStreamInUse(fd).pos(), FileIOData::files.at(fd).size()});
+            }
+        }
+        if (includeStdin) {
+            FileIOData::s_stdioMutex.lock();
+            state.stdinData = FileIOData::s_stdinBuffer.mid(FileIOData::getStreamInUse(STDIN).pos()).toStdString();
+            FileIOData::s_stdioMutex.unlock();
+        }
+        return state;
+    }
+
+    /**
+     * @brief setState
+     * Resets all files and stdin, and restores the files and stdin data of @p state; see restoreFiles.
+     * @returns an error message if a file could not be reopened.
+     */
+    static std::optional<QString> setState(const State& state) {
+        reset();
+        auto error = restoreFiles(state.files);
+        get().putStdInData(QByteArray::fromStdString(state.stdinData));
+        return error;
+    }
+
+    /**
+     * @brief restoreFiles
+     * Closes all files opened by the program, and reopens @p files at their recorded positions. The stdin stream is
+     * left untouched. Files are reopened without truncation, such that output written before the state was captured is
+     * retained; output written to a writeable file after the state was captured is discarded.
+     * @returns an error message if a file could not be reopened.
+     */
+    static std::optional<QString> restoreFiles(const std::vector<FileState>& files) {
+        SystemIO::get();  // Ensure that SystemIO is constructed
+        for (int fd = STDIO_END; fd < SYSCALL_MAXFILES; fd++) {
+            FileIOData::close(fd);
+        }
+        std::optional<QString> error;
+        for (const auto& file : files) {
+            const QString filename = QString::fromStdString(file.name);
+            if (file.flags & (O_WRONLY | O_RDWR) && QFile(filename).size() > file.size) {
+                QFile::resize(filename, file.size);
+            }
+            FileIOData::fileNames[file.fd] = filename;
+            FileIOData::fileFlags[file.fd] = file.flags & ~(O_TRUNC | O_EXCL);
+            try {
+                FileIOData::openFilestream(file.fd, filename);
+            } catch (const std::runtime_error& e) {
+                FileIOData::fileNames.erase(file.fd);
+                error = "File " + filename + " could not be reopened: " + e.what();
+                continue;
+            }
+            FileIOData::getStreamInUse(file.fd).seek(file.pos);
+        }
+        return error;
+    }
+
+    /**
+     * @brief stdinPos/rewindStdin
+     * Position of the stdin stream within all stdin data received since the last reset. Rewinding the stream to an
+     * earlier position makes the data consumed since then available for reading again, as is required when
+     * re-executing a program from an earlier state.
+     */
+    static qint64 stdinPos() {
+        SystemIO::get();  // Ensure that SystemIO is constructed
+        QMutexLocker lock(&FileIOData::s_stdioMutex);
+        return FileIOData::getStreamInUse(STDIN).pos();
+    }
+    static void rewindStdin(qint64 pos) {
+        SystemIO::get();  // Ensure that SystemIO is constructed
+        QMutexLocker lock(&FileIOData::s_stdioMutex);
+        FileIOData::getStreamInUse(STDIN).seek(pos);
+    }
+
     static void abortSyscall(bool state) { s_abortSyscall = state; }
 
+    /**
+     * @brief setHeadless
+     * In headless mode, there is no user to provide input or to acknowledge errors. Reading from stdin returns
+     * end-of-file once the stdin data which was provided up front has been consumed, rather than waiting for input, and
+     * system call errors are reported through syscallError rather than shown in a dialog.
+     */
+    static void setHeadless(bool headless) { s_headless = headless; }
+    static bool isHeadless() { return s_headless; }
+
+    static void reportSyscallError(const QString& message) { emit get().syscallError(message); }
+
 signals:
     void doPrint(const QString&);
+    /**
+     * @brief syscallError
+     * Emitted in headless mode, from the thread which handles the system call, when a system call fails in a way which
+     * stops the simulation.
+     */
+    void syscallError(const QString& message);
 
 public slots:
     /**
@@ -1,14 +1,23 @@
+#include <QTemporaryDir>
+#include <QtEndian>
 #include <QtTest/QTest>
 
+#include <functional>
+
 #include "assembler/instruction.h"
 #include "assembler/matcher.h"
+#include "assembler/parserutilities.h"
 #include "isa/isainfo.h"
 #include "isa/rv32isainfo.h"
+#include "isa/rv64isainfo.h"
 
 #include "assembler/rv32i_assembler.h"
 #include "assembler/rv64i_assembler.h"
 
 #include "processorhandler.h"
+#include "programutilities.h"
+
+#include "elfio/elfio.hpp"
 
 using namespace Ripes;
 using namespace Assembler;
@@ -33,12 +42,18 @@ private slots:
     void tst_simpleWithBranch();
     void tst_segment();
     void tst_matcher();
+    void tst_decoder();
     void tst_label();
     void tst_labelWithPseudo();
     void tst_weirdImmediates();
     void tst_weirdDirectives();
     void tst_edgeImmediates();
     void tst_benchmarkNew();
+    void tst_incremental();
+    void tst_lexer();
+    void tst_parallel();
+    void tst_symbolIndex();
+    void tst_loadElf();
     void tst_invalidreg();
     void tst_expression();
     void tst_invalidLabel();
@@ -93,6 +108,47 @@ private:
             }
         }
     }
+
+    /**
+     * @brief testDecoder
+     * Assembles each of @p instructions, given as mnemonic and operands, and verifies that the table decoder of
+     * @p assembler matches each assembled word to the same instruction as a search of the match tree. Each of
+     * @p unknownWords is expected to match no instruction.
+     */
+    template <typename Assembler_T>
+    void testDecoder(Assembler_T& assembler, const std::vector<std::pair<QString, QString>>& instructions,
+                     const std::vector<uint32_t>& unknownWords) {
+        using Instr_T = const typename Assembler_T::_Instruction*;
+        QStringList program;
+        for (const auto& instr : instructions) {
+            // Branches and jumps target the first instruction.
+            program << (program.isEmpty() ? "L: " : "") + instr.first + " " + instr.second;
+        }
+        const auto res = assembler.assemble(program);
+        if (res.errors.size() != 0) {
+            res.errors.print();
+            QFAIL("Could not assemble instructions");
+        }
+        const QByteArray& text = res.program.getSection(".text")->data;
+        QCOMPARE(static_cast<size_t>(text.size()), instructions.size() * sizeof(uint32_t));
+
+        const auto& matcher = assembler.getMatcher();
+        for (size_t i = 0; i < instructions.size(); i++) {
+            const uint32_t word = qFromLittleEndian<uint32_t>(text.constData() + i * sizeof(uint32_t));
+            const auto match = matcher.matchInstruction(word);
+            const auto treeMatch = matcher.matchInstructionTree(word);
+            const auto* instr = std::get_if<Instr_T>(&match);
+            const auto* treeInstr = std::get_if<Instr_T>(&treeMatch);
+            QVERIFY2(instr && treeInstr, instructions[i].first.toStdString().c_str());
+            QCOMPARE(QString((*instr)->name()), instructions[i].first);
+            QVERIFY(*instr == *treeInstr);
+        }
+
+        for (const uint32_t word : unknownWords) {
+            QVERIFY(std::holds_alternative<Error>(matcher.matchInstruction(word)));
+            QVERIFY(std::holds_alternative<Error>(matcher.matchInstructionTree(word)));
+        }
+    }
 };
 
 struct RVTestTuple {
@@ -255,6 +311,277 @@ void tst_Assembler::tst_benchmarkNew() {
     QBENCHMARK { assembler.assembleRaw(program); }
 }
 
+void tst_Assembler::tst_incremental() {
+    // Incrementally reassembling a program while it is edited must yield the same result as a full assembly.
+    auto isa = std::make_unique<ISAInfo<ISA::RV32I>>(QStringList());
+    auto incremental = RV32I_Assembler(isa.get());
+    incremental.setIncremental(true);
+
+    auto program = createProgram(100).split('\n');
+    const auto edits = std::vector<std::function<void(QStringList&)>>{
+        [](QStringList&) {},
+        // Edit an instruction
+        [](QStringList& p) { p[105] = "LA1: addi a0 a0 2"; },
+        // Insert lines, shifting all following lines and addresses
+        [](QStringList& p) { p.insert(110, "li a1 0x12345678"); },
+        [](QStringList& p) { p.insert(3, "X: .word 5"); },
+        // Introduce errors, and fix them again
+        [](QStringList& p) { p[120] = "addi a0 a0"; },
+        [](QStringList& p) { p.insert(0, "LA5: nop"); },
+        [](QStringList& p) { p.removeFirst(); },
+        [](QStringList& p) { p[120] = "addi a0 a0 3"; },
+        // Duplicated lines
+        [](QStringList& p) { p.insert(50, p.at(150)); },
+        // Pseudo-op expansion depending on constants
+        [](QStringList& p) {
+            p.insert(0, ".equ C, 4");
+            p.insert(150, "li a0 C");
+        },
+        [](QStringList& p) { p[0] = ".equ C, 0x7FFFF"; },
+    };
+
+    for (const auto& edit : edits) {
+        edit(program);
+        auto reference = RV32I_Assembler(isa.get());
+        const auto expected = reference.assemble(program);
+        const auto actual = incremental.assemble(program);
+
+        QCOMPARE(actual.errors.size(), expected.errors.size());
+        for (size_t i = 0; i < expected.errors.size(); i++) {
+            QCOMPARE(actual.errors.at(i).first, expected.errors.at(i).first);
+            QCOMPARE(actual.errors.at(i).second, expected.errors.at(i).second);
+        }
+        if (expected.errors.size() != 0) {
+            continue;
+        }
+        for (const auto& section : {".text", ".data"}) {
+            QCOMPARE(actual.program.getSection(section)->data, expected.program.getSection(section)->data);
+        }
+        QVERIFY(actual.program.symbols == expected.program.symbols);
+    }
+}
+
+void tst_Assembler::tst_parallel() {
+    // Parallel assembly must yield the same program and errors as sequential assembly.
+    auto isa = std::make_unique<ISAInfo<ISA::RV32I>>(QStringList());
+    auto program = createProgram(5000).split('\n');
+    auto erroneous = program;
+    erroneous[3] = "L1: .word 5";
+    erroneous[7000] = "addi a0 a0 (1";
+    erroneous[19000] = "A: B: A: nop";
+
+    for (const auto& p : {program, erroneous}) {
+        auto sequential = RV32I_Assembler(isa.get());
+        auto parallel = RV32I_Assembler(isa.get());
+        parallel.setParallel(true);
+        const auto expected = sequential.assemble(p);
+        const auto actual = parallel.assemble(p);
+
+        QCOMPARE(actual.errors.size(), expected.errors.size());
+        for (size_t i = 0; i < expected.errors.size(); i++) {
+            QCOMPARE(actual.errors.at(i).first, expected.errors.at(i).first);
+            QCOMPARE(actual.errors.at(i).second, expected.errors.at(i).second);
+        }
+        if (expected.errors.size() != 0) {
+            continue;
+        }
+        for (const auto& section : {".text", ".data"}) {
+            QCOMPARE(actual.program.getSection(section)->data, expected.program.getSection(section)->data);
+        }
+    }
+}
+
+void tst_Assembler::tst_lexer() {
+    const std::vector<std::pair<QString, QStringList>> lines = {
+        {"addi a0, a0 ,1", {"addi", "a0", "a0", "1"}},
+        {"B:nop # comment (", {"B:", "nop"}},
+        {"A: B:\tlw x10 (123 + (4* 3))(x10)", {"A:", "B:", "lw", "x10", "123+(4*3)", "x10"}},
+        {"addi a0 a0 1# comment", {"addi", "a0", "a0", "1"}},
+        {"s: .string \"a, b: (c # d\"", {"s:", ".string", "\"a, b: (c # d\""}},
+        {"   ", {}},
+    };
+    for (const auto& line : lines) {
+        const auto res = lexLine(line.first, '#');
+        QVERIFY(std::holds_alternative<LineTokens>(res));
+        QStringList tokens;
+        for (const auto& token : std::get<LineTokens>(res)) {
+            tokens << token;
+        }
+        QCOMPARE(tokens, line.second);
+    }
+
+    QVERIFY(std::holds_alternative<Error>(lexLine("lw x10 (4(x10)", '#')));
+    QVERIFY(std::holds_alternative<Error>(lexLine("lw x10 4)(x10)", '#')));
+    QVERIFY(std::holds_alternative<Error>(lexLine("lw x10 [4)", '#')));
+}
+
+void tst_Assembler::tst_symbolIndex() {
+    using Kind = SymbolInfo::Kind;
+    const SymbolIndex index({{".text", 0x0, 0x100, Kind::Section},
+                             {"main", 0x10, 0x20, Kind::Function},
+                             {"helper", 0x40, 0x10, Kind::Function},
+                             {"inner", 0x18, 0x4, Kind::Function},
+                             {".data", 0x200, 0x40, Kind::Section},
+                             {"table", 0x210, 0x8, Kind::Object}});
+
+    const auto nameAt = [&](AInt address) {
+        const auto* symbol = index.containing(address);
+        return symbol ? symbol->name : QString();
+    };
+    QCOMPARE(nameAt(0x0), QString(".text"));
+    QCOMPARE(nameAt(0x10), QString("main"));
+    QCOMPARE(nameAt(0x18), QString("inner"));
+    QCOMPARE(nameAt(0x1C), QString("main"));
+    QCOMPARE(nameAt(0x2F), QString("main"));
+    QCOMPARE(nameAt(0x30), QString(".text"));
+    QCOMPARE(nameAt(0x4C), QString("helper"));
+    QCOMPARE(nameAt(0x100), QString());
+    QCOMPARE(nameAt(0x214), QString("table"));
+    QCOMPARE(nameAt(0x218), QString(".data"));
+    QCOMPARE(nameAt(0x240), QString());
+    QCOMPARE(index.symbols().front().name, QString(".text"));
+
+    // Unsized labels extend up until the next label
+    const auto labels = SymbolIndex::fromSymbolMap({{0x0, Symbol("A")}, {0x8, Symbol("B")}});
+    QCOMPARE(labels.containing(0x4)->name, QString("A"));
+    QCOMPARE(labels.containing(0x8)->name, QString("B"));
+    QVERIFY(labels.containing(0x9) == nullptr);
+}
+
+namespace {
+
+/**
+ * Builds an ELF image of a single loadable segment holding @p text at @p address, followed by @p bssSize bytes of
+ * .bss. The image consists of the ELF header, the program header, the segment contents, the section name string table
+ * and the section headers, in that order. Fields are written in host byte order; the test assumes a little-endian host.
+ */
+template <typename Ehdr, typename Phdr, typename Shdr>
+QByteArray buildElfImage(unsigned char elfClass, AInt address, const QByteArray& text, AInt bssSize) {
+    using namespace ELFIO;
+    const QByteArray shstrtab("\0.text\0.bss\0.shstrtab\0", 23);
+    const quint64 textOffset = sizeof(Ehdr) + sizeof(Phdr);
+    const quint64 shstrtabOffset = textOffset + text.size();
+    const quint64 shoff = shstrtabOffset + shstrtab.size();
+
+    Ehdr ehdr{};
+    ehdr.e_ident[EI_MAG0] = ELFMAG0;
+    ehdr.e_ident[EI_MAG1] = ELFMAG1;
+    ehdr.e_ident[EI_MAG2] = ELFMAG2;
+    ehdr.e_ident[EI_MAG3] = ELFMAG3;
+    ehdr.e_ident[EI_CLASS] = elfClass;
+    ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+    ehdr.e_ident[EI_VERSION] = EV_CURRENT;
+    ehdr.e_type = ET_EXEC;
+    ehdr.e_machine = EM_RISCV;
+    ehdr.e_version = EV_CURRENT;
+    ehdr.e_entry = address;
+    ehdr.e_phoff = sizeof(Ehdr);
+    ehdr.e_shoff = shoff;
+    ehdr.e_ehsize = sizeof(Ehdr);
+    ehdr.e_phentsize = sizeof(Phdr);
+    ehdr.e_phnum = 1;
+    ehdr.e_shentsize = sizeof(Shdr);
+    ehdr.e_shnum = 4;
+    ehdr.e_shstrndx = 3;
+
+    Phdr phdr{};
+    phdr.p_type = PT_LOAD;
+    phdr.p_offset = textOffset;
+    phdr.p_vaddr = address;
+    phdr.p_paddr = address;
+    phdr.p_filesz = text.size();
+    phdr.p_memsz = text.size() + bssSize;
+
+    Shdr shdrs[4]{};
+    shdrs[1].sh_name = 1;
+    shdrs[1].sh_type = SHT_PROGBITS;
+    shdrs[1].sh_flags = SHF_ALLOC | SHF_EXECINSTR;
+    shdrs[1].sh_addr = address;
+    shdrs[1].sh_offset = textOffset;
+    shdrs[1].sh_size = text.size();
+    shdrs[2].sh_name = 7;
+    shdrs[2].sh_type = SHT_NOBITS;
+    shdrs[2].sh_flags = SHF_ALLOC | SHF_WRITE;
+    shdrs[2].sh_addr = address + text.size();
+    shdrs[2].sh_offset = shstrtabOffset;
+    shdrs[2].sh_size = bssSize;
+    shdrs[3].sh_name = 12;
+    shdrs[3].sh_type = SHT_STRTAB;
+    shdrs[3].sh_offset = shstrtabOffset;
+    shdrs[3].sh_size = shstrtab.size();
+
+    QByteArray image;
+    image.append(reinterpret_cast<const char*>(&ehdr), sizeof(ehdr));
+    image.append(reinterpret_cast<const char*>(&phdr), sizeof(phdr));
+    image.append(text);
+    image.append(shstrtab);
+    image.append(reinterpret_cast<const char*>(shdrs), sizeof(shdrs));
+    return image;
+}
+
+bool loadElfBytes(const QByteArray& image, Program& program) {
+    QTemporaryDir dir;
+    QFile file(dir.filePath("image.elf"));
+    if (!dir.isValid() || !file.open(QIODevice::WriteOnly) || file.write(image) != image.size()) {
+        return false;
+    }
+    file.close();
+    return loadElfFile(program, file);
+}
+
+}  // namespace
+
+void tst_Assembler::tst_loadElf() {
+    using namespace ELFIO;
+    const QByteArray text("\x13\x05\x10\x00\x93\x05\x20\x00", 8);  // li a0, 1; li a1, 2
+    constexpr AInt address = 0x1000;
+    constexpr AInt bssSize = 0x40;
+
+    const auto images = {
+        buildElfImage<Elf32_Ehdr, Elf32_Phdr, Elf32_Shdr>(ELFCLASS32, address, text, bssSize),
+        buildElfImage<Elf64_Ehdr, Elf64_Phdr, Elf64_Shdr>(ELFCLASS64, address, text, bssSize),
+    };
+    for (const auto& image : images) {
+        Program program;
+        QVERIFY(loadElfBytes(image, program));
+        QCOMPARE(program.entryPoint, address);
+
+        QCOMPARE(program.segments.size(), size_t(1));
+        const auto& segment = program.segments.front();
+        QCOMPARE(segment.address, address);
+        QCOMPARE(segment.data, text);
+        QCOMPARE(segment.zeroFillSize, bssSize);
+
+        // The allocated .text section refers to the segment data rather than holding a copy of its own.
+        const auto* textSection = program.getSection(".text");
+        QVERIFY(textSection);
+        QCOMPARE(textSection->address, address);
+        QCOMPARE(textSection->data, text);
+        QVERIFY(textSection->data.constData() == segment.data.constData());
+
+        const auto* bssSection = program.getSection(".bss");
+        QVERIFY(bssSection);
+        QCOMPARE(bssSection->address, address + text.size());
+        QVERIFY(bssSection->data.isEmpty());
+        QCOMPARE(bssSection->zeroFillSize, bssSize);
+
+        // Sections outside of the segments are copied.
+        const auto* shstrtab = program.getSection(".shstrtab");
+        QVERIFY(shstrtab);
+        QCOMPARE(shstrtab->data.size(), 23);
+
+        // Images truncated within the ELF header, the program headers, a segment or the section headers are rejected.
+        const bool is64 = image.at(EI_CLASS) == ELFCLASS64;
+        const int ehdrSize = is64 ? sizeof(Elf64_Ehdr) : sizeof(Elf32_Ehdr);
+        const int phdrSize = is64 ? sizeof(Elf64_Phdr) : sizeof(Elf32_Phdr);
+        for (const int size : {EI_NIDENT, ehdrSize - 1, ehdrSize + phdrSize - 1, ehdrSize + phdrSize + 4,
+                               static_cast<int>(image.size()) - 1}) {
+            Program truncated;
+            QVERIFY2(!loadElfBytes(image.left(size), truncated), QByteArray::number(size).constData());
+        }
+    }
+}
+
 void tst_Assembler::tst_simpleprogram() {
     testAssemble(QStringList() << ".data"
                                << "B: .word 1, 2, 2"
@@ -366,5 +693,47 @@ void tst_Assembler::tst_matcher() {
     }
 }
 
+void tst_Assembler::tst_decoder() {
+    const std::vector<std::pair<QString, QString>> rv32im = {
+        {"lui", "a0, 0x12345"},   {"auipc", "a0, 0x12345"},  {"jal", "ra, L"},          {"jalr", "ra, a0, 4"},
+        {"beq", "a0, a1, L"},     {"bne", "a0, a1, L"},      {"blt", "a0, a1, L"},      {"bge", "a0, a1, L"},
+        {"bltu", "a0, a1, L"},    {"bgeu", "a0, a1, L"},     {"lb", "a0, 4(a1)"},       {"lh", "a0, 4(a1)"},
+        {"lw", "a0, 4(a1)"},      {"lbu", "a0, 4(a1)"},      {"lhu", "a0, 4(a1)"},      {"sb", "a0, 4(a1)"},
+        {"sh", "a0, 4(a1)"},      {"sw", "a0, 4(a1)"},       {"addi", "a0, a1, -4"},    {"slti", "a0, a1, -4"},
+        {"sltiu", "a0, a1, 4"},   {"xori", "a0, a1, -1"},    {"ori", "a0, a1, 4"},      {"andi", "a0, a1, 4"},
+        {"slli", "a0, a1, 3"},    {"srli", "a0, a1, 3"},     {"srai", "a0, a1, 3"},     {"add", "a0, a1, a2"},
+        {"sub", "a0, a1, a2"},    {"sll", "a0, a1, a2"},     {"slt", "a0, a1, a2"},     {"sltu", "a0, a1, a2"},
+        {"xor", "a0, a1, a2"},    {"srl", "a0, a1, a2"},     {"sra", "a0, a1, a2"},     {"or", "a0, a1, a2"},
+        {"and", "a0, a1, a2"},    {"ecall", ""},             {"mul", "a0, a1, a2"},     {"mulh", "a0, a1, a2"},
+        {"mulhsu", "a0, a1, a2"}, {"mulhu", "a0, a1, a2"},   {"div", "a0, a1, a2"},     {"divu", "a0, a1, a2"},
+        {"rem", "a0, a1, a2"},    {"remu", "a0, a1, a2"}};
+    const std::vector<std::pair<QString, QString>> rv64imOnly = {
+        {"slli", "a0, a1, 33"}, {"addiw", "a0, a1, -4"}, {"slliw", "a0, a1, 3"},  {"srliw", "a0, a1, 3"},
+        {"sraiw", "a0, a1, 3"}, {"addw", "a0, a1, a2"},  {"subw", "a0, a1, a2"},  {"sllw", "a0, a1, a2"},
+        {"srlw", "a0, a1, a2"}, {"sraw", "a0, a1, a2"},  {"lwu", "a0, 4(a1)"},    {"ld", "a0, 4(a1)"},
+        {"sd", "a0, 4(a1)"},    {"mulw", "a0, a1, a2"},  {"divw", "a0, a1, a2"},  {"divuw", "a0, a1, a2"},
+        {"remw", "a0, a1, a2"}, {"remuw", "a0, a1, a2"}};
+
+    // Unknown opcode, all ones, OP with an unknown funct7, BRANCH with an unknown funct3 and ebreak, which is not
+    // implemented.
+    const std::vector<uint32_t> unknownWords = {0x00000000, 0xffffffff, 0xfe000033, 0x00002063, 0x00100073};
+
+    auto isa32 = std::make_unique<ISAInfo<ISA::RV32I>>(QStringList("M"));
+    auto assembler32 = RV32I_Assembler(isa32.get());
+    // addw, ld and slli with a 6-bit shift amount are RV64 only.
+    auto unknownWords32 = unknownWords;
+    unknownWords32.insert(unknownWords32.end(), {0x00b5053b, 0x0045b503, 0x02159513});
+    testDecoder(assembler32, rv32im, unknownWords32);
+
+    auto isa64 = std::make_unique<ISAInfo<ISA::RV64I>>(QStringList("M"));
+    auto assembler64 = RV64I_Assembler(isa64.get());
+    auto rv64im = rv32im;
+    rv64im.insert(rv64im.end(), rv64imOnly.begin(), rv64imOnly.end());
+    // sllw with the funct7 of sraw, and LOAD with an unknown funct3.
+    auto unknownWords64 = unknownWords;
+    unknownWords64.insert(unknownWords64.end(), {0x40b5153b, 0x0045f503});
+    testDecoder(assembler64, rv64im, unknownWords64);
+}
+
 QTEST_APPLESS_MAIN(tst_Assembler)
 #include "tst_assembler.moc"
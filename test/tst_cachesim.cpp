@@ -0,0 +1,321 @@
+#include <QTemporaryDir>
+#include <QtTest/QTest>
+
+#include <memory>
+
+#include "cachesim/cachesim.h"
+#include "cachesim/memorytrace.h"
+#include "cachesim/stackdistance.h"
+#include "processorhandler.h"
+
+using namespace Ripes;
+
+class tst_CacheSim : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void tst_fillsPropagate();
+    void tst_writebacksPropagate();
+    void tst_sharedNextLevel();
+    void tst_inclusive();
+    void tst_exclusive();
+    void tst_exclusiveWrites();
+    void tst_latency();
+    void tst_traceEncoding();
+    void tst_traceReplay();
+    void tst_stackDistance();
+};
+
+namespace {
+
+CachePreset makePreset(int lines, int ways, int blocks) {
+    CachePreset preset;
+    preset.lines = lines;
+    preset.ways = ways;
+    preset.blocks = blocks;
+    preset.wrPolicy = WritePolicy::WriteBack;
+    preset.wrAllocPolicy = WriteAllocPolicy::WriteAllocate;
+    preset.replPolicy = ReplPolicy::LRU;
+    return preset;
+}
+
+std::shared_ptr<CacheSim> makeCache(int lines, int ways, int blocks,
+                                    InclusionPolicy inclusion = InclusionPolicy::NonInclusive,
+                                    WritePolicy wrPolicy = WritePolicy::WriteBack,
+                                    WriteAllocPolicy wrAllocPolicy = WriteAllocPolicy::WriteAllocate) {
+    auto cache = std::make_shared<CacheSim>(nullptr);
+    auto preset = makePreset(lines, ways, blocks);
+    preset.wrPolicy = wrPolicy;
+    preset.wrAllocPolicy = wrAllocPolicy;
+    cache->setPreset(preset);
+    cache->setInclusionPolicy(inclusion);
+    cache->reset();
+    return cache;
+}
+
+}  // namespace
+
+void tst_CacheSim::initTestCase() {
+    // Cache accesses are recorded at the current cycle of the processor
+    ProcessorHandler::selectProcessor(ProcessorID::RV32_SS, {"M"});
+}
+
+void tst_CacheSim::tst_fillsPropagate() {
+    // Direct-mapped L1 of 4 single-word lines; addresses 0x0 and 0x10 map to the same line
+    auto l1 = makeCache(2, 0, 0);
+    auto l2 = makeCache(4, 1, 0);
+    l1->setNextLevelCache(l2);
+
+    l1->access(0x0, MemoryAccess::Read);   // L1 miss, L2 miss
+    l1->access(0x0, MemoryAccess::Read);   // L1 hit
+    l1->access(0x10, MemoryAccess::Read);  // L1 miss (evicts 0x0), L2 miss
+    l1->access(0x0, MemoryAccess::Read);   // L1 miss, L2 hit
+
+    QCOMPARE(l1->getHits(), 1U);
+    QCOMPARE(l1->getMisses(), 3U);
+    QCOMPARE(l1->getFills(), 3U);
+    QCOMPARE(l2->getHits(), 1U);
+    QCOMPARE(l2->getMisses(), 2U);
+    QCOMPARE(l2->getFills(), 2U);
+    QCOMPARE(l2->getWritebacks(), 0U);
+}
+
+void tst_CacheSim::tst_writebacksPropagate() {
+    auto l1 = makeCache(2, 0, 0);
+    auto l2 = makeCache(4, 1, 0);
+    l1->setNextLevelCache(l2);
+
+    l1->access(0x0, MemoryAccess::Write);  // L1 miss, L2 miss
+    l1->access(0x10, MemoryAccess::Read);  // L1 miss, writing back 0x0 to L2 (hit), L2 miss
+
+    QCOMPARE(l1->getWritebacks(), 1U);
+    QCOMPARE(l2->getHits(), 1U);
+    QCOMPARE(l2->getMisses(), 2U);
+
+    // The written back block is dirty within L2
+    const auto line = l2->getLine(l2->getLineIdx(0x0));
+    QVERIFY(line.has_value());
+    bool dirty = false;
+    for (unsigned i = 0; i < line->size(); i++) {
+        dirty |= line->at(i).valid && line->at(i).tag == l2->getTag(0x0) && line->at(i).dirty;
+    }
+    QVERIFY(dirty);
+}
+
+void tst_CacheSim::tst_sharedNextLevel() {
+    auto l1d = makeCache(2, 0, 0);
+    auto l1i = makeCache(2, 0, 0);
+    auto l2 = makeCache(4, 1, 0);
+    l1d->setNextLevelCache(l2);
+    l1i->setNextLevelCache(l2);
+
+    l1i->access(0x0, MemoryAccess::Read);  // L2 miss
+    l1d->access(0x0, MemoryAccess::Read);  // L2 hit on the block filled by the instruction cache
+
+    QCOMPARE(l2->getHits(), 1U);
+    QCOMPARE(l2->getMisses(), 1U);
+
+    // Unregistering must not affect the remaining lower level cache
+    l1i->setNextLevelCache(nullptr);
+    l1d->access(0x10, MemoryAccess::Read);
+    QCOMPARE(l2->getMisses(), 2U);
+}
+
+void tst_CacheSim::tst_inclusive() {
+    for (const auto inclusion : {InclusionPolicy::NonInclusive, InclusionPolicy::Inclusive}) {
+        // L2 holds a single block; filling 0x4 evicts 0x0 from L2
+        auto l1 = makeCache(2, 0, 0);
+        auto l2 = makeCache(0, 0, 0, inclusion);
+        l1->setNextLevelCache(l2);
+
+        l1->access(0x0, MemoryAccess::Read);
+        l1->access(0x4, MemoryAccess::Read);
+        l1->access(0x0, MemoryAccess::Read);
+
+        if (inclusion == InclusionPolicy::Inclusive) {
+            // 0x0 was invalidated within L1 when evicted from L2
+            QCOMPARE(l1->getHits(), 0U);
+            QCOMPARE(l1->getMisses(), 3U);
+        } else {
+            QCOMPARE(l1->getHits(), 1U);
+            QCOMPARE(l1->getMisses(), 2U);
+        }
+    }
+}
+
+void tst_CacheSim::tst_exclusive() {
+    // Single-block L1, and an L2 with 0x0 and 0x4 in separate lines
+    auto l1 = makeCache(0, 0, 0);
+    auto l2 = makeCache(2, 0, 0, InclusionPolicy::Exclusive);
+    l1->setNextLevelCache(l2);
+
+    l1->access(0x0, MemoryAccess::Read);  // L2 miss; the block is not allocated in L2
+    QVERIFY(!l2->getLine(l2->getLineIdx(0x0))->at(0).valid);
+
+    l1->access(0x4, MemoryAccess::Read);  // 0x0 is evicted into L2, L2 miss
+    QVERIFY(l2->getLine(l2->getLineIdx(0x0))->at(0).valid);
+    QVERIFY(!l2->getLine(l2->getLineIdx(0x4))->at(0).valid);
+
+    l1->access(0x0, MemoryAccess::Read);  // 0x4 is evicted into L2, L2 hit moves 0x0 back to L1
+    QVERIFY(!l2->getLine(l2->getLineIdx(0x0))->at(0).valid);
+    QVERIFY(l2->getLine(l2->getLineIdx(0x4))->at(0).valid);
+
+    QCOMPARE(l2->getHits(), 1U);
+    QCOMPARE(l2->getMisses(), 2U);
+    QCOMPARE(l2->getFills(), 2U);
+}
+
+void tst_CacheSim::tst_exclusiveWrites() {
+    // Writes of a write-through L1 are not allocated in an exclusive L2
+    {
+        auto l1 = makeCache(0, 0, 0, InclusionPolicy::NonInclusive, WritePolicy::WriteThrough);
+        auto l2 = makeCache(2, 0, 0, InclusionPolicy::Exclusive);
+        l1->setNextLevelCache(l2);
+
+        l1->access(0x0, MemoryAccess::Write);  // L1 miss filled from L2 (miss), and written through to L2 (miss)
+        QVERIFY(!l2->getLine(l2->getLineIdx(0x0))->at(0).valid);
+        QCOMPARE(l2->getMisses(), 2U);
+        QCOMPARE(l2->getFills(), 1U);
+    }
+
+    // Writes of a no-write-allocate L1 update a block held by an exclusive L2 in place
+    {
+        auto l1 = makeCache(0, 0, 0, InclusionPolicy::NonInclusive, WritePolicy::WriteThrough,
+                            WriteAllocPolicy::NoWriteAllocate);
+        auto l2 = makeCache(2, 0, 0, InclusionPolicy::Exclusive);
+        l1->setNextLevelCache(l2);
+
+        l1->access(0x0, MemoryAccess::Read);
+        l1->access(0x4, MemoryAccess::Read);   // 0x0 is evicted into L2
+        l1->access(0x0, MemoryAccess::Write);  // L1 miss, L2 hit
+        const auto way = l2->getLine(l2->getLineIdx(0x0))->at(0);
+        QVERIFY(way.valid && way.tag == l2->getTag(0x0) && way.dirty);
+        QCOMPARE(l2->getHits(), 1U);
+
+        l1->access(0x8, MemoryAccess::Write);  // L1 miss, L2 miss; 0x8 maps to the line holding 0x0
+        QVERIFY(l2->getLine(l2->getLineIdx(0x8))->at(0).tag == l2->getTag(0x0));
+    }
+}
+
+void tst_CacheSim::tst_latency() {
+    auto l1 = makeCache(2, 0, 0);
+    auto l2 = makeCache(4, 1, 0);
+    l1->setNextLevelCache(l2);
+    l1->setHitLatency(1);
+    l1->setMissPenalty(2);
+    l2->setHitLatency(4);
+    l2->setMissPenalty(20);
+
+    QCOMPARE(l1->access(0x0, MemoryAccess::Read), 1U + 2U + 4U + 20U);  // L1 miss, L2 miss
+    QCOMPARE(l1->access(0x0, MemoryAccess::Read), 1U);                   // L1 hit
+    QCOMPARE(l1->access(0x0, MemoryAccess::Write), 1U);                  // L1 hit
+    // L1 miss, L2 miss; the writeback of the evicted dirty block is buffered and does not add to the latency
+    QCOMPARE(l1->access(0x10, MemoryAccess::Read), 1U + 2U + 4U + 20U);
+    QCOMPARE(l1->access(0x0, MemoryAccess::Read), 1U + 2U + 4U);  // L1 miss, L2 hit
+}
+
+void tst_CacheSim::tst_traceEncoding() {
+    const std::vector<MemoryTrace::Entry> entries = {{0x0, MemoryAccess::Read, MemoryTrace::Stream::Instruction},
+                                                     {0x10000000, MemoryAccess::Write, MemoryTrace::Stream::Data},
+                                                     {0x4, MemoryAccess::Read, MemoryTrace::Stream::Instruction},
+                                                     {0xFFFFFFFC, MemoryAccess::Read, MemoryTrace::Stream::Data},
+                                                     {0x0, MemoryAccess::Read, MemoryTrace::Stream::Instruction},
+                                                     {0x8, MemoryAccess::Write, MemoryTrace::Stream::Data}};
+    MemoryTrace trace;
+    for (const auto& entry : entries) {
+        trace.append(entry);
+    }
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("trace.bin");
+    QVERIFY(!trace.save(path).has_value());
+    MemoryTrace loaded;
+    QVERIFY(!loaded.load(path).has_value());
+    QCOMPARE(loaded.size(), entries.size());
+
+    size_t i = 0;
+    loaded.forEach([&](const MemoryTrace::Entry& entry) {
+        QCOMPARE(entry.address, entries.at(i).address);
+        QCOMPARE(entry.type, entries.at(i).type);
+        QVERIFY(entry.stream == entries.at(i).stream);
+        i++;
+    });
+    QCOMPARE(i, entries.size());
+
+    // Sequential instruction fetches are encoded in a single byte
+    MemoryTrace fetches;
+    for (AInt address = 0; address < 0x100; address += 4) {
+        fetches.append({address, MemoryAccess::Read, MemoryTrace::Stream::Instruction});
+    }
+    QCOMPARE(fetches.sizeInBytes(), fetches.size());
+}
+
+void tst_CacheSim::tst_traceReplay() {
+    MemoryTrace trace;
+    for (unsigned i = 0; i < 4; i++) {
+        for (AInt address = 0; address < 0x200; address += 4) {
+            trace.append({address, MemoryAccess::Read, MemoryTrace::Stream::Instruction});
+            trace.append({0x1000 + ((address * 7) % 0x400), i % 2 ? MemoryAccess::Write : MemoryAccess::Read,
+                          MemoryTrace::Stream::Data});
+        }
+    }
+
+    std::vector<CachePreset> presets;
+    for (int lines = 0; lines < 4; lines++) {
+        for (int ways = 0; ways < 3; ways++) {
+            presets.push_back(makePreset(lines * 2, ways, 1));
+        }
+    }
+
+    const auto results = replayMemoryTrace(trace, presets);
+    QCOMPARE(results.size(), presets.size());
+    for (const auto& result : results) {
+        // Replaying in parallel must match accessing the caches one by one
+        auto instrCache = makeCache(result.preset.lines, result.preset.ways, result.preset.blocks);
+        auto dataCache = makeCache(result.preset.lines, result.preset.ways, result.preset.blocks);
+        trace.forEach([&](const MemoryTrace::Entry& entry) {
+            (entry.stream == MemoryTrace::Stream::Instruction ? instrCache : dataCache)->access(entry.address,
+                                                                                              entry.type);
+        });
+        QCOMPARE(static_cast<unsigned>(result.instr.hits), instrCache->getHits());
+        QCOMPARE(static_cast<unsigned>(result.instr.misses), instrCache->getMisses());
+        QCOMPARE(static_cast<unsigned>(result.data.hits), dataCache->getHits());
+        QCOMPARE(static_cast<unsigned>(result.data.misses), dataCache->getMisses());
+        QCOMPARE(static_cast<unsigned>(result.data.writebacks), dataCache->getWritebacks());
+    }
+}
+
+void tst_CacheSim::tst_stackDistance() {
+    // A pseudo-random access stream with some locality
+    std::vector<AInt> addresses;
+    uint32_t state = 12345;
+    for (unsigned i = 0; i < 4000; i++) {
+        state = state * 1103515245 + 12345;
+        addresses.push_back(((state >> 8) % 2 ? 0x1000 : 0x0) + (((state >> 12) % 128) << 2));
+    }
+
+    for (const int blocks : {0, 2}) {
+        StackDistanceAnalyzer analysis(blocks, 4, 2);
+        for (const auto address : addresses) {
+            analysis.access(address);
+        }
+        QCOMPARE(analysis.getAccesses(), addresses.size());
+
+        // A single pass must match simulating each of the geometries
+        for (unsigned lines = 0; lines <= 4; lines++) {
+            for (unsigned ways = 0; ways <= 2; ways++) {
+                auto cache = makeCache(lines, ways, blocks);
+                for (const auto address : addresses) {
+                    cache->access(address, MemoryAccess::Read);
+                }
+                QCOMPARE(analysis.getHits(lines, ways), static_cast<uint64_t>(cache->getHits()));
+            }
+        }
+    }
+}
+
+QTEST_MAIN(tst_CacheSim)
+#include "tst_cachesim.moc"
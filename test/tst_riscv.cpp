@@ -1,11 +1,16 @@
 #include <QDir>
 #include <QProcess>
 #include <QStringList>
+#include <QTemporaryDir>
 #include <QtTest/QTest>
 
+#include "checkpoint.h"
 #include "processorhandler.h"
 #include "processorregistry.h"
+#include "profiler.h"
 #include "ripessettings.h"
+#include "stageinfostore.h"
+#include "syscall/systemio.h"
 
 #include "assembler/rv32i_assembler.h"
 
@@ -53,6 +58,26 @@ private:
 
     void trapHandler();
 
+    /**
+     * @brief loadAssembly
+     * Selects processor @p id, assembles @p source and loads the resulting program. System calls are handled by the
+     * ProcessorHandler, as they are in the application.
+     */
+    void loadAssembly(const ProcessorID& id, const QString& source);
+
+    struct ArchState {
+        std::vector<VInt> registers;
+        AInt pc;
+        long long cycles;
+        QByteArray data;
+
+        bool operator==(const ArchState& rhs) const {
+            return registers == rhs.registers && pc == rhs.pc && cycles == rhs.cycles && data == rhs.data;
+        }
+    };
+    // The register file, pc and cycle count of the processor, and the first @p size bytes of the .data section.
+    ArchState captureArchState(size_t size) const;
+
     bool m_stop = false;
     std::shared_ptr<Program> m_program;
     QString m_err;
@@ -63,11 +88,21 @@ private slots:
     void testRV64_5StagePipeline() { runTests(ProcessorID::RV64_5S, RISCV64_TEST_DIR); }
     void testRV64_5StagePipelineNOFW() { runTests(ProcessorID::RV64_5S_NO_FW, RISCV64_TEST_DIR); }
     void testRV64_6SDual() { runTests(ProcessorID::RV64_6S_DUAL, RISCV64_TEST_DIR); }
+    void testRV64_ISS() { runTests(ProcessorID::RV64_ISS, RISCV64_TEST_DIR); }
 
     void testRV32_SingleCycle() { runTests(ProcessorID::RV32_SS, RISCV32_TEST_DIR); }
     void testRV32_5StagePipeline() { runTests(ProcessorID::RV32_5S, RISCV32_TEST_DIR); }
     void testRV32_5StagePipelineNOFW() { runTests(ProcessorID::RV32_5S_NO_FW, RISCV32_TEST_DIR); }
     void testRV32_6SDual() { runTests(ProcessorID::RV32_6S_DUAL, RISCV32_TEST_DIR); }
+    void testRV32_ISS() { runTests(ProcessorID::RV32_ISS, RISCV32_TEST_DIR); }
+
+    void testRewind();
+    void testCheckpointRoundTrip();
+    void testRunBlocking();
+    void testWatchpoints();
+    void testISSCodePatching();
+    void testStageInfoStore();
+    void testProfiler();
 };
 
 bool tst_RISCV::skipTest(const QString& test) {
@@ -181,5 +216,423 @@ void tst_RISCV::runTests(const ProcessorID& id, const QString& testdir) {
     }
 }
 
+void tst_RISCV::loadAssembly(const ProcessorID& id, const QString& source) {
+    ProcessorHandler::selectProcessor(id, QStringList("M"));
+    const auto program = ProcessorHandler::getAssembler()->assemble(source.split("\n"));
+    if (program.errors.size() != 0) {
+        QFAIL(("Could not assemble program:\n" + program.errors.toString()).toStdString().c_str());
+    }
+    m_program = std::make_shared<Program>(program.program);
+    ProcessorHandler::loadProgram(m_program);
+    RipesSettings::getObserver(RIPES_GLOBALSIGNAL_REQRESET)->trigger();
+}
+
+tst_RISCV::ArchState tst_RISCV::captureArchState(size_t size) const {
+    const auto* proc = ProcessorHandler::getProcessor();
+    ArchState state;
+    for (unsigned i = 0; i < ProcessorHandler::currentISA()->regCnt(); i++) {
+        state.registers.push_back(proc->getRegister(RegisterFileType::GPR, i));
+    }
+    state.pc = proc->getPcForStage(0);
+    state.cycles = proc->getCycleCount();
+    state.data = ProcessorHandler::readMemBlock(m_program->getSection(".data")->address, size);
+    return state;
+}
+
+// Accumulates into registers and a ring of memory words, such that the state differs between any two cycles.
+static const QString s_accumulateProgram = R"(
+.data
+buf: .zero 64
+.text
+    la a1, buf
+    li t0, 0
+    li t1, 0
+loop:
+    add t1, t1, t0
+    andi t2, t0, 15
+    slli t2, t2, 2
+    add t2, t2, a1
+    sw t1, 0(t2)
+    addi t0, t0, 1
+    j loop
+)";
+
+void tst_RISCV::testRewind() {
+    constexpr long long rewindTo = 100;
+    constexpr long long runTo = 1000;
+
+    ProcessorHandler::setSnapshotInterval(16);
+    loadAssembly(ProcessorID::RV32_SS, s_accumulateProgram);
+    auto* proc = ProcessorHandler::getProcessorNonConst();
+    while (proc->getCycleCount() < rewindTo) {
+        proc->clockProcessor();
+    }
+    const auto expected = captureArchState(64);
+
+    while (proc->getCycleCount() < runTo) {
+        proc->clockProcessor();
+    }
+    const auto expectedEnd = captureArchState(64);
+
+    QVERIFY(ProcessorHandler::canReverse());
+    ProcessorHandler::rewind(rewindTo);
+    QCOMPARE(proc->getCycleCount(), rewindTo);
+    QVERIFY(captureArchState(64) == expected);
+
+    // Execution continues identically from the rewound state.
+    while (proc->getCycleCount() < runTo) {
+        proc->clockProcessor();
+    }
+    QVERIFY(captureArchState(64) == expectedEnd);
+
+    // Pipelined processors are only snapshotted upon reset, and are rewound by re-executing from there.
+    loadAssembly(ProcessorID::RV32_5S, s_accumulateProgram);
+    proc = ProcessorHandler::getProcessorNonConst();
+    while (proc->getCycleCount() < rewindTo) {
+        proc->clockProcessor();
+    }
+    const auto expectedPipelined = captureArchState(64);
+    while (proc->getCycleCount() < runTo) {
+        proc->clockProcessor();
+    }
+    QVERIFY(!ProcessorHandler::hasSnapshot(rewindTo));
+    QVERIFY(ProcessorHandler::canReverse());
+    ProcessorHandler::rewind(rewindTo);
+    QCOMPARE(proc->getCycleCount(), rewindTo);
+    QVERIFY(captureArchState(64) == expectedPipelined);
+
+    ProcessorHandler::setSnapshotInterval(RipesSettings::value(RIPES_SETTING_SNAPSHOTINTERVAL).toUInt());
+}
+
+// As s_accumulateProgram, but prints the accumulated value on each iteration, such that a system call which is executed
+// twice shows in the output.
+static const QString s_printingProgram = R"(
+.data
+buf: .zero 64
+.text
+    la a1, buf
+    li t0, 0
+    li t1, 0
+loop:
+    add t1, t1, t0
+    andi t2, t0, 15
+    slli t2, t2, 2
+    add t2, t2, a1
+    sw t1, 0(t2)
+    mv a0, t1
+    li a7, 1
+    ecall
+    addi t0, t0, 1
+    j loop
+)";
+
+void tst_RISCV::testCheckpointRoundTrip() {
+    constexpr long long instructions = 500;
+    QString output;
+    QObject context;
+    QObject::connect(&SystemIO::get(), &SystemIO::doPrint, &context, [&](const QString& str) { output += str; });
+
+    // Reference execution
+    loadAssembly(ProcessorID::RV32_ISS, s_printingProgram);
+    auto* proc = ProcessorHandler::getProcessorNonConst();
+    while (proc->getInstructionsRetired() < instructions) {
+        proc->clockProcessor();
+    }
+    const auto expected = captureArchState(64);
+    const QString expectedOutput = output;
+
+    // Save a checkpoint from a pipelined execution. Saving is refused while an executed ecall is in flight.
+    output.clear();
+    loadAssembly(ProcessorID::RV32_5S, s_printingProgram);
+    proc = ProcessorHandler::getProcessorNonConst();
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("checkpoint");
+    bool refused = false;
+    while (proc->getCycleCount() < 200 || executedEcallInFlight()) {
+        if (executedEcallInFlight()) {
+            refused |= saveCheckpoint(path).has_value();
+        }
+        proc->clockProcessor();
+    }
+    QVERIFY(refused);
+    const auto saveError = saveCheckpoint(path);
+    QVERIFY2(!saveError, saveError.value_or("").toStdString().c_str());
+
+    // Restore the checkpoint onto the ISS, and resume execution.
+    loadAssembly(ProcessorID::RV32_ISS, s_printingProgram);
+    proc = ProcessorHandler::getProcessorNonConst();
+    QStringList warnings;
+    const auto restoreError = restoreCheckpoint(path, {}, warnings);
+    QVERIFY2(!restoreError, restoreError.value_or("").toStdString().c_str());
+    QVERIFY(warnings.isEmpty());
+    while (proc->getInstructionsRetired() < instructions) {
+        proc->clockProcessor();
+    }
+
+    const auto restored = captureArchState(64);
+    QVERIFY(restored.registers == expected.registers);
+    QCOMPARE(restored.pc, expected.pc);
+    QCOMPARE(restored.data, expected.data);
+    QCOMPARE(output, expectedOutput);
+}
+
+void tst_RISCV::testRunBlocking() {
+    loadAssembly(ProcessorID::RV32_5S, s_accumulateProgram);
+    const auto* proc = ProcessorHandler::getProcessor();
+
+    QCOMPARE(ProcessorHandler::runBlocking(RunCondition::forCycles(100)), RunStopReason::CycleBudget);
+    QCOMPARE(proc->getCycleCount(), 100LL);
+
+    const long long retired = proc->getInstructionsRetired();
+    QCOMPARE(ProcessorHandler::runBlocking(RunCondition::forInstructions(50)), RunStopReason::InstructionBudget);
+    QCOMPARE(proc->getInstructionsRetired(), retired + 50);
+
+    // Run until the loop counter (t0) reaches 40
+    RunCondition condition;
+    condition.until = RunCondition::registerEquals(RegisterFileType::GPR, 5, 40);
+    QCOMPARE(ProcessorHandler::runBlocking(condition), RunStopReason::Condition);
+    QCOMPARE(proc->getRegister(RegisterFileType::GPR, 5), VInt(40));
+    QCOMPARE(ProcessorHandler::lastRunStopReason(), RunStopReason::Condition);
+    QVERIFY(!ProcessorHandler::isRunning());
+}
+
+// Loads from and stores to a watched word, after which a system call reads from stdin into another watched range.
+static const QString s_watchedProgram = R"(
+.data
+word: .word 0
+input: .zero 4
+.text
+    la a1, word
+    lw t0, 0(a1)
+    addi t0, t0, 1
+    sw t0, 0(a1)
+    li a0, 0
+    la a1, input
+    li a2, 4
+    li a7, 63
+    ecall
+)";
+
+void tst_RISCV::testWatchpoints() {
+    loadAssembly(ProcessorID::RV32_SS, s_watchedProgram);
+    SystemIO::get().putStdInData("abcd");
+    const AInt word = m_program->getSection(".data")->address;
+    const AInt input = word + 4;
+
+    const auto expectHit = [](Watchpoint::Type type, MemoryAccess::Type accessType, AInt address, unsigned bytes) {
+        QCOMPARE(ProcessorHandler::runBlocking({}), RunStopReason::Watchpoint);
+        const auto& hit = ProcessorHandler::lastWatchpointHit();
+        QVERIFY(hit.has_value());
+        QCOMPARE(hit->type, type);
+        QCOMPARE(hit->access.type, accessType);
+        QCOMPARE(hit->access.address, address);
+        QCOMPARE(hit->access.bytes, bytes);
+    };
+
+    ProcessorHandler::setWatchpoint(word, 4, Watchpoint::Read);
+    expectHit(Watchpoint::Read, MemoryAccess::Read, word, 4);
+
+    // The store triggers the write watchpoint before it is performed, and the change watchpoint once it has been.
+    ProcessorHandler::setWatchpoint(word, 4, Watchpoint::Write | Watchpoint::Change);
+    ProcessorHandler::setWatchpoint(input, 4, Watchpoint::Change);
+    expectHit(Watchpoint::Write, MemoryAccess::Write, word, 4);
+    expectHit(Watchpoint::Change, MemoryAccess::Write, word, 4);
+    QCOMPARE(ProcessorHandler::readMemBlock(word, 4), QByteArray("\x01\x00\x00\x00", 4));
+
+    // Memory written by a system call is not a processor access, but still triggers change watchpoints.
+    expectHit(Watchpoint::Change, MemoryAccess::Write, input, 4);
+    QCOMPARE(ProcessorHandler::readMemBlock(input, 4), QByteArray("abcd"));
+
+    QCOMPARE(ProcessorHandler::runBlocking({}), RunStopReason::Finished);
+    ProcessorHandler::clearWatchpoints();
+}
+
+void tst_RISCV::testISSCodePatching() {
+    loadAssembly(ProcessorID::RV32_ISS, "li t0, 1\nli t0, 2\nli t1, 3");
+    auto* proc = ProcessorHandler::getProcessorNonConst();
+    const AInt textStart = ProcessorHandler::getTextStart();
+
+    // Decode the second instruction, and then replace it with "li t0, 7" outside of the processor.
+    proc->clockProcessor();
+    QCOMPARE(proc->nextFetchedAddress(), textStart + 8);
+    ProcessorHandler::writeMem(textStart + 4, 0x00700293, 4);
+    proc->clockProcessor();
+    QCOMPARE(proc->getRegister(RegisterFileType::GPR, 5), VInt(7));
+
+    // Resetting reloads the program into memory; the original instruction is executed, although the patched
+    // instruction remains in the decode cache.
+    RipesSettings::getObserver(RIPES_GLOBALSIGNAL_REQRESET)->trigger();
+    proc->clockProcessor();
+    proc->clockProcessor();
+    QCOMPARE(proc->getRegister(RegisterFileType::GPR, 5), VInt(2));
+}
+
+void tst_RISCV::testStageInfoStore() {
+    constexpr size_t capacity = 8;
+    constexpr long long cycles = 20;
+
+    loadAssembly(ProcessorID::RV32_5S, s_accumulateProgram);
+    auto* proc = ProcessorHandler::getProcessorNonConst();
+    const unsigned stages = proc->stageCount();
+    const AInt textStart = ProcessorHandler::getTextStart();
+
+    StageInfoStore store;
+    store.reset(stages, capacity, textStart, 4);
+    QVERIFY(store.empty());
+
+    // Record more cycles than the store holds; only the latest cycles are kept.
+    std::vector<std::vector<StageInfo>> expected;
+    for (long long cycle = 0; cycle < cycles; cycle++) {
+        std::vector<StageInfo> infos;
+        for (unsigned stage = 0; stage < stages; stage++) {
+            infos.push_back(proc->stageInfo(stage));
+        }
+        expected.push_back(infos);
+        store.record(cycle, *proc);
+        proc->clockProcessor();
+    }
+    QCOMPARE(store.size(), capacity);
+    QCOMPARE(store.firstCycle(), cycles - static_cast<long long>(capacity));
+    QCOMPARE(store.endCycle(), cycles);
+    QVERIFY(!store.contains(store.firstCycle() - 1));
+
+    bool anyValid = false;
+    for (long long cycle = store.firstCycle(); cycle < store.endCycle(); cycle++) {
+        for (unsigned stage = 0; stage < stages; stage++) {
+            const auto& info = expected.at(cycle).at(stage);
+            QVERIFY(store.stageInfo(cycle, stage) == info);
+            if (info.stage_valid) {
+                // Each instruction maps to a row of its own.
+                anyValid = true;
+                QCOMPARE(store.row(cycle, stage), static_cast<int>((info.pc - textStart) / 4));
+                QCOMPARE(store.rowAddress(store.row(cycle, stage)), info.pc);
+            } else {
+                QCOMPARE(store.row(cycle, stage), -1);
+            }
+        }
+    }
+    QVERIFY(anyValid);
+
+    // Cycles which were already recorded, or have been evicted, are not recorded again.
+    store.record(store.firstCycle() - 1, *proc);
+    store.record(store.endCycle() - 1, *proc);
+    QCOMPARE(store.endCycle(), cycles);
+
+    // Skipped cycles are recorded as having no valid stages, and evict the oldest cycles.
+    constexpr long long gap = 3;
+    store.record(cycles + gap, *proc);
+    QCOMPARE(store.size(), capacity);
+    QCOMPARE(store.endCycle(), cycles + gap + 1);
+    for (long long cycle = cycles; cycle < cycles + gap; cycle++) {
+        for (unsigned stage = 0; stage < stages; stage++) {
+            QVERIFY(!store.valid(cycle, stage));
+            QCOMPARE(store.row(cycle, stage), -1);
+        }
+    }
+    for (unsigned stage = 0; stage < stages; stage++) {
+        QVERIFY(store.stageInfo(cycles + gap, stage) == proc->stageInfo(stage));
+    }
+
+    // A gap exceeding the capacity leaves only the recorded cycle.
+    const long long farCycle = store.endCycle() + static_cast<long long>(capacity) * 4;
+    store.record(farCycle, *proc);
+    QCOMPARE(store.size(), size_t(1));
+    QCOMPARE(store.firstCycle(), farCycle);
+
+    // Addresses before the first row map to no row.
+    store.reset(stages, capacity, textStart + 0x1000, 4);
+    store.record(0, *proc);
+    for (unsigned stage = 0; stage < stages; stage++) {
+        QCOMPARE(store.row(0, stage), -1);
+    }
+}
+
+// The add depends on the preceding load, and stalls the 5-stage pipeline for a cycle.
+static const QString s_loadUseProgram = R"(
+.data
+v: .word 5
+.text
+    la a1, v
+    lw t0, 0(a1)
+    add t1, t0, t0
+    nop
+    nop
+end:
+    j end
+)";
+
+// Independent pairs of an ALU instruction and a store, which the dual-issue pipeline may issue together.
+static const QString s_dualIssueProgram = R"(
+.data
+buf: .zero 16
+.text
+    la a1, buf
+    li t0, 1
+    sw t1, 0(a1)
+    li t2, 2
+    sw t3, 4(a1)
+    li t4, 3
+    sw t5, 8(a1)
+    li t6, 4
+    sw t1, 12(a1)
+end:
+    j end
+)";
+
+void tst_RISCV::testProfiler() {
+    constexpr long long cycles = 40;
+    const auto& profiler = Profiler::get();
+    RipesSettings::setValue(RIPES_SETTING_PROFILER_ENABLED, true);
+
+    // Every cycle is attributed to exactly one instruction, and every retired instruction is counted.
+    auto checkTotals = [&] {
+        const auto* proc = ProcessorHandler::getProcessor();
+        QCOMPARE(profiler.total().cycles, static_cast<uint64_t>(proc->getCycleCount()));
+        QCOMPARE(profiler.total().executions, static_cast<uint64_t>(proc->getInstructionsRetired()));
+        ProfileCounters sum;
+        profiler.forEach([&](AInt, const ProfileCounters& counters) { sum += counters; });
+        QCOMPARE(sum.cycles, profiler.total().cycles);
+        QCOMPARE(sum.stalls, profiler.total().stalls);
+        QCOMPARE(sum.executions, profiler.total().executions);
+    };
+
+    loadAssembly(ProcessorID::RV32_5S, s_loadUseProgram);
+    auto* proc = ProcessorHandler::getProcessorNonConst();
+    while (proc->getCycleCount() < cycles) {
+        proc->clockProcessor();
+    }
+    checkTotals();
+    // la expands to auipc and addi; the bubble inserted after the load retires nothing, and is a stall of the add,
+    // which is the oldest instruction in the pipeline at that time.
+    const AInt textStart = ProcessorHandler::getTextStart();
+    const auto load = profiler.counters(textStart + 8);
+    const auto add = profiler.counters(textStart + 12);
+    QCOMPARE(load.executions, uint64_t(1));
+    QCOMPARE(load.cycles, uint64_t(1));
+    QCOMPARE(load.stalls, uint64_t(0));
+    QCOMPARE(add.executions, uint64_t(1));
+    QCOMPARE(add.cycles, uint64_t(2));
+    QCOMPARE(add.stalls, uint64_t(1));
+    // Single-issue; one instruction retires in every cycle which is not a stall.
+    QCOMPARE(profiler.total().executions, profiler.total().cycles - profiler.total().stalls);
+
+    loadAssembly(ProcessorID::RV32_6S_DUAL, s_dualIssueProgram);
+    proc = ProcessorHandler::getProcessorNonConst();
+    while (proc->getCycleCount() < cycles) {
+        proc->clockProcessor();
+    }
+    checkTotals();
+    // Of instructions retiring together, the cycle is attributed to the first; the others are executed in no cycles.
+    bool dualIssued = false;
+    profiler.forEach([&](AInt, const ProfileCounters& counters) {
+        dualIssued |= counters.executions != 0 && counters.cycles == 0;
+    });
+    QVERIFY(dualIssued);
+    QVERIFY(profiler.total().executions > profiler.total().cycles - profiler.total().stalls);
+
+    RipesSettings::setValue(RIPES_SETTING_PROFILER_ENABLED, false);
+}
+
 QTEST_APPLESS_MAIN(tst_RISCV)
 #include "tst_riscv.moc"